@@ -0,0 +1,139 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Propagates batches of independent DMPs concurrently using a
+            pool of worker threads.
+
+ \file		batch_propagator.h
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef BATCH_PROPAGATOR_H_
+#define BATCH_PROPAGATOR_H_
+
+// system includes
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+// local includes
+#include <dmp_lib/dynamic_movement_primitive.h>
+#include <dmp_lib/trajectory.h>
+#include <dmp_lib/status.h>
+
+namespace dmp_lib
+{
+
+/*! Propagates a batch of DMPs (e.g. copies of the same DMP with different thetas or goals) into a batch of
+ *  trajectories. The worker threads are created once and reused for every batch. The DMPs need to be setup
+ *  before and must not share transformation systems, which is the case for DMPs created by assignment.
+ */
+class BatchPropagator : public Status
+{
+
+public:
+
+  /*! Constructor
+   */
+  BatchPropagator() :
+    num_threads_(0), stop_(false), generation_(0), dmps_(NULL), trajectories_(NULL), sampling_duration_(0.0), num_samples_(0),
+    offline_(false), next_index_(0), num_finished_(0), success_(true) {};
+
+  /*! Destructor, joins all worker threads
+   */
+  virtual ~BatchPropagator();
+
+  /*! Creates the worker threads
+   * @param num_threads : number of worker threads, if 0 the number of hardware threads is used
+   * @return True on success, otherwise False
+   */
+  bool initialize(const int num_threads = 0);
+
+  /*! Propagates all dmps and stores their rollouts in trajectories. The trajectories are resized if needed
+   *  and are reused across batches, i.e. no memory is allocated when the batch size and rollout length remain the same.
+   * @param dmps : the dmps, each needs to be setup
+   * @param trajectories : the rollout of each dmp
+   * @param sampling_duration
+   * @param num_samples
+   * @param offline : if True DynamicMovementPrimitive::propagateFullOffline is used instead of propagateFull
+   * @return True if all dmps could be propagated, otherwise False
+   */
+  bool propagateFull(std::vector<DMPPtr>& dmps,
+                     std::vector<Trajectory>& trajectories,
+                     const double sampling_duration,
+                     const int num_samples,
+                     const bool offline = false);
+
+  /*!
+   * @return Number of worker threads
+   */
+  int getNumThreads() const;
+
+private:
+
+  /*! Main loop of the worker threads
+   * @param generation : the generation at the time the worker was created
+   */
+  void run(unsigned int generation);
+
+  /*! Propagates dmps of the current batch until none is left
+   */
+  void processBatch();
+
+  /*!
+   */
+  void stop();
+
+  /*!
+   */
+  std::vector<boost::shared_ptr<boost::thread> > threads_;
+  int num_threads_;
+
+  /*! Protects all members below and is used together with the two conditions
+   */
+  boost::mutex mutex_;
+  boost::condition batch_available_condition_;
+  boost::condition batch_finished_condition_;
+  bool stop_;
+
+  /*! Incremented for each batch such that the workers can tell whether a new batch is available
+   */
+  unsigned int generation_;
+
+  /*! The current batch
+   */
+  std::vector<DMPPtr>* dmps_;
+  std::vector<Trajectory>* trajectories_;
+  double sampling_duration_;
+  int num_samples_;
+  bool offline_;
+
+  /*! Index of the next dmp to be propagated and number of propagated dmps of the current batch
+   */
+  int next_index_;
+  int num_finished_;
+  bool success_;
+
+};
+
+/*! Abbreviation for convinience
+ */
+typedef boost::shared_ptr<BatchPropagator> BatchPropagatorPtr;
+
+// Inline definitions follow
+inline int BatchPropagator::getNumThreads() const
+{
+  assert(initialized_);
+  return num_threads_;
+}
+
+}
+
+#endif /* BATCH_PROPAGATOR_H_ */
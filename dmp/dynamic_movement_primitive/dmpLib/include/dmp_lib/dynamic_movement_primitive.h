@@ -350,6 +350,28 @@ public:
   bool propagateFull(Trajectory& trajectory,
                      const double sampling_duration);
 
+  /*! Same as propagateFull, however, the entire rollout is computed at once: the phase of all samples is
+   *  computed in closed form, the nonlinearity of all samples and dimensions is evaluated as one matrix product,
+   *  and the transformation systems are discretized exactly (see TransformationSystem::integrateFull). The result
+   *  matches propagateFull up to the integration error of the euler steps taken by propagateFull. Meant for offline
+   *  use (e.g. policy search or visualization), falls back to propagateFull if a transformation system encodes a quaternion.
+   * @param trajectory
+   * @param sampling_duration
+   * @param num_samples
+   * @return True on success, otherwise False
+   */
+  bool propagateFullOffline(Trajectory& trajectory,
+                            const double sampling_duration,
+                            const int num_samples);
+
+  /*! Same as propagateFull, see propagateFullOffline
+   * @param trajectory
+   * @param sampling_duration
+   * @return True on success, otherwise False
+   */
+  bool propagateFullOffline(Trajectory& trajectory,
+                            const double sampling_duration);
+
   /*!
    * @param desired_positions
    * @param desired_velocities
@@ -0,0 +1,573 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Fixed dimensional NC2010 DMP that can be propagated without any
+            heap allocation or virtual function call.
+
+ \file		fixed_dynamic_movement_primitive.h
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+#define FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+
+// system includes
+#include <math.h>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <boost/shared_ptr.hpp>
+
+#include <Eigen/Core>
+
+// local includes
+#include <dmp_lib/dynamic_movement_primitive.h>
+#include <dmp_lib/nc2010_transformation_system_parameters.h>
+#include <dmp_lib/transformation_system.h>
+#include <dmp_lib/logger.h>
+#include <dmp_lib/status.h>
+
+namespace dmp_lib
+{
+
+/*! Kernel exponents below this value are clamped (see lwr_lib::LWR::generateBasisFunctionVector)
+ */
+static const double FIXED_DMP_MIN_KERNEL_EXPONENT = -700.0;
+
+/*! Implements the NC2010 transformation and canonical system for NUM_DIMENSIONS dimensions that are all
+ * integrated NORMAL using fixed size Eigen types. The parameters (gains, receptive fields, and thetas) are
+ * copied from a learned NC2010 DMP by initialize, which is the only function that allocates memory. All other
+ * functions, in particular setup and propagateStep, neither allocate memory nor call virtual functions and
+ * produce the same output as DynamicMovementPrimitive::propagateStep. The number of receptive fields may
+ * be chosen at runtime but can not exceed MAX_NUM_RFS.
+ */
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS = 100>
+  class FixedDynamicMovementPrimitive : public Status
+  {
+
+  public:
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef Eigen::Matrix<double, NUM_DIMENSIONS, 1> Vector;
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_NUM_RFS, 1> BasisFunctionVector;
+    typedef Eigen::Matrix<double, Eigen::Dynamic, NUM_DIMENSIONS, Eigen::ColMajor, MAX_NUM_RFS, NUM_DIMENSIONS> ReceptiveFieldMatrix;
+
+    /*! Constructor
+     */
+    FixedDynamicMovementPrimitive() :
+      id_(0), num_rfs_(0), shared_receptive_fields_(false), alpha_x_(0.0), initial_duration_(0.0), initial_sampling_frequency_(0.0),
+      canonical_system_x_(0.0), canonical_system_time_(0.0), tau_(0.0), delta_t_(0.0), num_samples_(0), num_generated_samples_(0),
+      is_setup_(false) {};
+
+    /*! Destructor
+     */
+    virtual ~FixedDynamicMovementPrimitive() {};
+
+    /*! Copies the parameters of the provided NC2010 DMP. If the DMP is setup, the fixed DMP is setup with the same
+     * start, goal, duration, and sampling frequency.
+     * @param dmp : learned NC2010 DMP with NUM_DIMENSIONS dimensions that are integrated NORMAL
+     * @return True on success, otherwise False
+     */
+    bool initialize(const DynamicMovementPrimitive& dmp);
+
+    /*!
+     * @param start
+     * @param goal
+     * @param movement_duration
+     * @param sampling_frequency
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool setup(const Vector& start,
+               const Vector& goal,
+               const double movement_duration,
+               const double sampling_frequency);
+
+    /*! Sets the DMP up using the start, goal, duration, and sampling frequency used during learning
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool setup();
+
+    /*!
+     * @return True if the DMP is setup, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool isSetup() const;
+
+    /*!
+     * @param new_goal
+     * @param index
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool changeGoal(const double new_goal,
+                    const int index);
+
+    /*!
+     * @param new_goal
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool changeGoal(const Vector& new_goal);
+
+    /*! Changes the start and sets the current state to the new start (zero velocity and acceleration)
+     * @param new_start
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool changeStart(const Vector& new_start);
+
+    /*!
+     * @param desired_positions
+     * @param desired_velocities
+     * @param desired_accelerations
+     * @param movement_finished
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool propagateStep(Vector& desired_positions,
+                       Vector& desired_velocities,
+                       Vector& desired_accelerations,
+                       bool& movement_finished);
+
+    /*!
+     * @return Fraction of the samples that have been generated since setup
+     * REAL-TIME REQUIREMENTS
+     */
+    double getProgress() const;
+
+    /*!
+     * @return
+     * REAL-TIME REQUIREMENTS
+     */
+    int getId() const;
+
+    /*!
+     * @return
+     * REAL-TIME REQUIREMENTS
+     */
+    int getNumRFS() const;
+
+    /*!
+     * @return
+     */
+    static int getNumDimensions()
+    {
+      return NUM_DIMENSIONS;
+    }
+
+    /*!
+     * @param index
+     * @return The name of the controlled variable
+     * REAL-TIME REQUIREMENTS
+     */
+    const std::string& getName(const int index) const;
+
+  private:
+
+    /*! Computes the nonlinearity of all dimensions for the given phase and stores them in predictions_
+     * @param x_query
+     * @return False if the basis functions do not cover x_query, otherwise True
+     * REAL-TIME REQUIREMENTS
+     */
+    bool predict(const double x_query);
+
+    /*!
+     */
+    int id_;
+    std::vector<std::string> variable_names_;
+
+    /*! LWR models of all dimensions, one column per dimension
+     */
+    int num_rfs_;
+    bool shared_receptive_fields_;
+    ReceptiveFieldMatrix centers_;
+    ReceptiveFieldMatrix inverse_widths_;
+    ReceptiveFieldMatrix thetas_;
+    BasisFunctionVector basis_functions_;
+
+    /*!
+     */
+    Vector k_gains_;
+    Vector d_gains_;
+    double alpha_x_;
+
+    /*! Start, goal, and timing used during learning
+     */
+    Vector initial_start_;
+    Vector initial_goal_;
+    double initial_duration_;
+    double initial_sampling_frequency_;
+
+    /*! Transformation system state
+     */
+    Vector start_;
+    Vector goal_;
+    Vector internal_xd_;
+    Vector internal_xdd_;
+    Vector current_x_;
+    Vector current_xd_;
+    Vector current_xdd_;
+    Vector predictions_;
+
+    /*! Canonical system state and timing
+     */
+    double canonical_system_x_;
+    double canonical_system_time_;
+    double tau_;
+    double delta_t_;
+    int num_samples_;
+    int num_generated_samples_;
+    bool is_setup_;
+
+  };
+
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::initialize(const DynamicMovementPrimitive& dmp)
+  {
+    initialized_ = false;
+    is_setup_ = false;
+    if (!dmp.isInitialized())
+    {
+      Logger::logPrintf("DMP is not initialized. Cannot initialize fixed DMP.", Logger::ERROR);
+      return false;
+    }
+    if (dmp.getVersionString() != "NC2010")
+    {
+      Logger::logPrintf("DMP version >%s< is not supported. Fixed DMPs implement NC2010 DMPs only.", Logger::ERROR, dmp.getVersionString().c_str());
+      return false;
+    }
+    if (dmp.getNumDimensions() != NUM_DIMENSIONS)
+    {
+      Logger::logPrintf("Number of DMP dimensions >%i< does not match number of fixed DMP dimensions >%i<.", Logger::ERROR,
+                        dmp.getNumDimensions(), NUM_DIMENSIONS);
+      return false;
+    }
+
+    std::vector<Eigen::VectorXd> thetas;
+    if (!dmp.getThetas(thetas))
+    {
+      Logger::logPrintf("Could not get thetas. Cannot initialize fixed DMP.", Logger::ERROR);
+      return false;
+    }
+    num_rfs_ = thetas[0].size();
+    if (num_rfs_ < 1 || num_rfs_ > MAX_NUM_RFS)
+    {
+      Logger::logPrintf("Number of receptive fields >%i< is invalid, it needs to be within [1, %i].", Logger::ERROR, num_rfs_, MAX_NUM_RFS);
+      return false;
+    }
+    centers_.resize(num_rfs_, NUM_DIMENSIONS);
+    inverse_widths_.resize(num_rfs_, NUM_DIMENSIONS);
+    thetas_.resize(num_rfs_, NUM_DIMENSIONS);
+    basis_functions_.resize(num_rfs_);
+
+    variable_names_.clear();
+    const std::vector<std::pair<int, int> >& indices = dmp.getIndices();
+    for (int i = 0; i < NUM_DIMENSIONS; ++i)
+    {
+      TSPtr transformation_system = dmp.getTransformationSystem(indices[i].first);
+      if (transformation_system->getIntegrationMethod() != TransformationSystem::NORMAL)
+      {
+        Logger::logPrintf("Transformation system of dimension >%i< is not integrated NORMAL. Cannot initialize fixed DMP.", Logger::ERROR, i);
+        return false;
+      }
+      NC2010TSParamPtr parameters = boost::dynamic_pointer_cast<NC2010TSParam>(transformation_system->getParameters(indices[i].second));
+      if (!parameters)
+      {
+        Logger::logPrintf("Transformation system of dimension >%i< is not a NC2010 transformation system.", Logger::ERROR, i);
+        return false;
+      }
+      if (!parameters->get(k_gains_(i), d_gains_(i)))
+      {
+        return false;
+      }
+      if (thetas[i].size() != num_rfs_ || parameters->getLWRModel()->getNumRFS() != num_rfs_)
+      {
+        Logger::logPrintf("All dimensions need to have the same number of receptive fields >%i<.", Logger::ERROR, num_rfs_);
+        return false;
+      }
+      Eigen::VectorXd widths = Eigen::VectorXd::Zero(num_rfs_);
+      Eigen::VectorXd centers = Eigen::VectorXd::Zero(num_rfs_);
+      if (!parameters->getLWRModel()->getWidthsAndCenters(widths, centers))
+      {
+        return false;
+      }
+      centers_.col(i) = centers;
+      inverse_widths_.col(i) = widths.cwiseInverse();
+      thetas_.col(i) = thetas[i];
+      variable_names_.push_back(transformation_system->getName(indices[i].second));
+    }
+
+    shared_receptive_fields_ = true;
+    for (int i = 1; i < NUM_DIMENSIONS; ++i)
+    {
+      shared_receptive_fields_ = shared_receptive_fields_ && (centers_.col(i) == centers_.col(0)) && (inverse_widths_.col(i) == inverse_widths_.col(0));
+    }
+
+    DMPParamConstPtr dmp_parameters;
+    DMPStateConstPtr dmp_state;
+    Time initial_time;
+    double teaching_duration, execution_duration, cutoff;
+    int type;
+    if (!dmp.get(dmp_parameters, dmp_state) || !dmp_parameters->get(initial_time, teaching_duration, execution_duration, cutoff, type))
+    {
+      return false;
+    }
+    if (cutoff <= 1e-10)
+    {
+      Logger::logPrintf("Invalid cutoff >%f<. Cannot initialize fixed DMP.", Logger::ERROR, cutoff);
+      return false;
+    }
+    alpha_x_ = -log(cutoff);
+    id_ = dmp.getId();
+
+    Eigen::VectorXd initial_start = Eigen::VectorXd::Zero(NUM_DIMENSIONS);
+    Eigen::VectorXd initial_goal = Eigen::VectorXd::Zero(NUM_DIMENSIONS);
+    if (!dmp.getInitialStart(initial_start) || !dmp.getInitialGoal(initial_goal)
+        || !dmp.getInitialDuration(initial_duration_) || !dmp.getInitialSamplingFrequency(initial_sampling_frequency_))
+    {
+      Logger::logPrintf("Could not get initial start, goal, and timing. Cannot initialize fixed DMP.", Logger::ERROR);
+      return false;
+    }
+    initial_start_ = initial_start;
+    initial_goal_ = initial_goal;
+    initialized_ = true;
+
+    if (dmp.isSetup())
+    {
+      Eigen::VectorXd start = Eigen::VectorXd::Zero(NUM_DIMENSIONS);
+      Eigen::VectorXd goal = Eigen::VectorXd::Zero(NUM_DIMENSIONS);
+      double duration = 0, sampling_frequency = 0;
+      if (!dmp.getStart(start) || !dmp.getGoal(goal) || !dmp.getDuration(duration) || !dmp.getSamplingFrequency(sampling_frequency))
+      {
+        Logger::logPrintf("Could not get start, goal, and timing of the DMP. Cannot setup fixed DMP.", Logger::ERROR);
+        return (initialized_ = false);
+      }
+      return (initialized_ = setup(start, goal, duration, sampling_frequency));
+    }
+    return initialized_;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::setup(const Vector& start,
+                                                                         const Vector& goal,
+                                                                         const double movement_duration,
+                                                                         const double sampling_frequency)
+  {
+    assert(initialized_);
+    if (movement_duration <= 0)
+    {
+      Logger::logPrintf("Movement duration >%f< is invalid.", Logger::ERROR, movement_duration);
+      return (is_setup_ = false);
+    }
+    if (sampling_frequency <= 0)
+    {
+      Logger::logPrintf("Sampling frequency >%f< [Hz] is invalid.", Logger::ERROR, sampling_frequency);
+      return (is_setup_ = false);
+    }
+    tau_ = movement_duration;
+    delta_t_ = static_cast<double> (1.0) / sampling_frequency;
+    num_samples_ = static_cast<int> (floor(tau_ / delta_t_));
+    num_generated_samples_ = 0;
+    canonical_system_x_ = 1.0;
+    canonical_system_time_ = 0.0;
+
+    start_ = start;
+    goal_ = goal;
+    current_x_ = start;
+    current_xd_.setZero();
+    current_xdd_.setZero();
+    internal_xd_.setZero();
+    internal_xdd_.setZero();
+    return (is_setup_ = true);
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::setup()
+  {
+    assert(initialized_);
+    return setup(initial_start_, initial_goal_, initial_duration_, initial_sampling_frequency_);
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::changeGoal(const double new_goal,
+                                                                              const int index)
+  {
+    assert(initialized_);
+    if ((index < 0) || (index >= NUM_DIMENSIONS))
+    {
+      Logger::logPrintf("Index >%i< is invalid (Real-time violation).", Logger::ERROR, index);
+      return false;
+    }
+    goal_(index) = new_goal;
+    return true;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::changeGoal(const Vector& new_goal)
+  {
+    assert(initialized_);
+    goal_ = new_goal;
+    return true;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::changeStart(const Vector& new_start)
+  {
+    assert(initialized_);
+    if (!is_setup_)
+    {
+      Logger::logPrintf("DMP is not setup (Real-time violation).", Logger::ERROR);
+      return false;
+    }
+    start_ = new_start;
+    current_x_ = new_start;
+    current_xd_.setZero();
+    current_xdd_.setZero();
+    return true;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::predict(const double x_query)
+  {
+    if (shared_receptive_fields_)
+    {
+      // the kernels are evaluated only once for all dimensions
+      basis_functions_ = (-(x_query - centers_.col(0).array()).square() * inverse_widths_.col(0).array()).max(FIXED_DMP_MIN_KERNEL_EXPONENT).exp().matrix();
+      basis_functions_ = (basis_functions_.array() < std::numeric_limits<double>::min()).select(0.0, basis_functions_.array()).matrix();
+      const double sx = basis_functions_.sum();
+      if (sx < 0.000000001 && sx > -0.000000001)
+      {
+        return false;
+      }
+      predictions_.noalias() = thetas_.transpose().lazyProduct(basis_functions_);
+      predictions_ *= x_query / sx;
+      return true;
+    }
+    for (int i = 0; i < NUM_DIMENSIONS; ++i)
+    {
+      basis_functions_ = (-(x_query - centers_.col(i).array()).square() * inverse_widths_.col(i).array()).max(FIXED_DMP_MIN_KERNEL_EXPONENT).exp().matrix();
+      basis_functions_ = (basis_functions_.array() < std::numeric_limits<double>::min()).select(0.0, basis_functions_.array()).matrix();
+      const double sx = basis_functions_.sum();
+      if (sx < 0.000000001 && sx > -0.000000001)
+      {
+        return false;
+      }
+      predictions_(i) = (basis_functions_.dot(thetas_.col(i)) * x_query) / sx;
+    }
+    return true;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::propagateStep(Vector& desired_positions,
+                                                                                 Vector& desired_velocities,
+                                                                                 Vector& desired_accelerations,
+                                                                                 bool& movement_finished)
+  {
+    assert(initialized_);
+    movement_finished = false;
+    if (!is_setup_)
+    {
+      Logger::logPrintf("DMP is not setup (Real-time violation).", Logger::ERROR);
+      movement_finished = true;
+      return false;
+    }
+
+    const double x = canonical_system_x_;
+    if (!predict(x))
+    {
+      Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
+      movement_finished = true;
+      return false;
+    }
+
+    // transformation system (see NC2010TransformationSystem::integrate)
+    internal_xdd_.array() = (k_gains_.array() * (goal_.array() - current_x_.array())
+        - d_gains_.array() * internal_xd_.array()
+        - k_gains_.array() * (goal_.array() - start_.array()) * x
+        + k_gains_.array() * predictions_.array() * x) / tau_;
+    current_xd_ = internal_xd_ / tau_;
+    current_xdd_ = internal_xdd_ / tau_;
+    internal_xd_ += internal_xdd_ * delta_t_;
+    current_x_ += current_xd_ * delta_t_;
+
+    desired_positions = current_x_;
+    desired_velocities = current_xd_;
+    desired_accelerations = current_xdd_;
+
+    // canonical system (see NC2010CanonicalSystem::integrate)
+    if (num_generated_samples_ + 1 < num_samples_)
+    {
+      num_generated_samples_++;
+      canonical_system_x_ = exp(-(alpha_x_ / tau_) * canonical_system_time_);
+      canonical_system_time_ += delta_t_;
+    }
+    else
+    {
+      canonical_system_x_ = 0.0;
+      is_setup_ = false;
+      movement_finished = true;
+    }
+    return true;
+  }
+
+// Inline definitions follow
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  inline bool FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::isSetup() const
+  {
+    return is_setup_;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  inline double FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::getProgress() const
+  {
+    if (num_samples_ <= 0)
+    {
+      return 0.0;
+    }
+    return static_cast<double> (num_generated_samples_) / static_cast<double> (num_samples_);
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  inline int FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::getId() const
+  {
+    return id_;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  inline int FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::getNumRFS() const
+  {
+    return num_rfs_;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS, int MAX_NUM_RFS>
+  inline const std::string& FixedDynamicMovementPrimitive<NUM_DIMENSIONS, MAX_NUM_RFS>::getName(const int index) const
+  {
+    assert(initialized_);
+    assert(index >= 0 && index < NUM_DIMENSIONS);
+    return variable_names_[index];
+  }
+
+}
+
+#endif /* FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_ */
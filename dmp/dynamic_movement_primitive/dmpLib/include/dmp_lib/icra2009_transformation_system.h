@@ -121,6 +121,22 @@ public:
     return k_gain / 4.0;
   }
 
+protected:
+
+  /*! Implements derived function, the current acceleration is the derivative of the internal velocity
+   * @param tau
+   * @return
+   */
+  double getAccelerationScale(const double /*tau*/) const
+  {
+    return static_cast<double> (1.0);
+  }
+
+  /*! Implements derived function, copies the gains of all dimensions into the contiguous gain buffers
+   * REAL-TIME REQUIREMENTS
+   */
+  void gatherGains();
+
 private:
 
   /*!
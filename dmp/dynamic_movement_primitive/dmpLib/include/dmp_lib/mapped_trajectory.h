@@ -0,0 +1,215 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Read-only view onto a binary trajectory file that is memory
+            mapped and exposed through Eigen::Map without copying.
+
+ \file		mapped_trajectory.h
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef MAPPED_TRAJECTORY_H_
+#define MAPPED_TRAJECTORY_H_
+
+// system includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <assert.h>
+#include <boost/shared_ptr.hpp>
+#include <Eigen/Core>
+
+// local includes
+#include <dmp_lib/status.h>
+
+namespace dmp_lib
+{
+
+/*! Binary trajectory file layout (version 1). All values are stored in host byte order, the byte_order field is
+ *  used to reject files written on a machine with different endianness.
+ *
+ *  BinaryTrajectoryHeader
+ *  num_dimensions times: variable name '\0' variable unit '\0'
+ *  zero padding up to data_offset (multiple of BINARY_TRAJECTORY_ALIGNMENT)
+ *  positions      : num_samples x num_dimensions doubles, column major
+ *  velocities     : num_samples x num_dimensions doubles, column major (only if positions_only is 0)
+ *  accelerations  : num_samples x num_dimensions doubles, column major (only if positions_only is 0)
+ */
+static const char BINARY_TRAJECTORY_MAGIC[8] = {'D', 'M', 'P', 'T', 'R', 'A', 'J', '\0'};
+static const uint32_t BINARY_TRAJECTORY_VERSION = 1;
+static const uint32_t BINARY_TRAJECTORY_BYTE_ORDER = 0x01020304;
+static const uint32_t BINARY_TRAJECTORY_ALIGNMENT = 64;
+
+/*!
+ */
+struct BinaryTrajectoryHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t num_samples;
+  uint32_t num_dimensions;
+  uint32_t positions_only;
+  uint32_t data_offset;
+  double sampling_frequency;
+};
+
+/*! Maps a binary trajectory file (see Trajectory::writeToBinaryFile) into memory. The positions, velocities, and
+ *  accelerations are accessed in place, i.e. pages are only read from disk when they are touched. The mapping is
+ *  released when the object is destroyed or re-initialized, all maps obtained before become invalid.
+ */
+class MappedTrajectory : public Status
+{
+
+public:
+
+  /*! Abbreviation for convinience
+   */
+  typedef Eigen::Map<const Eigen::MatrixXd> ConstMatrixMap;
+
+  /*! Constructor
+   */
+  MappedTrajectory() :
+    data_(NULL), size_(0), num_samples_(0), num_dimensions_(0), positions_only_(false), sampling_frequency_(0.0),
+    positions_(NULL), velocities_(NULL), accelerations_(NULL) {};
+
+  /*! Destructor, unmaps the file
+   */
+  virtual ~MappedTrajectory();
+
+  /*! Maps the binary trajectory file and validates its header
+   * @param file_name
+   * @return True on success, otherwise False
+   */
+  bool initialize(const std::string& file_name);
+
+  /*! Unmaps the file
+   */
+  void close();
+
+  /*!
+   * @return Number of samples contained in the file
+   */
+  int getNumSamples() const;
+
+  /*!
+   * @return Number of dimensions of the trajectory
+   */
+  int getDimension() const;
+
+  /*!
+   * @return
+   */
+  double getSamplingFrequency() const;
+
+  /*!
+   * @return True if the file only contains positions, otherwise False
+   */
+  bool containsPositionsOnly() const;
+
+  /*!
+   * @return
+   */
+  const std::vector<std::string>& getVariableNames() const;
+  const std::vector<std::string>& getVariableUnits() const;
+
+  /*!
+   * @return num_samples x num_dimensions matrix pointing into the mapped file
+   */
+  ConstMatrixMap getPositions() const;
+
+  /*! Must only be called if the file contains velocities and accelerations
+   * @return num_samples x num_dimensions matrix pointing into the mapped file
+   */
+  ConstMatrixMap getVelocities() const;
+  ConstMatrixMap getAccelerations() const;
+
+private:
+
+  /*! The mapping must not be shared
+   */
+  MappedTrajectory(const MappedTrajectory& other);
+  MappedTrajectory& operator=(const MappedTrajectory& other);
+
+  /*!
+   */
+  void* data_;
+  size_t size_;
+
+  int num_samples_;
+  int num_dimensions_;
+  bool positions_only_;
+  double sampling_frequency_;
+
+  std::vector<std::string> variable_names_;
+  std::vector<std::string> variable_units_;
+
+  /*! Pointers into the mapped file
+   */
+  const double* positions_;
+  const double* velocities_;
+  const double* accelerations_;
+
+};
+
+/*! Abbreviation for convinience
+ */
+typedef boost::shared_ptr<MappedTrajectory> MappedTrajectoryPtr;
+
+// Inline functions follow
+inline int MappedTrajectory::getNumSamples() const
+{
+  assert(initialized_);
+  return num_samples_;
+}
+inline int MappedTrajectory::getDimension() const
+{
+  assert(initialized_);
+  return num_dimensions_;
+}
+inline double MappedTrajectory::getSamplingFrequency() const
+{
+  assert(initialized_);
+  return sampling_frequency_;
+}
+inline bool MappedTrajectory::containsPositionsOnly() const
+{
+  assert(initialized_);
+  return positions_only_;
+}
+inline const std::vector<std::string>& MappedTrajectory::getVariableNames() const
+{
+  assert(initialized_);
+  return variable_names_;
+}
+inline const std::vector<std::string>& MappedTrajectory::getVariableUnits() const
+{
+  assert(initialized_);
+  return variable_units_;
+}
+inline MappedTrajectory::ConstMatrixMap MappedTrajectory::getPositions() const
+{
+  assert(initialized_);
+  return ConstMatrixMap(positions_, num_samples_, num_dimensions_);
+}
+inline MappedTrajectory::ConstMatrixMap MappedTrajectory::getVelocities() const
+{
+  assert(initialized_);
+  assert(!positions_only_);
+  return ConstMatrixMap(velocities_, num_samples_, num_dimensions_);
+}
+inline MappedTrajectory::ConstMatrixMap MappedTrajectory::getAccelerations() const
+{
+  assert(initialized_);
+  assert(!positions_only_);
+  return ConstMatrixMap(accelerations_, num_samples_, num_dimensions_);
+}
+
+}
+
+#endif /* MAPPED_TRAJECTORY_H_ */
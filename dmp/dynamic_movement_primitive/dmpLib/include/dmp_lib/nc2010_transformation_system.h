@@ -120,6 +120,22 @@ public:
     return k_gain / 4.0;
   }
 
+protected:
+
+  /*! Implements derived function, the current acceleration is the derivative of the internal velocity divided by tau
+   * @param tau
+   * @return
+   */
+  double getAccelerationScale(const double tau) const
+  {
+    return static_cast<double> (1.0) / tau;
+  }
+
+  /*! Implements derived function, copies the gains of all dimensions into the contiguous gain buffers
+   * REAL-TIME REQUIREMENTS
+   */
+  void gatherGains();
+
 private:
 
   /*!
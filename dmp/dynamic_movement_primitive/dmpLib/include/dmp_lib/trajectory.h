@@ -34,6 +34,13 @@ static const int MAX_TRAJECTORY_DIMENSION = 180;
 static const int ABSOLUTE_MAX_TRAJECTORY_LENGTH = 20 * MAX_TRAJECTORY_LENGTH;
 static const int ABSOLUTE_MAX_TRAJECTORY_DIMENSION = 20 * MAX_TRAJECTORY_DIMENSION;
 
+/*! Trajectories initialized with this length start empty and grow on demand
+ */
+static const int DYNAMIC_TRAJECTORY_LENGTH = 0;
+/*! Minimum number of samples allocated when a dynamic trajectory grows
+ */
+static const int MIN_TRAJECTORY_GROWTH = 64;
+
 /*!
  */
 class Trajectory : public Status
@@ -46,6 +53,7 @@ public:
    */
   Trajectory() :
     positions_only_(false),
+    fixed_capacity_(false),
     trajectory_length_(0),
     trajectory_dimension_(0),
     index_to_last_trajectory_point_(0),
@@ -59,8 +67,10 @@ public:
   /*!
    * @param variable_names
    * @param sampling_frequency
-   * @param positions_only
-   * @param trajectory_length
+   * @param positions_only If set, velocities and accelerations are not allocated
+   * @param trajectory_length Number of samples to preallocate. The capacity of such trajectories is fixed, i.e. adding
+   *        samples never allocates memory (real-time mode). Pass DYNAMIC_TRAJECTORY_LENGTH to start with an empty
+   *        trajectory that grows on demand.
    * @return True on success, otherwise False
    */
   bool initialize(const std::vector<std::string>& variable_names,
@@ -223,6 +233,23 @@ public:
   bool writeToCLMCFile(const std::string& file_name,
                        const bool positions_only = false) const;
 
+  /*! Initializes the trajectory from the binary trajectory file (see MappedTrajectory) pointed to by file_name.
+   *  To access the data without copying use MappedTrajectory directly.
+   * @param file_name
+   * @param positions_only If set, velocities and accelerations contained in the file are ignored
+   * @return True on success, otherwise False
+   */
+  bool readFromBinaryFile(const std::string& file_name,
+                          const bool positions_only = false);
+
+  /*! Writes the contained samples into a binary trajectory file that can be memory mapped (see MappedTrajectory)
+   * @param file_name
+   * @param positions_only
+   * @return True on success, otherwise False
+   */
+  bool writeToBinaryFile(const std::string& file_name,
+                         const bool positions_only = false) const;
+
   /*!
    * @param other_trajectory
    * @param verbose
@@ -254,6 +281,22 @@ public:
    */
   int getNumContainedSamples() const;
 
+  /*! Grows the capacity such that the trajectory can hold num_samples samples. Contained samples are preserved.
+   *  This also works for trajectories with fixed capacity, however, it is not real-time safe.
+   * @param num_samples
+   * @return True on success, otherwise False
+   */
+  bool reserve(const int num_samples);
+
+  /*! Releases the capacity that is not used by the contained samples
+   */
+  void shrinkToFit();
+
+  /*!
+   * @return True if the capacity is fixed, i.e. adding samples never allocates memory, otherwise False
+   */
+  bool hasFixedCapacity() const;
+
   /*!
    * @return
    */
@@ -465,9 +508,9 @@ public:
    */
   bool cut(Trajectory& other_trajectory, bool verbose = true);
 
-  /*!
+  /*! Trajectories with fixed capacity are not grown, i.e. appending fails if the other trajectory does not fit
    * @param other_trajectory
-   * @return
+   * @return True on success, otherwise False
    */
   bool append(const Trajectory& other_trajectory);
 
@@ -477,7 +520,11 @@ private:
    */
   bool positions_only_;
 
-  /*!
+  /*! If set, the trajectory never grows when adding samples
+   */
+  bool fixed_capacity_;
+
+  /*! Capacity of the trajectory
    */
   int trajectory_length_;
   int trajectory_dimension_;
@@ -547,6 +594,12 @@ private:
    */
   void clear();
 
+  /*! Reallocates positions (and velocities and accelerations) to hold trajectory_length samples, contained samples are
+   *  preserved as long as they fit.
+   * @param trajectory_length
+   */
+  void resize(const int trajectory_length);
+
   /*!
    * @param start
    * @param goal
@@ -607,6 +660,10 @@ inline int Trajectory::getNumContainedSamples() const
   assert(initialized_);
   return index_to_last_trajectory_point_;
 }
+inline bool Trajectory::hasFixedCapacity() const
+{
+  return fixed_capacity_;
+}
 inline double Trajectory::getDuration() const
 {
   assert(initialized_);
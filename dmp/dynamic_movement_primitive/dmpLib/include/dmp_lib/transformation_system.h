@@ -18,8 +18,11 @@
 // system include
 #include <vector>
 #include <string>
+#include <utility>
 #include <boost/shared_ptr.hpp>
 
+#include <Eigen/Core>
+
 // local include
 #include <dmp_lib/transformation_system_parameters.h>
 #include <dmp_lib/transformation_system_state.h>
@@ -46,7 +49,7 @@ public:
   /*! Constructor
    */
   TransformationSystem() :
-    integration_method_(NORMAL) {};
+    integration_method_(NORMAL), shared_receptive_fields_(false) {};
 
   /*! Destructor
    */
@@ -106,6 +109,25 @@ public:
                          const Eigen::VectorXd& feedback,
                          const int num_iterations = 1) = 0;
 
+  /*! Integrates the transformation system over an entire rollout at once. The nonlinearity is computed for all
+   * phases as one (banded) matrix product of the weights and the normalized basis functions, which are cached
+   * across calls with identical phases (reset by initializeBuffers), and the linear part is discretized exactly assuming the forcing term to be
+   * piecewise linear between two phases (first order hold), which is more accurate than the euler steps taken
+   * by integrate. The samples are aligned the same way as the states returned by integrate, i.e. row n contains
+   * the positions after n+1 steps and the velocities and accelerations after n steps. Only NORMAL integration is supported.
+   * @param phases : the canonical system state at each time step (num_samples + 1)
+   * @param dmp_time
+   * @param positions : (num_samples x num_dimensions)
+   * @param velocities : (num_samples x num_dimensions)
+   * @param accelerations : (num_samples x num_dimensions)
+   * @return True on success, otherwise False
+   */
+  bool integrateFull(const Eigen::VectorXd& phases,
+                     const Time& dmp_time,
+                     Eigen::MatrixXd& positions,
+                     Eigen::MatrixXd& velocities,
+                     Eigen::MatrixXd& accelerations);
+
   /*!
    * @param index
    * @param current_state
@@ -318,6 +340,97 @@ protected:
    */
   IntegrationMethod integration_method_;
 
+  /*! Computes the nonlinearity (LWR prediction) of all dimensions for the given phase and stores them in predictions_.
+   * The basis functions are evaluated only once if all dimensions share the same receptive fields. If the receptive
+   * fields of any lwr model have been changed since the last call, this is re-checked first (which allocates memory).
+   * @param x_query
+   * @return False if the lwr model could not come up with a prediction, otherwise True.
+   * REAL-TIME REQUIREMENTS
+   */
+  bool predict(const double x_query);
+
+  /*! Checks whether all lwr models share the same receptive fields and pre-allocates the buffers used by predict
+   * as well as the contiguous state buffers. Needs to be called whenever the lwr models or the dimensions change.
+   */
+  void initializeBuffers();
+
+  /*! Copies the gains, goal, start, internal and current states of all dimensions into the contiguous buffers below
+   * REAL-TIME REQUIREMENTS
+   */
+  void gatherStates();
+
+  /*! Copies the contiguous buffers below back into the per dimension states (goal and start are not changed)
+   * REAL-TIME REQUIREMENTS
+   */
+  void scatterStates();
+
+  /*! Returns the factor between the derivative of the internal velocity and the acceleration reported in the current state
+   * @param tau
+   * @return
+   */
+  virtual double getAccelerationScale(const double tau) const = 0;
+
+  /*! Copies the gains of all dimensions into k_gains_ and d_gains_. Called by gatherStates such that gains
+   * that have been changed after initialization are used right away.
+   * REAL-TIME REQUIREMENTS
+   */
+  virtual void gatherGains() = 0;
+
+  /*! Predictions of the lwr models of all dimensions (computed by predict)
+   */
+  Eigen::VectorXd predictions_;
+
+  /*! Contiguous (structure of arrays) copy of the gains and states of all dimensions used by the
+   * integration. The gains are set by the derived classes (see gatherGains).
+   */
+  Eigen::VectorXd k_gains_;
+  Eigen::VectorXd d_gains_;
+  Eigen::VectorXd goals_;
+  Eigen::VectorXd starts_;
+  Eigen::VectorXd internal_x_;
+  Eigen::VectorXd internal_xd_;
+  Eigen::VectorXd internal_xdd_;
+  Eigen::VectorXd current_x_;
+  Eigen::VectorXd current_xd_;
+  Eigen::VectorXd current_xdd_;
+  Eigen::VectorXd f_;
+
+private:
+
+  /*! True if all lwr models use the same centers and widths
+   */
+  bool shared_receptive_fields_;
+
+  /*! Receptive field revisions of all lwr models at the time shared_receptive_fields_ was determined
+   */
+  std::vector<unsigned long> receptive_field_revisions_;
+
+  /*! Determines shared_receptive_fields_, (re-)allocates basis_functions_ and clears the cached basis functions
+   */
+  void initializeReceptiveFields();
+
+  /*! Checks whether the receptive fields of any lwr model have been changed (or models have been replaced)
+   * @return True if initializeReceptiveFields needs to be called
+   * REAL-TIME REQUIREMENTS
+   */
+  bool haveReceptiveFieldsChanged() const;
+
+  /*! Pre-allocated basis function activations
+   */
+  Eigen::VectorXd basis_functions_;
+
+  /*! Phases for which the normalized basis functions have been cached by integrateFull
+   */
+  Eigen::VectorXd cached_phases_;
+
+  /*! Normalized basis functions (num_rfs x num_phases) for the cached phases
+   */
+  Eigen::MatrixXd cached_basis_function_matrix_;
+
+  /*! Index of the first active basis function and the number of active basis functions for each cached phase
+   */
+  std::vector<std::pair<int, int> > cached_basis_function_ranges_;
+
 };
 
 /*! Abbreviation for convinience
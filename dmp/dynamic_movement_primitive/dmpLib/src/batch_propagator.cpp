@@ -0,0 +1,197 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		...
+
+ \file		batch_propagator.cpp
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <stdio.h>
+#include <cassert>
+#include <boost/bind.hpp>
+
+// local includes
+#include <dmp_lib/batch_propagator.h>
+#include <dmp_lib/logger.h>
+
+using namespace std;
+
+namespace dmp_lib
+{
+
+BatchPropagator::~BatchPropagator()
+{
+  stop();
+}
+
+bool BatchPropagator::initialize(const int num_threads)
+{
+  if (num_threads < 0)
+  {
+    Logger::logPrintf("Number of threads >%i< is invalid. Cannot initialize batch propagator.", Logger::ERROR, num_threads);
+    return (initialized_ = false);
+  }
+  Logger::logPrintf(initialized_, "Batch propagator already initialized. Re-initializing...", Logger::WARN);
+  stop();
+
+  num_threads_ = num_threads;
+  if (num_threads_ == 0)
+  {
+    num_threads_ = static_cast<int> (boost::thread::hardware_concurrency());
+  }
+  if (num_threads_ < 1)
+  {
+    num_threads_ = 1;
+  }
+
+  // the workers are passed the current generation such that a batch submitted before they get to run is not missed
+  boost::mutex::scoped_lock lock(mutex_);
+  stop_ = false;
+  for (int i = 0; i < num_threads_; ++i)
+  {
+    threads_.push_back(boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&BatchPropagator::run, this, generation_))));
+  }
+  return (initialized_ = true);
+}
+
+void BatchPropagator::stop()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  batch_available_condition_.notify_all();
+  for (int i = 0; i < (int)threads_.size(); ++i)
+  {
+    threads_[i]->join();
+  }
+  threads_.clear();
+}
+
+bool BatchPropagator::propagateFull(vector<DMPPtr>& dmps,
+                                    vector<Trajectory>& trajectories,
+                                    const double sampling_duration,
+                                    const int num_samples,
+                                    const bool offline)
+{
+  if (!initialized_)
+  {
+    Logger::logPrintf("Batch propagator is not initialized. Cannot propagate dmps.", Logger::ERROR);
+    return false;
+  }
+  if (dmps.empty())
+  {
+    return true;
+  }
+  for (int i = 0; i < (int)dmps.size(); ++i)
+  {
+    for (int j = 0; j < i; ++j)
+    {
+      if (dmps[i].get() == dmps[j].get())
+      {
+        Logger::logPrintf("DMP >%i< and >%i< are the same object. Cannot propagate them concurrently.", Logger::ERROR, j, i);
+        return false;
+      }
+    }
+  }
+  if (trajectories.size() != dmps.size())
+  {
+    trajectories.resize(dmps.size());
+  }
+
+  boost::mutex::scoped_lock lock(mutex_);
+  dmps_ = &dmps;
+  trajectories_ = &trajectories;
+  sampling_duration_ = sampling_duration;
+  num_samples_ = num_samples;
+  offline_ = offline;
+  next_index_ = 0;
+  num_finished_ = 0;
+  success_ = true;
+  generation_++;
+  batch_available_condition_.notify_all();
+
+  while (num_finished_ < (int)dmps.size())
+  {
+    batch_finished_condition_.wait(lock);
+  }
+  dmps_ = NULL;
+  trajectories_ = NULL;
+  return success_;
+}
+
+void BatchPropagator::run(unsigned int generation)
+{
+  while (true)
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (!stop_ && generation == generation_)
+      {
+        batch_available_condition_.wait(lock);
+      }
+      if (stop_)
+      {
+        return;
+      }
+      generation = generation_;
+    }
+    processBatch();
+  }
+}
+
+void BatchPropagator::processBatch()
+{
+  while (true)
+  {
+    int index = 0;
+    DMPPtr dmp;
+    Trajectory* trajectory = NULL;
+    double sampling_duration = 0.0;
+    int num_samples = 0;
+    bool offline = false;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if (dmps_ == NULL || next_index_ >= (int)dmps_->size())
+      {
+        return;
+      }
+      index = next_index_++;
+      dmp = (*dmps_)[index];
+      trajectory = &(*trajectories_)[index];
+      sampling_duration = sampling_duration_;
+      num_samples = num_samples_;
+      offline = offline_;
+    }
+
+    bool success = false;
+    if (offline)
+    {
+      success = dmp->propagateFullOffline(*trajectory, sampling_duration, num_samples);
+    }
+    else
+    {
+      success = dmp->propagateFull(*trajectory, sampling_duration, num_samples);
+    }
+    Logger::logPrintf(!success, "Could not propagate dmp >%i<.", Logger::ERROR, index);
+
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      success_ = success_ && success;
+      num_finished_++;
+      if (num_finished_ == (int)dmps_->size())
+      {
+        batch_finished_condition_.notify_all();
+      }
+    }
+  }
+}
+
+}
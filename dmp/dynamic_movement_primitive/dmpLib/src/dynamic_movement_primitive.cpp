@@ -958,6 +958,103 @@ bool DynamicMovementPrimitive::propagateFull(Trajectory& trajectory,
   return propagateFull(trajectory, sampling_duration, num_samples);
 }
 
+bool DynamicMovementPrimitive::propagateFullOffline(Trajectory& trajectory,
+                                                    const double sampling_duration,
+                                                    const int num_samples)
+{
+  assert(initialized_);
+  for (int i = 0; i < getNumTransformationSystems(); ++i)
+  {
+    if (transformation_systems_[i]->getIntegrationMethod() != TransformationSystem::NORMAL)
+    {
+      Logger::logPrintf("Transformation system >%i< cannot be integrated offline, propagating step by step.", Logger::DEBUG, i);
+      return propagateFull(trajectory, sampling_duration, num_samples);
+    }
+  }
+  if(!isReadyToPropagate() || (sampling_duration < 1e-10) || num_samples < 1)
+  {
+    return false;
+  }
+
+  // initialize trajectory
+  double special_sampling_frequency = static_cast<double> (num_samples) / (sampling_duration);
+  if (!trajectory.initialize(getVariableNames(), special_sampling_frequency, false, num_samples))
+  {
+    Logger::logPrintf("Could not initialize trajectory to store rollout.", Logger::ERROR);
+    return false;
+  }
+  if (!state_->current_time_.setDeltaT(sampling_duration / static_cast<double> (num_samples))
+      || !state_->current_time_.setTau(sampling_duration))
+  {
+    return false;
+  }
+
+  // the canonical system is an exponential decay, compute its state for all samples at once
+  VectorXd phases = VectorXd::Zero(num_samples + 1);
+  const double decay = -(canonical_system_->parameters_->getAlphaX() / state_->current_time_.getTau()) * state_->current_time_.getDeltaT();
+  for (int n = 0; n <= num_samples; ++n)
+  {
+    phases(n) = exp(decay * static_cast<double> (n));
+  }
+
+  MatrixXd positions = MatrixXd::Zero(num_samples, getNumDimensions());
+  MatrixXd velocities = MatrixXd::Zero(num_samples, getNumDimensions());
+  MatrixXd accelerations = MatrixXd::Zero(num_samples, getNumDimensions());
+  vector<MatrixXd> ts_positions(getNumTransformationSystems());
+  vector<MatrixXd> ts_velocities(getNumTransformationSystems());
+  vector<MatrixXd> ts_accelerations(getNumTransformationSystems());
+  for (int i = 0; i < getNumTransformationSystems(); ++i)
+  {
+    if (!transformation_systems_[i]->integrateFull(phases, state_->current_time_, ts_positions[i], ts_velocities[i], ts_accelerations[i]))
+    {
+      Logger::logPrintf("Could not integrate transformation system >%i<.", Logger::ERROR, i);
+      return false;
+    }
+  }
+  for (int i = 0; i < getNumDimensions(); ++i)
+  {
+    positions.col(i) = ts_positions[indices_[i].first].col(indices_[i].second);
+    velocities.col(i) = ts_velocities[indices_[i].first].col(indices_[i].second);
+    accelerations.col(i) = ts_accelerations[indices_[i].first].col(indices_[i].second);
+  }
+
+  VectorXd desired_positions = VectorXd::Zero(getNumDimensions());
+  VectorXd desired_velocities = VectorXd::Zero(getNumDimensions());
+  VectorXd desired_accelerations = VectorXd::Zero(getNumDimensions());
+  for (int n = 0; n < num_samples; ++n)
+  {
+    desired_positions = positions.row(n).transpose();
+    desired_velocities = velocities.row(n).transpose();
+    desired_accelerations = accelerations.row(n).transpose();
+    if (!trajectory.add(desired_positions, desired_velocities, desired_accelerations))
+    {
+      Logger::logPrintf("Could not add positions, velocities, and accelerations to trajectory.", Logger::ERROR);
+      return false;
+    }
+  }
+
+  // leave the dmp in the same state as propagateFull does
+  state_->num_generated_samples_ = num_samples - 1;
+  canonical_system_->getState()->setCanX(0.0);
+  state_->is_start_set_ = false;
+  state_->is_setup_ = false;
+  return true;
+}
+
+bool DynamicMovementPrimitive::propagateFullOffline(Trajectory& trajectory,
+                                                    const double sampling_duration)
+{
+  assert(initialized_);
+  double initial_sampling_frequency = 0.0;
+  if(!getInitialSamplingFrequency(initial_sampling_frequency))
+  {
+    Logger::logPrintf("Cannot get initial sampling frequency. Cannot propagate DMP full.", Logger::ERROR);
+    return false;
+  }
+  const int num_samples = static_cast<int> (floor(sampling_duration * initial_sampling_frequency));
+  return propagateFullOffline(trajectory, sampling_duration, num_samples);
+}
+
 // REAL-TIME REQUIREMENTS
 bool DynamicMovementPrimitive::integrate(const int num_iteration, const VectorXd& feedback)
 {
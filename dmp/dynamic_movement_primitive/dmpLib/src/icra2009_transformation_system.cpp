@@ -53,6 +53,7 @@ ICRA2009TransformationSystem& ICRA2009TransformationSystem::operator=(const ICRA
     TransformationSystem::states_.push_back(states_[i]);
   }
   integration_method_ = icra2009ts.integration_method_;
+  initializeBuffers();
   initialized_ = icra2009ts.initialized_;
   return *this;
 }
@@ -89,7 +90,21 @@ bool ICRA2009TransformationSystem::initialize(const vector<ICRA2009TSParamPtr> p
   {
     ts_states.push_back(states_[i]);
   }
-  return TransformationSystem::initialize(ts_params, ts_states, integration_method);
+  if (!TransformationSystem::initialize(ts_params, ts_states, integration_method))
+  {
+    return false;
+  }
+  return true;
+}
+
+// REAL-TIME REQUIREMENTS
+void ICRA2009TransformationSystem::gatherGains()
+{
+  for (int i = 0; i < (int)parameters_.size(); ++i)
+  {
+    k_gains_(i) = parameters_[i]->k_gain_;
+    d_gains_(i) = parameters_[i]->d_gain_;
+  }
 }
 
 bool ICRA2009TransformationSystem::get(ICRA2009TSParamConstPtr& parameters,
@@ -325,52 +340,41 @@ bool ICRA2009TransformationSystem::integrate(const CSStatePtr canonical_system_s
   {
     case NORMAL:
     {
-      double dt = dmp_time.getDeltaT() / static_cast<double> (num_iterations);
-      for (int i = 0; i < getNumDimensions(); ++i)
+      // compute nonlinearity of all dimensions using LWR
+      if (!predict(canonical_system_state->getStateX()))
       {
-        for (int n = 0; n < num_iterations; ++n)
-        {
-          // for debugging only
-          states_[i]->internal_.setX(feedback(i));
-
-          // compute nonlinearity using LWR
-          double prediction = 0;
-          if (!parameters_[i]->lwr_model_->predict(canonical_system_state->getStateX(), prediction))
-          {
-            Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
-            return false;
-          }
-
-          states_[i]->f_ = prediction * canonical_system_state->getCanX();
-
-          // compute transformation system
-          states_[i]->internal_.setXdd(((parameters_[i]->k_gain_ * (states_[i]->goal_ - states_[i]->current_.getX())
-              - parameters_[i]->d_gain_ * states_[i]->internal_.getXd()
-              - parameters_[i]->k_gain_ * (states_[i]->goal_ - states_[i]->start_) * canonical_system_state->getCanX()
-              + parameters_[i]->k_gain_ * states_[i]->f_) / dmp_time.getTau())
-              + feedback(i));
-
-          states_[i]->current_.setXd(states_[i]->internal_.getXd() / dmp_time.getTau());
-          states_[i]->current_.setXdd((states_[i]->internal_.getXdd()));
-
-          // integrate the system twice
-          states_[i]->internal_.addXd(states_[i]->current_.getXdd() * dt);
-          states_[i]->current_.addX(states_[i]->current_.getXd() * dt);
-
-          /*
-           states_[i]->internal_.setXdd(((parameters_[i]->k_gain_ * (states_[i]->goal_ - states_[i]->current_.getX())
-           - parameters_[i]->d_gain_ * states_[i]->current_.getXd() - parameters_[i]->k_gain_ * (states_[i]->goal_
-           - states_[i]->start_) * canonical_system_state->getStateX() + parameters_[i]->k_gain_ * states_[i]->f_)
-           / dmp_time.getTau()) + feedback(i));
-           states_[i]->internal_.setXd(states_[i]->current_.getXd() / dmp_time.getTau());
-           // integrate the system twice
-           states_[i]->current_.setXdd(states_[i]->internal_.getXdd());
-           states_[i]->current_.addXd(states_[i]->internal_.getXdd() * dt);
-           states_[i]->current_.addX(states_[i]->internal_.getXd() * dt);
-           */
+        Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
+        return false;
+      }
 
-        }
+      // operate on contiguous copies of the states of all dimensions
+      gatherStates();
+
+      // for debugging only
+      internal_x_ = feedback;
+
+      const double can_x = canonical_system_state->getCanX();
+      const double tau = dmp_time.getTau();
+      const double dt = dmp_time.getDeltaT() / static_cast<double> (num_iterations);
+      f_.array() = predictions_.array() * can_x;
+      for (int n = 0; n < num_iterations; ++n)
+      {
+        // compute transformation system
+        internal_xdd_.array() = ((k_gains_.array() * (goals_.array() - current_x_.array())
+            - d_gains_.array() * internal_xd_.array()
+            - k_gains_.array() * (goals_.array() - starts_.array()) * can_x
+            + k_gains_.array() * f_.array()) / tau)
+            + feedback.array();
+
+        current_xd_.array() = internal_xd_.array() / tau;
+        current_xdd_ = internal_xdd_;
+
+        // integrate the system twice
+        internal_xd_.array() += current_xdd_.array() * dt;
+        current_x_.array() += current_xd_.array() * dt;
       }
+
+      scatterStates();
       break;
     }
     case QUATERNION:
@@ -382,6 +386,13 @@ bool ICRA2009TransformationSystem::integrate(const CSStatePtr canonical_system_s
         states_[i]->internal_.setX(feedback(i));
       }
 
+      // compute nonlinearity using LWR
+      if (!predict(canonical_system_state->getStateX()))
+      {
+        Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
+        return false;
+      }
+
       double dt = dmp_time.getDeltaT() / static_cast<double> (num_iterations);
       for (int n = 0; n < num_iterations; ++n)
       {
@@ -389,14 +400,7 @@ bool ICRA2009TransformationSystem::integrate(const CSStatePtr canonical_system_s
         Vector3d f;
         for (int i = 1; i < 4; ++i)
         {
-          // compute nonlinearity using LWR
-          double prediction = 0;
-          if (!parameters_[i]->lwr_model_->predict(canonical_system_state->getStateX(), prediction))
-          {
-            Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
-            return false;
-          }
-          f(i-1) = prediction * canonical_system_state->getCanX();
+          f(i-1) = predictions_(i) * canonical_system_state->getCanX();
         }
 
         Matrix3d K = Matrix3d::Zero();
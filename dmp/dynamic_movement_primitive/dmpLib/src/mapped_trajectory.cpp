@@ -0,0 +1,168 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		...
+
+ \file		mapped_trajectory.cpp
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// local includes
+#include <dmp_lib/mapped_trajectory.h>
+#include <dmp_lib/logger.h>
+
+using namespace std;
+
+namespace dmp_lib
+{
+
+MappedTrajectory::~MappedTrajectory()
+{
+  close();
+}
+
+bool MappedTrajectory::initialize(const string& file_name)
+{
+  close();
+
+  int file_descriptor = open(file_name.c_str(), O_RDONLY);
+  if (file_descriptor < 0)
+  {
+    Logger::logPrintf("Cannot open file >%s< : %s.", Logger::ERROR, file_name.c_str(), strerror(errno));
+    return (initialized_ = false);
+  }
+  struct stat file_status;
+  if (fstat(file_descriptor, &file_status) != 0)
+  {
+    Logger::logPrintf("Cannot stat file >%s< : %s.", Logger::ERROR, file_name.c_str(), strerror(errno));
+    ::close(file_descriptor);
+    return (initialized_ = false);
+  }
+  if (file_status.st_size < static_cast<off_t> (sizeof(BinaryTrajectoryHeader)))
+  {
+    Logger::logPrintf("File >%s< is too small to contain a binary trajectory.", Logger::ERROR, file_name.c_str());
+    ::close(file_descriptor);
+    return (initialized_ = false);
+  }
+  size_ = static_cast<size_t> (file_status.st_size);
+  data_ = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+  // the mapping stays valid after closing the file descriptor
+  ::close(file_descriptor);
+  if (data_ == MAP_FAILED)
+  {
+    Logger::logPrintf("Cannot mmap file >%s< : %s.", Logger::ERROR, file_name.c_str(), strerror(errno));
+    data_ = NULL;
+    size_ = 0;
+    return (initialized_ = false);
+  }
+
+  const char* bytes = static_cast<const char*> (data_);
+  BinaryTrajectoryHeader header;
+  memcpy(&header, bytes, sizeof(BinaryTrajectoryHeader));
+  if (memcmp(header.magic, BINARY_TRAJECTORY_MAGIC, sizeof(BINARY_TRAJECTORY_MAGIC)) != 0)
+  {
+    Logger::logPrintf("File >%s< is not a binary trajectory file.", Logger::ERROR, file_name.c_str());
+    close();
+    return false;
+  }
+  if (header.version != BINARY_TRAJECTORY_VERSION)
+  {
+    Logger::logPrintf("Binary trajectory file >%s< has version >%u<, however, only version >%u< is supported.", Logger::ERROR,
+                      file_name.c_str(), header.version, BINARY_TRAJECTORY_VERSION);
+    close();
+    return false;
+  }
+  if (header.byte_order != BINARY_TRAJECTORY_BYTE_ORDER)
+  {
+    Logger::logPrintf("Binary trajectory file >%s< has been written on a machine with different byte order.", Logger::ERROR, file_name.c_str());
+    close();
+    return false;
+  }
+  if (header.num_samples == 0 || header.num_dimensions == 0 || header.sampling_frequency <= 0.0)
+  {
+    Logger::logPrintf("Binary trajectory file >%s< contains >%u< samples of >%u< dimensions with sampling frequency >%.1f<, which is invalid.",
+                      Logger::ERROR, file_name.c_str(), header.num_samples, header.num_dimensions, header.sampling_frequency);
+    close();
+    return false;
+  }
+  const uint64_t num_blocks = header.positions_only ? 1 : 3;
+  const uint64_t data_size = num_blocks * header.num_samples * header.num_dimensions * sizeof(double);
+  if (header.data_offset < sizeof(BinaryTrajectoryHeader) || (header.data_offset % sizeof(double)) != 0
+      || static_cast<uint64_t> (header.data_offset) + data_size > static_cast<uint64_t> (size_))
+  {
+    Logger::logPrintf("Binary trajectory file >%s< is truncated or corrupted.", Logger::ERROR, file_name.c_str());
+    close();
+    return false;
+  }
+
+  // variable names and units are stored as pairs of null terminated strings
+  const char* names = bytes + sizeof(BinaryTrajectoryHeader);
+  const char* names_end = bytes + header.data_offset;
+  for (uint32_t i = 0; i < 2 * header.num_dimensions; ++i)
+  {
+    const char* end = static_cast<const char*> (memchr(names, '\0', names_end - names));
+    if (end == NULL)
+    {
+      Logger::logPrintf("Could not read variable names from binary trajectory file >%s<.", Logger::ERROR, file_name.c_str());
+      close();
+      return false;
+    }
+    if (i % 2 == 0)
+    {
+      variable_names_.push_back(string(names, end));
+    }
+    else
+    {
+      variable_units_.push_back(string(names, end));
+    }
+    names = end + 1;
+  }
+
+  num_samples_ = static_cast<int> (header.num_samples);
+  num_dimensions_ = static_cast<int> (header.num_dimensions);
+  positions_only_ = (header.positions_only != 0);
+  sampling_frequency_ = header.sampling_frequency;
+  const size_t block_size = header.num_samples * header.num_dimensions;
+  positions_ = reinterpret_cast<const double*> (bytes + header.data_offset);
+  if (!positions_only_)
+  {
+    velocities_ = positions_ + block_size;
+    accelerations_ = velocities_ + block_size;
+  }
+  return (initialized_ = true);
+}
+
+void MappedTrajectory::close()
+{
+  if (data_ != NULL)
+  {
+    munmap(data_, size_);
+  }
+  data_ = NULL;
+  size_ = 0;
+  num_samples_ = 0;
+  num_dimensions_ = 0;
+  positions_only_ = false;
+  sampling_frequency_ = 0.0;
+  variable_names_.clear();
+  variable_units_.clear();
+  positions_ = NULL;
+  velocities_ = NULL;
+  accelerations_ = NULL;
+  initialized_ = false;
+}
+
+}
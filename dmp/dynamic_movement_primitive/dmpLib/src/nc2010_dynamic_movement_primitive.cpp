@@ -110,10 +110,13 @@ bool NC2010DynamicMovementPrimitive::initialize(const vector<string>& variable_n
   assert(!variable_names.empty());
   assert(lwr_parameters->isInitialized());
 
-  vector<TSPtr> nc2010_transformation_systems;
+  // all variables are integrated by a single multi dimensional transformation system such that the
+  // integration can operate on contiguous buffers and the basis functions are evaluated only once
+  vector<NC2010TSParamPtr> nc2010_transformation_system_parameters;
+  vector<NC2010TSStatePtr> nc2010_transformation_system_states;
   for (int i = 0; i < (int)variable_names.size(); ++i)
   {
-    NC2010TSParamPtr nc2010_transformation_system_parameters(new NC2010TransformationSystemParameters());
+    NC2010TSParamPtr parameters(new NC2010TransformationSystemParameters());
 
     lwr_lib::LWRPtr lwr_model(new lwr_lib::LWR());
     if (!lwr_model->initialize(lwr_parameters))
@@ -122,23 +125,25 @@ bool NC2010DynamicMovementPrimitive::initialize(const vector<string>& variable_n
       return false;
     }
 
-    if (!nc2010_transformation_system_parameters->initialize(lwr_model, variable_names[i], k_gain, d_gain))
+    if (!parameters->initialize(lwr_model, variable_names[i], k_gain, d_gain))
     {
       Logger::logPrintf("Could not initialize transformation system parameters.", Logger::ERROR);
       return false;
     }
+    nc2010_transformation_system_parameters.push_back(parameters);
+    nc2010_transformation_system_states.push_back(NC2010TSStatePtr(new NC2010TransformationSystemState()));
+  }
 
-    NC2010TSStatePtr nc2010_transformation_system_state(new NC2010TransformationSystemState());
-    NC2010TSPtr nc2010_transformation_system(new NC2010TransformationSystem());
-    if (!nc2010_transformation_system->initialize(nc2010_transformation_system_parameters,
-                                                  nc2010_transformation_system_state,
-                                                  TransformationSystem::NORMAL))
-    {
-      Logger::logPrintf("Could not initialize transformation system.", Logger::ERROR);
-      return false;
-    }
-    nc2010_transformation_systems.push_back(nc2010_transformation_system);
+  NC2010TSPtr nc2010_transformation_system(new NC2010TransformationSystem());
+  if (!nc2010_transformation_system->initialize(nc2010_transformation_system_parameters,
+                                                nc2010_transformation_system_states,
+                                                TransformationSystem::NORMAL))
+  {
+    Logger::logPrintf("Could not initialize transformation system.", Logger::ERROR);
+    return false;
   }
+  vector<TSPtr> nc2010_transformation_systems;
+  nc2010_transformation_systems.push_back(nc2010_transformation_system);
 
   NC2010CSParamPtr nc2010_canonical_system_parameters(new NC2010CanonicalSystemParameters());
   NC2010CSStatePtr nc2010_canonical_system_state(new NC2010CanonicalSystemState());
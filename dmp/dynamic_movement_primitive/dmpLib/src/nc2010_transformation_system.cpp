@@ -53,6 +53,7 @@ NC2010TransformationSystem& NC2010TransformationSystem::operator=(const NC2010Tr
     TransformationSystem::states_.push_back(states_[i]);
   }
   integration_method_ = nc2010ts.integration_method_;
+  initializeBuffers();
   initialized_ = nc2010ts.initialized_;
   return *this;
 }
@@ -89,7 +90,21 @@ bool NC2010TransformationSystem::initialize(const vector<NC2010TSParamPtr> param
   {
     ts_states.push_back(states_[i]);
   }
-  return TransformationSystem::initialize(ts_params, ts_states, integration_method);
+  if (!TransformationSystem::initialize(ts_params, ts_states, integration_method))
+  {
+    return false;
+  }
+  return true;
+}
+
+// REAL-TIME REQUIREMENTS
+void NC2010TransformationSystem::gatherGains()
+{
+  for (int i = 0; i < (int)parameters_.size(); ++i)
+  {
+    k_gains_(i) = parameters_[i]->k_gain_;
+    d_gains_(i) = parameters_[i]->d_gain_;
+  }
 }
 
 bool NC2010TransformationSystem::get(NC2010TSParamConstPtr& parameters,
@@ -293,41 +308,49 @@ bool NC2010TransformationSystem::integrate(const CSStatePtr canonical_system_sta
   {
     case NORMAL:
     {
-      double dt = dmp_time.getDeltaT() / static_cast<double> (num_iterations);
-      for (int i = 0; i < getNumDimensions(); ++i)
+      // compute nonlinearity of all dimensions using LWR
+      if (!predict(canonical_system_state->getStateX()))
       {
-        for (int n = 0; n < num_iterations; ++n)
-        {
-          // compute nonlinearity using LWR
-          double prediction = 0;
-          if (!parameters_[i]->lwr_model_->predict(canonical_system_state->getStateX(), prediction))
-          {
-            Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
-            return false;
-          }
-
-          states_[i]->f_ = prediction * canonical_system_state->getStateX();
+        Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
+        return false;
+      }
 
-          // compute transformation system
-          states_[i]->internal_.setXdd( (parameters_[i]->k_gain_ * (states_[i]->goal_ - states_[i]->current_.getX())
-              - parameters_[i]->d_gain_ * states_[i]->internal_.getXd()
-              - parameters_[i]->k_gain_ * (states_[i]->goal_ - states_[i]->start_) * canonical_system_state->getStateX()
-              + parameters_[i]->k_gain_ * states_[i]->f_ ) / dmp_time.getTau() );
+      // operate on contiguous copies of the states of all dimensions
+      gatherStates();
 
-          states_[i]->current_.setXd( states_[i]->internal_.getXd() / dmp_time.getTau() );
-          states_[i]->current_.setXdd( states_[i]->internal_.getXdd() / dmp_time.getTau() );
+      const double x = canonical_system_state->getStateX();
+      const double tau = dmp_time.getTau();
+      const double dt = dmp_time.getDeltaT() / static_cast<double> (num_iterations);
+      f_.array() = predictions_.array() * x;
+      for (int n = 0; n < num_iterations; ++n)
+      {
+        // compute transformation system
+        internal_xdd_.array() = (k_gains_.array() * (goals_.array() - current_x_.array())
+            - d_gains_.array() * internal_xd_.array()
+            - k_gains_.array() * (goals_.array() - starts_.array()) * x
+            + k_gains_.array() * f_.array()) / tau;
 
-          // integrate the system twice
-          states_[i]->internal_.addXd(states_[i]->internal_.getXdd() * dt);
-          states_[i]->current_.addX(states_[i]->current_.getXd() * dt);
+        current_xd_.array() = internal_xd_.array() / tau;
+        current_xdd_.array() = internal_xdd_.array() / tau;
 
-        }
+        // integrate the system twice
+        internal_xd_.array() += internal_xdd_.array() * dt;
+        current_x_.array() += current_xd_.array() * dt;
       }
+
+      scatterStates();
       break;
     }
     case QUATERNION:
     {
 
+      // compute nonlinearity using LWR
+      if (!predict(canonical_system_state->getStateX()))
+      {
+        Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
+        return false;
+      }
+
       double dt = dmp_time.getDeltaT() / static_cast<double> (num_iterations);
       for (int n = 0; n < num_iterations; ++n)
       {
@@ -344,14 +367,7 @@ bool NC2010TransformationSystem::integrate(const CSStatePtr canonical_system_sta
         Vector3d f;
         for (int i = 1; i < 4; ++i)
         {
-          // compute nonlinearity using LWR
-          double prediction = 0;
-          if (!parameters_[i]->lwr_model_->predict(canonical_system_state->getStateX(), prediction))
-          {
-            Logger::logPrintf("Could not predict output (Real-time violation).", Logger::ERROR);
-            return false;
-          }
-          f(i-1) = prediction * canonical_system_state->getStateX();
+          f(i-1) = predictions_(i) * canonical_system_state->getStateX();
         }
 
         // Put k- and d-gain values in matrices, because all output dimensions will be computed at
@@ -15,11 +15,14 @@
 // system includes
 #include <math.h>
 #include <sstream>
+#include <algorithm>
 #include <errno.h>
+#include <string.h>
 #include <assert.h>
 
 // local include
 #include <dmp_lib/trajectory.h>
+#include <dmp_lib/mapped_trajectory.h>
 #include <dmp_lib/logger.h>
 
 // 32 bit word byte/word swap macros
@@ -55,9 +58,9 @@ bool Trajectory::initialize(const std::vector<std::string>& variable_names,
                     Logger::DEBUG, (int)variable_names.size(), sampling_frequency, trajectory_length);
   Logger::logPrintf(!positions_only, "Initializing position, velocity and acceleration trajectory with >%i< dimensions, with a sampling frequency of >%.1f< Hz and maximal length of >%i< samples.",
                     Logger::DEBUG, (int)variable_names.size(), sampling_frequency, trajectory_length);
-  if (trajectory_length <= 0 || trajectory_length > ABSOLUTE_MAX_TRAJECTORY_LENGTH)
+  if (trajectory_length < 0 || trajectory_length > ABSOLUTE_MAX_TRAJECTORY_LENGTH)
   {
-    Logger::logPrintf("Trajectory length >%i< is out of bounds (0..%i]. Cannot initialize trajectory.", Logger::ERROR, trajectory_length, ABSOLUTE_MAX_TRAJECTORY_LENGTH);
+    Logger::logPrintf("Trajectory length >%i< is out of bounds [0..%i]. Cannot initialize trajectory.", Logger::ERROR, trajectory_length, ABSOLUTE_MAX_TRAJECTORY_LENGTH);
     return (initialized_ = false);
   }
   if (variable_names.empty())
@@ -80,6 +83,7 @@ bool Trajectory::initialize(const std::vector<std::string>& variable_names,
   trajectory_dimension_ = trajectory_dimension;
   variable_names_ = variable_names;
   trajectory_length_ = trajectory_length;
+  fixed_capacity_ = (trajectory_length != DYNAMIC_TRAJECTORY_LENGTH);
   positions_only_ = positions_only;
   index_to_last_trajectory_point_ = 0;
   trajectory_duration_ = 0.0;
@@ -222,6 +226,10 @@ bool Trajectory::setMinJerk(const Eigen::VectorXd& start, const Eigen::VectorXd&
                         Logger::ERROR, trajectory_dimension_, start.size(), goal.size());
       return false;
   }
+  if (!fixed_capacity_ && !reserve(index_to_last_trajectory_point_ + num_samples))
+  {
+    return false;
+  }
   if(trajectory_length_ < num_samples)
   {
     Logger::logPrintf("Cannot set minimum jerk trajectory with >%i< samples because trajectory is only of length >%i<.",
@@ -546,8 +554,10 @@ bool Trajectory::readFromCLMCFile(const string& file_name,
   {
     for (int j = 0; j < tmp_num_cols; j++)
     {
-      aux = LONGSWAP(*((int *)&(trajectory_data[i][j])));
-      trajectory_data[i][j] = *((float *)&aux);
+      // copy the bytes instead of casting the pointer, which breaks strict aliasing
+      memcpy(&aux, &(trajectory_data[i][j]), sizeof(aux));
+      aux = LONGSWAP(aux);
+      memcpy(&(trajectory_data[i][j]), &aux, sizeof(aux));
     }
   }
 
@@ -762,8 +772,9 @@ bool Trajectory::writeToCLMCFile(const std::string& file_name,
   {
     for (int j = 0; j < num_dimensions; ++j)
     {
-      aux = LONGSWAP(*((int *) &((*buffer)[i][j])));
-      (*buffer)[i][j] = *((float *)&aux);
+      memcpy(&aux, &((*buffer)[i][j]), sizeof(aux));
+      aux = LONGSWAP(aux);
+      memcpy(&((*buffer)[i][j]), &aux, sizeof(aux));
     }
   }
 
@@ -781,6 +792,131 @@ bool Trajectory::writeToCLMCFile(const std::string& file_name,
   return true;
 }
 
+bool Trajectory::readFromBinaryFile(const string& file_name,
+                                    const bool positions_only)
+{
+  MappedTrajectory mapped_trajectory;
+  if (!mapped_trajectory.initialize(file_name))
+  {
+    Logger::logPrintf("Could not map binary trajectory file >%s<.", Logger::ERROR, file_name.c_str());
+    return false;
+  }
+  if (!positions_only && mapped_trajectory.containsPositionsOnly())
+  {
+    Logger::logPrintf("Binary trajectory file >%s< only contains positions. Maybe use position only option.", Logger::ERROR, file_name.c_str());
+    return false;
+  }
+
+  // initialize trajectory and allocate memory to hold the trajectory
+  if (!initialize(mapped_trajectory.getVariableNames(), mapped_trajectory.getSamplingFrequency(), positions_only, mapped_trajectory.getNumSamples()))
+  {
+    Logger::logPrintf("Could not initialize trajectory. Reading from file failed.", Logger::ERROR);
+    return false;
+  }
+  variable_units_ = mapped_trajectory.getVariableUnits();
+  trajectory_positions_ = mapped_trajectory.getPositions();
+  if (!positions_only)
+  {
+    trajectory_velocities_ = mapped_trajectory.getVelocities();
+    trajectory_accelerations_ = mapped_trajectory.getAccelerations();
+  }
+  index_to_last_trajectory_point_ = trajectory_length_;
+  trajectory_duration_ = static_cast<double> (trajectory_length_) / sampling_frequency_;
+
+  Logger::logPrintf("Read trajectory containing >%i< variables with each >%i< data points from binary file >%s<.", Logger::INFO,
+                    trajectory_dimension_, trajectory_length_, file_name.c_str());
+  return true;
+}
+
+bool Trajectory::writeToBinaryFile(const string& file_name,
+                                   const bool positions_only) const
+{
+  if (!positions_only && positions_only_)
+  {
+    Logger::logPrintf("Only positions are contained in trajectory, cannot write more into >%s<.", Logger::ERROR, file_name.c_str());
+    return false;
+  }
+  if (index_to_last_trajectory_point_ <= 0)
+  {
+    Logger::logPrintf("Trajectory does not contain any samples, cannot write binary file >%s<.", Logger::ERROR, file_name.c_str());
+    return false;
+  }
+  if (sampling_frequency_ <= 0.0)
+  {
+    Logger::logPrintf("Sampling frequency >%.1f< is invalid.", Logger::ERROR, sampling_frequency_);
+    return false;
+  }
+
+  // variable names and units are stored as pairs of null terminated strings followed by padding up to the data
+  string names;
+  for (int i = 0; i < trajectory_dimension_; ++i)
+  {
+    names.append(variable_names_[i]);
+    names.push_back('\0');
+    if (variable_units_.size() == variable_names_.size())
+    {
+      names.append(variable_units_[i]);
+    }
+    else
+    {
+      names.append("-");
+    }
+    names.push_back('\0');
+  }
+  const size_t names_end = sizeof(BinaryTrajectoryHeader) + names.size();
+  const size_t data_offset = ((names_end + BINARY_TRAJECTORY_ALIGNMENT - 1) / BINARY_TRAJECTORY_ALIGNMENT) * BINARY_TRAJECTORY_ALIGNMENT;
+  names.resize(data_offset - sizeof(BinaryTrajectoryHeader), '\0');
+
+  BinaryTrajectoryHeader header;
+  memset(&header, 0, sizeof(BinaryTrajectoryHeader));
+  memcpy(header.magic, BINARY_TRAJECTORY_MAGIC, sizeof(BINARY_TRAJECTORY_MAGIC));
+  header.version = BINARY_TRAJECTORY_VERSION;
+  header.byte_order = BINARY_TRAJECTORY_BYTE_ORDER;
+  header.num_samples = static_cast<uint32_t> (index_to_last_trajectory_point_);
+  header.num_dimensions = static_cast<uint32_t> (trajectory_dimension_);
+  header.positions_only = positions_only ? 1 : 0;
+  header.data_offset = static_cast<uint32_t> (data_offset);
+  header.sampling_frequency = sampling_frequency_;
+
+  FILE *fp;
+  if ((fp = fopen(file_name.c_str(), "wb")) == NULL)
+  {
+    Logger::logPrintf("Cannot fopen file >%s< : %s.", Logger::ERROR, file_name.c_str(), strerror(errno));
+    return false;
+  }
+  if (fwrite(&header, sizeof(BinaryTrajectoryHeader), 1, fp) != 1
+      || fwrite(names.data(), 1, names.size(), fp) != names.size())
+  {
+    Logger::logPrintf("Cannot fwrite header of binary trajectory file >%s<.", Logger::ERROR, file_name.c_str());
+    fclose(fp);
+    return false;
+  }
+
+  // each column holds the contained samples contiguously, the remaining capacity is skipped
+  const MatrixXd* blocks[POS_VEL_ACC] = {&trajectory_positions_, &trajectory_velocities_, &trajectory_accelerations_};
+  const int num_blocks = positions_only ? 1 : POS_VEL_ACC;
+  for (int b = 0; b < num_blocks; ++b)
+  {
+    for (int j = 0; j < trajectory_dimension_; ++j)
+    {
+      if (fwrite(blocks[b]->col(j).data(), sizeof(double), index_to_last_trajectory_point_, fp) != (unsigned)index_to_last_trajectory_point_)
+      {
+        Logger::logPrintf("Cannot fwrite trajectory data into >%s<.", Logger::ERROR, file_name.c_str());
+        fclose(fp);
+        return false;
+      }
+    }
+  }
+  if (fclose(fp) != 0)
+  {
+    Logger::logPrintf("Cannot fclose file >%s< : %s.", Logger::ERROR, file_name.c_str(), strerror(errno));
+    return false;
+  }
+  Logger::logPrintf("Wrote trajectory with >%i< traces and >%i< samples to binary file >%s<.", Logger::INFO,
+                    trajectory_dimension_ * num_blocks, index_to_last_trajectory_point_, file_name.c_str());
+  return true;
+}
+
 bool Trajectory::rearange(const vector<string>& variable_names_order)
 {
 
@@ -1020,11 +1156,19 @@ bool Trajectory::blowUp(Trajectory& trajectory, const int num_extra_points)
 
 bool Trajectory::computeDerivatives(const int num_extra_points)
 {
+  if (index_to_last_trajectory_point_ == 0)
+  {
+    Logger::logPrintf("Trajectory does not contain any samples. Cannot compute derivatives.", Logger::ERROR);
+    return false;
+  }
+
+  // only the contained samples are derived, the unused capacity is released
+  const int num_samples = index_to_last_trajectory_point_;
   const int add_pos_points = 4;
-  const int pos_length = add_pos_points + num_extra_points + trajectory_length_ + num_extra_points + add_pos_points;
+  const int pos_length = add_pos_points + num_extra_points + num_samples + num_extra_points + add_pos_points;
   const int vel_length = - 2 + pos_length - 2;
   const int acc_length = - 2 + vel_length - 2;
-  const int new_trajectory_length = num_extra_points + trajectory_length_ + num_extra_points;
+  const int new_trajectory_length = num_extra_points + num_samples + num_extra_points;
 
   // add points at the beginning and ending
   MatrixXd tmp_trajectory_pos = MatrixXd::Zero(pos_length, trajectory_dimension_);
@@ -1036,7 +1180,7 @@ bool Trajectory::computeDerivatives(const int num_extra_points)
       {
         tmp_trajectory_pos(i, j) = trajectory_positions_(0, j);
       }
-      else if (i < add_pos_points + num_extra_points + trajectory_length_)
+      else if (i < add_pos_points + num_extra_points + num_samples)
       {
         tmp_trajectory_pos(i, j) = trajectory_positions_(i - add_pos_points - num_extra_points, j);
       }
@@ -1164,7 +1308,7 @@ bool Trajectory::crop(const int num_trajectory_points, bool crop_the_end)
   index_to_last_trajectory_point_ = new_index_to_last_trajectory_point;
 
   // compute new duration
-  trajectory_duration_ = static_cast<double> (trajectory_length_) / sampling_frequency_;
+  trajectory_duration_ = static_cast<double> (index_to_last_trajectory_point_) / sampling_frequency_;
   return true;
 }
 
@@ -1254,7 +1398,12 @@ bool Trajectory::add(const VectorXd& trajectory_positons,
                       Logger::ERROR, sampling_frequency_);
     return false;
   }
-  if (!canHold(index_to_last_trajectory_point_, trajectory_positons.size(), false))
+  if (index_to_last_trajectory_point_ == trajectory_length_ && !fixed_capacity_
+      && !reserve(std::min(std::max(2 * trajectory_length_, MIN_TRAJECTORY_GROWTH), ABSOLUTE_MAX_TRAJECTORY_LENGTH)))
+  {
+    return false;
+  }
+  if (!canHold(index_to_last_trajectory_point_ + 1, trajectory_positons.size(), false))
   {
     return false;
   }
@@ -1289,7 +1438,12 @@ bool Trajectory::add(const VectorXd& trajectory_positons,
                       Logger::ERROR, sampling_frequency_);
     return false;
   }
-  if (!canHold(index_to_last_trajectory_point_, trajectory_positons.size(), positions_only))
+  if (index_to_last_trajectory_point_ == trajectory_length_ && !fixed_capacity_
+      && !reserve(std::min(std::max(2 * trajectory_length_, MIN_TRAJECTORY_GROWTH), ABSOLUTE_MAX_TRAJECTORY_LENGTH)))
+  {
+    return false;
+  }
+  if (!canHold(index_to_last_trajectory_point_ + 1, trajectory_positons.size(), positions_only))
   {
     return false;
   }
@@ -1556,44 +1710,26 @@ bool Trajectory::append(const Trajectory& other_trajectory)
   }
 
   // allocate more memory if this trajectory is not large enough
-  if (index_to_last_trajectory_point_ + trajectory.index_to_last_trajectory_point_ > trajectory_length_)
-  {
-    // set new trajectory length
-    trajectory_length_ = index_to_last_trajectory_point_ + trajectory.index_to_last_trajectory_point_;
-    MatrixXd new_trajectory_positions = MatrixXd::Zero(trajectory_length_, trajectory_dimension_);
-    new_trajectory_positions.block(0,0,index_to_last_trajectory_point_,trajectory_dimension_)
-          = trajectory_positions_.block(0,0,index_to_last_trajectory_point_,trajectory_dimension_);
-    new_trajectory_positions.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
-        = trajectory.trajectory_positions_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
-    trajectory_positions_ = new_trajectory_positions;
-    if(!positions_only_)
-    {
-      MatrixXd new_trajectory_velocities = MatrixXd::Zero(trajectory_length_, trajectory_dimension_);
-      new_trajectory_velocities.block(0,0,index_to_last_trajectory_point_,trajectory_dimension_)
-            = trajectory_velocities_.block(0,0,index_to_last_trajectory_point_,trajectory_dimension_);
-      new_trajectory_velocities.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
-          = trajectory.trajectory_velocities_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
-      trajectory_velocities_ = new_trajectory_velocities;
-
-      MatrixXd new_trajectory_accelerations = MatrixXd::Zero(trajectory_length_, trajectory_dimension_);
-      new_trajectory_accelerations.block(0,0,index_to_last_trajectory_point_,trajectory_dimension_)
-            = trajectory_accelerations_.block(0,0,index_to_last_trajectory_point_,trajectory_dimension_);
-      new_trajectory_accelerations.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
-          = trajectory.trajectory_accelerations_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
-      trajectory_accelerations_ = new_trajectory_accelerations;
-    }
+  const int num_samples = index_to_last_trajectory_point_ + trajectory.index_to_last_trajectory_point_;
+  if (fixed_capacity_ && num_samples > trajectory_length_)
+  {
+    Logger::logPrintf("Cannot append >%i< samples to trajectory with fixed capacity of >%i< samples that already contains >%i< samples.",
+                      Logger::ERROR, trajectory.index_to_last_trajectory_point_, trajectory_length_, index_to_last_trajectory_point_);
+    return false;
   }
-  else
+  if (!reserve(num_samples))
   {
-    trajectory_positions_.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
-        = trajectory.trajectory_positions_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
-    if(!positions_only_)
-    {
-      trajectory_velocities_.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
-            = trajectory.trajectory_velocities_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
-      trajectory_accelerations_.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
-            = trajectory.trajectory_accelerations_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
-    }
+    Logger::logPrintf("Could not append trajectory.", Logger::ERROR);
+    return false;
+  }
+  trajectory_positions_.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
+      = trajectory.trajectory_positions_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
+  if(!positions_only_)
+  {
+    trajectory_velocities_.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
+          = trajectory.trajectory_velocities_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
+    trajectory_accelerations_.block(index_to_last_trajectory_point_,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_)
+          = trajectory.trajectory_accelerations_.block(0,0,trajectory.index_to_last_trajectory_point_,trajectory_dimension_);
   }
 
   // update index and trajectory duration
@@ -1602,6 +1738,43 @@ bool Trajectory::append(const Trajectory& other_trajectory)
   return true;
 }
 
+bool Trajectory::reserve(const int num_samples)
+{
+  assert(initialized_);
+  if (num_samples <= trajectory_length_)
+  {
+    return true;
+  }
+  if (num_samples > ABSOLUTE_MAX_TRAJECTORY_LENGTH)
+  {
+    Logger::logPrintf("Cannot reserve >%i< samples, maximum trajectory length is >%i<.", Logger::ERROR, num_samples, ABSOLUTE_MAX_TRAJECTORY_LENGTH);
+    return false;
+  }
+  resize(num_samples);
+  return true;
+}
+
+void Trajectory::shrinkToFit()
+{
+  assert(initialized_);
+  resize(index_to_last_trajectory_point_);
+}
+
+void Trajectory::resize(const int trajectory_length)
+{
+  const int num_samples = std::min(trajectory_length_, trajectory_length);
+  trajectory_positions_.conservativeResize(trajectory_length, trajectory_dimension_);
+  trajectory_positions_.bottomRows(trajectory_length - num_samples).setZero();
+  if (!positions_only_)
+  {
+    trajectory_velocities_.conservativeResize(trajectory_length, trajectory_dimension_);
+    trajectory_velocities_.bottomRows(trajectory_length - num_samples).setZero();
+    trajectory_accelerations_.conservativeResize(trajectory_length, trajectory_dimension_);
+    trajectory_accelerations_.bottomRows(trajectory_length - num_samples).setZero();
+  }
+  trajectory_length_ = trajectory_length;
+}
+
 void Trajectory::clear()
 {
   assert(initialized_);
@@ -14,6 +14,7 @@
 
 // system includes
 #include <stdio.h>
+#include <math.h>
 
 // local includes
 #include <dmp_lib/transformation_system.h>
@@ -26,6 +27,37 @@ namespace dmp_lib
 
 static const std::string invalid_name = "null";
 
+/*! Basis functions below this fraction of the largest activation are ignored by integrateFull
+ */
+static const double MIN_RELATIVE_BASIS_FUNCTION_ACTIVATION = 1e-10;
+
+/*! Computes the matrix exponential using scaling and squaring of a truncated taylor series
+ * @param matrix
+ * @param exponential
+ */
+static void computeMatrixExponential(const Eigen::Matrix4d& matrix, Eigen::Matrix4d& exponential)
+{
+  int num_squarings = 0;
+  double norm = matrix.cwiseAbs().rowwise().sum().maxCoeff();
+  while (norm > 0.5)
+  {
+    norm *= 0.5;
+    num_squarings++;
+  }
+  const Eigen::Matrix4d scaled_matrix = matrix / pow(2.0, num_squarings);
+  Eigen::Matrix4d term = Eigen::Matrix4d::Identity();
+  exponential = Eigen::Matrix4d::Identity();
+  for (int i = 1; i <= 12; ++i)
+  {
+    term = (term * scaled_matrix) / static_cast<double> (i);
+    exponential += term;
+  }
+  for (int i = 0; i < num_squarings; ++i)
+  {
+    exponential = exponential * exponential;
+  }
+}
+
 bool TransformationSystem::initialize(const std::vector<TSParamPtr> parameters,
                                       const std::vector<TSStatePtr> states,
                                       const IntegrationMethod integration_method)
@@ -54,9 +86,290 @@ bool TransformationSystem::initialize(const std::vector<TSParamPtr> parameters,
   parameters_ = parameters;
   states_ = states;
   integration_method_ = integration_method;
+  initializeBuffers();
   return (initialized_ = true);
 }
 
+void TransformationSystem::initializeBuffers()
+{
+  const int num_dimensions = static_cast<int> (parameters_.size());
+  predictions_ = Eigen::VectorXd::Zero(num_dimensions);
+  k_gains_ = Eigen::VectorXd::Zero(num_dimensions);
+  d_gains_ = Eigen::VectorXd::Zero(num_dimensions);
+  goals_ = Eigen::VectorXd::Zero(num_dimensions);
+  starts_ = Eigen::VectorXd::Zero(num_dimensions);
+  internal_x_ = Eigen::VectorXd::Zero(num_dimensions);
+  internal_xd_ = Eigen::VectorXd::Zero(num_dimensions);
+  internal_xdd_ = Eigen::VectorXd::Zero(num_dimensions);
+  current_x_ = Eigen::VectorXd::Zero(num_dimensions);
+  current_xd_ = Eigen::VectorXd::Zero(num_dimensions);
+  current_xdd_ = Eigen::VectorXd::Zero(num_dimensions);
+  f_ = Eigen::VectorXd::Zero(num_dimensions);
+  initializeReceptiveFields();
+}
+
+void TransformationSystem::initializeReceptiveFields()
+{
+  receptive_field_revisions_.resize(parameters_.size());
+  for (int i = 0; i < (int)parameters_.size(); ++i)
+  {
+    receptive_field_revisions_[i] = parameters_[i]->lwr_model_.get() ? parameters_[i]->lwr_model_->getReceptiveFieldRevision() : 0;
+  }
+  cached_phases_.resize(0);
+  cached_basis_function_matrix_.resize(0, 0);
+  cached_basis_function_ranges_.clear();
+  shared_receptive_fields_ = !parameters_.empty();
+  for (int i = 1; shared_receptive_fields_ && i < (int)parameters_.size(); ++i)
+  {
+    shared_receptive_fields_ = parameters_[0]->lwr_model_->hasSameReceptiveFields(*parameters_[i]->lwr_model_);
+  }
+  if (shared_receptive_fields_)
+  {
+    basis_functions_ = Eigen::VectorXd::Zero(parameters_[0]->lwr_model_->getNumRFS());
+  }
+  else
+  {
+    basis_functions_.resize(0);
+  }
+}
+
+// REAL-TIME REQUIREMENTS
+void TransformationSystem::gatherStates()
+{
+  assert(goals_.size() == (int)states_.size());
+  gatherGains();
+  for (int i = 0; i < (int)states_.size(); ++i)
+  {
+    goals_(i) = states_[i]->goal_;
+    starts_(i) = states_[i]->start_;
+    states_[i]->internal_.get(internal_x_(i), internal_xd_(i), internal_xdd_(i));
+    states_[i]->current_.get(current_x_(i), current_xd_(i), current_xdd_(i));
+  }
+}
+
+// REAL-TIME REQUIREMENTS
+void TransformationSystem::scatterStates()
+{
+  assert(goals_.size() == (int)states_.size());
+  for (int i = 0; i < (int)states_.size(); ++i)
+  {
+    states_[i]->internal_.set(internal_x_(i), internal_xd_(i), internal_xdd_(i));
+    states_[i]->current_.set(current_x_(i), current_xd_(i), current_xdd_(i));
+    states_[i]->f_ = f_(i);
+  }
+}
+
+// REAL-TIME REQUIREMENTS
+bool TransformationSystem::haveReceptiveFieldsChanged() const
+{
+  for (int i = 0; i < (int)parameters_.size(); ++i)
+  {
+    const unsigned long revision = parameters_[i]->lwr_model_.get() ? parameters_[i]->lwr_model_->getReceptiveFieldRevision() : 0;
+    if (revision != receptive_field_revisions_[i])
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// REAL-TIME REQUIREMENTS
+bool TransformationSystem::predict(const double x_query)
+{
+  assert(predictions_.size() == (int)parameters_.size());
+  if (haveReceptiveFieldsChanged())
+  {
+    initializeReceptiveFields();
+  }
+  if (shared_receptive_fields_)
+  {
+    if (!parameters_[0]->lwr_model_->generateBasisFunctionVector(x_query, basis_functions_))
+    {
+      return false;
+    }
+    for (int i = 0; i < (int)parameters_.size(); ++i)
+    {
+      if (!parameters_[i]->lwr_model_->predict(x_query, basis_functions_, predictions_(i)))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+  for (int i = 0; i < (int)parameters_.size(); ++i)
+  {
+    if (!parameters_[i]->lwr_model_->predict(x_query, predictions_(i)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TransformationSystem::integrateFull(const Eigen::VectorXd& phases,
+                                         const Time& dmp_time,
+                                         Eigen::MatrixXd& positions,
+                                         Eigen::MatrixXd& velocities,
+                                         Eigen::MatrixXd& accelerations)
+{
+  assert(initialized_);
+  if (integration_method_ != NORMAL)
+  {
+    Logger::logPrintf("Only NORMAL transformation systems can be integrated at once.", Logger::ERROR);
+    return false;
+  }
+  if (phases.size() < 2)
+  {
+    Logger::logPrintf("Number of phases >%i< is invalid, at least 2 are required.", Logger::ERROR, phases.size());
+    return false;
+  }
+  const int num_samples = phases.size() - 1;
+  const int num_dimensions = getNumDimensions();
+  const double tau = dmp_time.getTau();
+  const double dt = dmp_time.getDeltaT();
+
+  // compute nonlinearity of all dimensions for all phases (num_dimensions x num_samples+1)
+  Eigen::MatrixXd f = Eigen::MatrixXd::Zero(num_dimensions, num_samples + 1);
+  if (haveReceptiveFieldsChanged())
+  {
+    initializeReceptiveFields();
+  }
+  if (shared_receptive_fields_)
+  {
+    // the normalized basis functions only depend on the phases, which are the same for all rollouts of equal
+    // duration and number of samples. Therefore, they are cached and only the weights change between rollouts.
+    const int num_rfs = basis_functions_.size();
+    if (cached_phases_.size() != phases.size() || cached_phases_ != phases)
+    {
+      cached_phases_.resize(0);
+      cached_basis_function_matrix_ = Eigen::MatrixXd::Zero(num_rfs, num_samples + 1);
+      cached_basis_function_ranges_.resize(num_samples + 1);
+      for (int n = 0; n <= num_samples; ++n)
+      {
+        if (!parameters_[0]->lwr_model_->generateBasisFunctionVector(phases(n), basis_functions_))
+        {
+          return false;
+        }
+        double sum = basis_functions_.sum();
+        if (sum < 0.000000001 && sum > -0.000000001)
+        {
+          Logger::logPrintf("Could not predict output.", Logger::ERROR);
+          return false;
+        }
+        // same as LWR::predict followed by the multiplication with the phase done in integrate
+        cached_basis_function_matrix_.col(n) = basis_functions_ * ((phases(n) * phases(n)) / sum);
+
+        // only a few receptive fields are active for each phase, remember the range of those that contribute
+        const double threshold = MIN_RELATIVE_BASIS_FUNCTION_ACTIVATION * basis_functions_.maxCoeff();
+        int first = 0;
+        while (first < num_rfs - 1 && basis_functions_(first) < threshold)
+        {
+          first++;
+        }
+        int last = num_rfs - 1;
+        while (last > first && basis_functions_(last) < threshold)
+        {
+          last--;
+        }
+        cached_basis_function_ranges_[n] = std::make_pair(first, last - first + 1);
+      }
+      cached_phases_ = phases;
+    }
+    Eigen::MatrixXd slopes = Eigen::MatrixXd::Zero(num_dimensions, num_rfs);
+    Eigen::VectorXd thetas = Eigen::VectorXd::Zero(num_rfs);
+    for (int i = 0; i < num_dimensions; ++i)
+    {
+      if (!parameters_[i]->lwr_model_->getThetas(thetas))
+      {
+        return false;
+      }
+      slopes.row(i) = thetas.transpose();
+    }
+    for (int n = 0; n <= num_samples; ++n)
+    {
+      const int first = cached_basis_function_ranges_[n].first;
+      const int length = cached_basis_function_ranges_[n].second;
+      f.col(n).noalias() = slopes.middleCols(first, length) * cached_basis_function_matrix_.col(n).segment(first, length);
+    }
+  }
+  else
+  {
+    for (int n = 0; n <= num_samples; ++n)
+    {
+      if (!predict(phases(n)))
+      {
+        Logger::logPrintf("Could not predict output.", Logger::ERROR);
+        return false;
+      }
+      f.col(n) = predictions_ * phases(n);
+    }
+  }
+
+  gatherStates();
+
+  // the forcing term u = k (g - (g - s) x + f) of all dimensions for all phases
+  Eigen::MatrixXd u = f;
+  for (int n = 0; n <= num_samples; ++n)
+  {
+    u.col(n) = (k_gains_.array() * (goals_.array() - (goals_.array() - starts_.array()) * phases(n) + f.col(n).array())).matrix();
+  }
+
+  // discretize tau * [yd; zd] = [0 1; -k -d] [y; z] + [0; u] for each dimension. The exponential of the augmented
+  // matrix contains the state transition as well as the input matrices for a piecewise linear input.
+  Eigen::ArrayXd phi_yy(num_dimensions), phi_yz(num_dimensions), phi_zy(num_dimensions), phi_zz(num_dimensions);
+  Eigen::ArrayXd gamma_y(num_dimensions), gamma_z(num_dimensions), delta_gamma_y(num_dimensions), delta_gamma_z(num_dimensions);
+  for (int i = 0; i < num_dimensions; ++i)
+  {
+    Eigen::Matrix4d augmented_matrix = Eigen::Matrix4d::Zero();
+    augmented_matrix(0, 1) = dt / tau;
+    augmented_matrix(1, 0) = -k_gains_(i) * dt / tau;
+    augmented_matrix(1, 1) = -d_gains_(i) * dt / tau;
+    augmented_matrix(1, 2) = dt / tau;
+    augmented_matrix(2, 3) = 1.0;
+    Eigen::Matrix4d exponential;
+    computeMatrixExponential(augmented_matrix, exponential);
+    phi_yy(i) = exponential(0, 0);
+    phi_yz(i) = exponential(0, 1);
+    phi_zy(i) = exponential(1, 0);
+    phi_zz(i) = exponential(1, 1);
+    gamma_y(i) = exponential(0, 2);
+    gamma_z(i) = exponential(1, 2);
+    delta_gamma_y(i) = exponential(0, 3);
+    delta_gamma_z(i) = exponential(1, 3);
+  }
+
+  const double acceleration_scale = getAccelerationScale(tau);
+  Eigen::MatrixXd positions_transposed(num_dimensions, num_samples);
+  Eigen::MatrixXd velocities_transposed(num_dimensions, num_samples);
+  Eigen::MatrixXd accelerations_transposed(num_dimensions, num_samples);
+  Eigen::ArrayXd y = current_x_.array();
+  Eigen::ArrayXd z = internal_xd_.array();
+  Eigen::ArrayXd y_next(num_dimensions);
+  for (int n = 0; n < num_samples; ++n)
+  {
+    internal_xdd_.array() = (u.col(n).array() - k_gains_.array() * y - d_gains_.array() * z) / tau;
+    velocities_transposed.col(n) = (z / tau).matrix();
+    accelerations_transposed.col(n) = internal_xdd_ * acceleration_scale;
+
+    y_next = phi_yy * y + phi_yz * z + gamma_y * u.col(n).array() + delta_gamma_y * (u.col(n + 1).array() - u.col(n).array());
+    z = phi_zy * y + phi_zz * z + gamma_z * u.col(n).array() + delta_gamma_z * (u.col(n + 1).array() - u.col(n).array());
+    y = y_next;
+    positions_transposed.col(n) = y.matrix();
+  }
+  positions = positions_transposed.transpose();
+  velocities = velocities_transposed.transpose();
+  accelerations = accelerations_transposed.transpose();
+
+  // leave the states as integrate would have after the last step
+  current_x_ = y.matrix();
+  current_xd_ = velocities_transposed.col(num_samples - 1);
+  current_xdd_ = accelerations_transposed.col(num_samples - 1);
+  internal_xd_ = z.matrix();
+  f_ = f.col(num_samples - 1);
+  scatterStates();
+  return true;
+}
+
 bool TransformationSystem::get(std::vector<TSParamConstPtr>& parameters,
                                std::vector<TSStateConstPtr>& states,
                                IntegrationMethod& integration_method) const
@@ -0,0 +1,230 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Measures the per step cost of DynamicMovementPrimitive::propagateStep
+            and the per rollout cost of propagateFull and propagateFullOffline
+            for different numbers of dimensions as well as the throughput of
+            the BatchPropagator for different numbers of threads.
+
+ \file		benchmark_dynamic_movement_primitive.cpp
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <stdio.h>
+#include <time.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+// local includes
+#include <dmp_lib/logger.h>
+#include <dmp_lib/nc2010_dynamic_movement_primitive.h>
+#include <dmp_lib/trajectory.h>
+#include <dmp_lib/batch_propagator.h>
+
+using namespace Eigen;
+
+static double getTime()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<double> (t.tv_sec) + static_cast<double> (t.tv_nsec) * 1e-9;
+}
+
+static const int num_rfs = 100;
+static const double k_gain = 250.0;
+static const double sampling_frequency = 1000.0;
+static const double duration = 1.0;
+
+static bool initialize(dmp_lib::NC2010DMP& dmp, const int num_dimensions, VectorXd& start, VectorXd& goal)
+{
+  std::vector<std::string> variable_names;
+  for (int i = 0; i < num_dimensions; ++i)
+  {
+    std::stringstream ss;
+    ss << "variable_" << i;
+    variable_names.push_back(ss.str());
+  }
+
+  lwr_lib::LWRParamPtr lwr_parameters(new lwr_lib::LWRParameters());
+  if (!lwr_parameters->initialize(num_rfs, 0.7, true, 0.001))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize LWR parameters.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  if (!dmp.initialize(variable_names, lwr_parameters, k_gain, dmp_lib::NC2010TS::getDGain(k_gain)))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  start = VectorXd::Zero(num_dimensions);
+  goal = VectorXd::LinSpaced(num_dimensions, 0.1, 1.0);
+  if (!dmp.learnFromMinimumJerk(start, goal, sampling_frequency, duration))
+  {
+    dmp_lib::Logger::logPrintf("Could not learn DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+static bool benchmark(const int num_dimensions, const int num_rollouts)
+{
+  dmp_lib::NC2010DMP dmp;
+  VectorXd start, goal;
+  if (!initialize(dmp, num_dimensions, start, goal))
+  {
+    return false;
+  }
+
+  VectorXd desired_positions = VectorXd::Zero(num_dimensions);
+  VectorXd desired_velocities = VectorXd::Zero(num_dimensions);
+  VectorXd desired_accelerations = VectorXd::Zero(num_dimensions);
+  int num_steps = 0;
+  double checksum = 0;
+  double total_duration = 0;
+  for (int r = 0; r < num_rollouts; ++r)
+  {
+    if (!dmp.setup(start, goal, duration, sampling_frequency))
+    {
+      dmp_lib::Logger::logPrintf("Could not setup DMP.", dmp_lib::Logger::ERROR);
+      return false;
+    }
+    bool movement_finished = false;
+    double start_time = getTime();
+    while (!movement_finished)
+    {
+      if (!dmp.propagateStep(desired_positions, desired_velocities, desired_accelerations, movement_finished))
+      {
+        dmp_lib::Logger::logPrintf("Could not propagate DMP.", dmp_lib::Logger::ERROR);
+        return false;
+      }
+      num_steps++;
+    }
+    total_duration += getTime() - start_time;
+    checksum += desired_positions.sum();
+  }
+
+  printf("num_dimensions: %3i  num_rfs: %3i  per propagateStep: %8.1f ns  (checksum: %f)\n", num_dimensions, num_rfs,
+         (total_duration / static_cast<double> (num_steps)) * 1e9, checksum);
+  return true;
+}
+
+static bool benchmarkFull(const int num_dimensions, const int num_rollouts, const bool offline)
+{
+  dmp_lib::NC2010DMP dmp;
+  VectorXd start, goal;
+  if (!initialize(dmp, num_dimensions, start, goal))
+  {
+    return false;
+  }
+
+  const int num_samples = static_cast<int> (duration * sampling_frequency);
+  dmp_lib::Trajectory rollout;
+  double checksum = 0;
+  double total_duration = 0;
+  for (int r = 0; r < num_rollouts; ++r)
+  {
+    if (!dmp.setup(start, goal, duration, sampling_frequency))
+    {
+      dmp_lib::Logger::logPrintf("Could not setup DMP.", dmp_lib::Logger::ERROR);
+      return false;
+    }
+    double start_time = getTime();
+    bool success = offline ? dmp.propagateFullOffline(rollout, duration, num_samples) : dmp.propagateFull(rollout, duration, num_samples);
+    total_duration += getTime() - start_time;
+    if (!success)
+    {
+      dmp_lib::Logger::logPrintf("Could not propagate DMP.", dmp_lib::Logger::ERROR);
+      return false;
+    }
+    VectorXd end = VectorXd::Zero(num_dimensions);
+    rollout.getEndPosition(end);
+    checksum += end.sum();
+  }
+
+  printf("num_dimensions: %3i  num_rfs: %3i  per %s: %8.1f us  (checksum: %f)\n", num_dimensions, num_rfs,
+         offline ? "propagateFullOffline" : "propagateFull       ", (total_duration / static_cast<double> (num_rollouts)) * 1e6, checksum);
+  return true;
+}
+
+static bool benchmarkBatch(const int num_dimensions, const int num_rollouts, const int num_threads)
+{
+  std::vector<dmp_lib::DMPPtr> dmps;
+  VectorXd start, goal;
+  for (int r = 0; r < num_rollouts; ++r)
+  {
+    dmp_lib::NC2010DMPPtr dmp(new dmp_lib::NC2010DMP());
+    if (!initialize(*dmp, num_dimensions, start, goal))
+    {
+      return false;
+    }
+    dmps.push_back(dmp);
+  }
+  dmp_lib::BatchPropagator batch_propagator;
+  if (!batch_propagator.initialize(num_threads))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize batch propagator.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  const int num_batches = 5;
+  const int num_samples = static_cast<int> (duration * sampling_frequency);
+  std::vector<dmp_lib::Trajectory> rollouts;
+  double total_duration = 0;
+  for (int b = 0; b < num_batches; ++b)
+  {
+    for (int r = 0; r < num_rollouts; ++r)
+    {
+      if (!dmps[r]->setup(start, goal, duration, sampling_frequency))
+      {
+        dmp_lib::Logger::logPrintf("Could not setup DMP.", dmp_lib::Logger::ERROR);
+        return false;
+      }
+    }
+    double start_time = getTime();
+    if (!batch_propagator.propagateFull(dmps, rollouts, duration, num_samples))
+    {
+      dmp_lib::Logger::logPrintf("Could not propagate DMPs.", dmp_lib::Logger::ERROR);
+      return false;
+    }
+    total_duration += getTime() - start_time;
+  }
+
+  printf("num_dimensions: %3i  num_rfs: %3i  num_threads: %2i  per batch of %i rollouts: %8.1f us\n", num_dimensions, num_rfs,
+         batch_propagator.getNumThreads(), num_rollouts, (total_duration / static_cast<double> (num_batches)) * 1e6);
+  return true;
+}
+
+int main()
+{
+  const int num_rollouts = 20;
+  const int num_dimensions[] = {7, 14, 50};
+  for (int i = 0; i < static_cast<int> (sizeof(num_dimensions) / sizeof(num_dimensions[0])); ++i)
+  {
+    if (!benchmark(num_dimensions[i], num_rollouts)
+        || !benchmarkFull(num_dimensions[i], num_rollouts, false)
+        || !benchmarkFull(num_dimensions[i], num_rollouts, true))
+    {
+      return -1;
+    }
+  }
+  const int num_threads[] = {1, 2, 4};
+  for (int i = 0; i < static_cast<int> (sizeof(num_threads) / sizeof(num_threads[0])); ++i)
+  {
+    if (!benchmarkBatch(14, num_rollouts, num_threads[i]))
+    {
+      return -1;
+    }
+  }
+  return 0;
+}
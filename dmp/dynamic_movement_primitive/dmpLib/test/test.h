@@ -27,6 +27,10 @@
 // local includes
 #include "test_dynamic_movement_primitive.h"
 #include "test_trajectory.h"
+#include "test_offline_propagation.h"
+#include "test_transformation_system.h"
+#include "test_batch_propagator.h"
+#include "test_fixed_dynamic_movement_primitive.h"
 #include "test_data.h"
 #include "icra2009_test.h"
 
@@ -105,6 +109,30 @@ inline bool Test::test(const std::string base_directory, const bool regenerate_r
     return false;
   }
 
+  if (!test_dmp::TestOfflinePropagation::test())
+  {
+    dmp_lib::Logger::logPrintf("Offline propagation test failed.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  if (!test_dmp::TestTransformationSystem::test())
+  {
+    dmp_lib::Logger::logPrintf("Transformation system test failed.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  if (!test_dmp::TestBatchPropagator::test())
+  {
+    dmp_lib::Logger::logPrintf("Batch propagator test failed.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  if (!test_dmp::TestFixedDynamicMovementPrimitive::test())
+  {
+    dmp_lib::Logger::logPrintf("Fixed DMP test failed.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
   dmp_lib::Logger::logPrintf("Test finished successful.", dmp_lib::Logger::INFO);
   return true;
 }
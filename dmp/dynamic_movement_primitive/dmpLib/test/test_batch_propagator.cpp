@@ -0,0 +1,121 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal 
+ *********************************************************************
+  \remarks		...
+ 
+  \file		test_batch_propagator.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+// local includes
+#include <dmp_lib/logger.h>
+#include <dmp_lib/batch_propagator.h>
+#include <dmp_lib/nc2010_dynamic_movement_primitive.h>
+#include "test_batch_propagator.h"
+
+using namespace Eigen;
+
+namespace test_dmp
+{
+
+static bool createDMP(dmp_lib::NC2010DMPPtr& dmp, const VectorXd& start, const VectorXd& goal, const double sampling_frequency, const double duration)
+{
+  const double k_gain = 250.0;
+  std::vector<std::string> variable_names;
+  for (int i = 0; i < start.size(); ++i)
+  {
+    std::stringstream ss;
+    ss << "variable_" << i;
+    variable_names.push_back(ss.str());
+  }
+  lwr_lib::LWRParamPtr lwr_parameters(new lwr_lib::LWRParameters());
+  if (!lwr_parameters->initialize(30, 0.7, true, 0.001))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize LWR parameters.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  dmp.reset(new dmp_lib::NC2010DMP());
+  if (!dmp->initialize(variable_names, lwr_parameters, k_gain, dmp_lib::NC2010TS::getDGain(k_gain)))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  if (!dmp->learnFromMinimumJerk(start, goal, sampling_frequency, duration))
+  {
+    dmp_lib::Logger::logPrintf("Could not learn DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+bool TestBatchPropagator::test(const int num_threads, const int num_dmps)
+{
+  const int num_dimensions = 3;
+  const double sampling_frequency = 1000.0;
+  const double duration = 1.0;
+  const int num_samples = static_cast<int> (duration * sampling_frequency);
+  VectorXd start = VectorXd::Zero(num_dimensions);
+  VectorXd goal = VectorXd::LinSpaced(num_dimensions, 0.2, 1.0);
+
+  // create dmps with different goals, propagate them sequentially and in parallel
+  std::vector<dmp_lib::DMPPtr> dmps;
+  std::vector<dmp_lib::Trajectory> sequential_rollouts(num_dmps);
+  for (int i = 0; i < num_dmps; ++i)
+  {
+    dmp_lib::NC2010DMPPtr dmp;
+    if (!createDMP(dmp, start, goal, sampling_frequency, duration))
+    {
+      return false;
+    }
+    VectorXd new_goal = goal * (1.0 + 0.1 * static_cast<double> (i));
+    if (!dmp->setup(start, new_goal, duration, sampling_frequency)
+        || !dmp->propagateFull(sequential_rollouts[i], duration, num_samples)
+        || !dmp->setup(start, new_goal, duration, sampling_frequency))
+    {
+      dmp_lib::Logger::logPrintf("Could not propagate DMP.", dmp_lib::Logger::ERROR);
+      return false;
+    }
+    dmps.push_back(dmp);
+  }
+
+  dmp_lib::BatchPropagator batch_propagator;
+  if (!batch_propagator.initialize(num_threads))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize batch propagator.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  std::vector<dmp_lib::Trajectory> rollouts;
+  if (!batch_propagator.propagateFull(dmps, rollouts, duration, num_samples))
+  {
+    dmp_lib::Logger::logPrintf("Could not propagate DMPs in parallel.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  for (int i = 0; i < num_dmps; ++i)
+  {
+    VectorXd end = VectorXd::Zero(num_dimensions);
+    VectorXd sequential_end = VectorXd::Zero(num_dimensions);
+    if (rollouts[i].getNumContainedSamples() != sequential_rollouts[i].getNumContainedSamples()
+        || !rollouts[i].getEndPosition(end) || !sequential_rollouts[i].getEndPosition(sequential_end)
+        || end != sequential_end)
+    {
+      dmp_lib::Logger::logPrintf("Rollout >%i< of the batch propagator differs from the sequential rollout.", dmp_lib::Logger::ERROR, i);
+      return false;
+    }
+  }
+  return true;
+}
+
+}
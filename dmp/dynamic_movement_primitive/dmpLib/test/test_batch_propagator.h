@@ -0,0 +1,53 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal 
+ *********************************************************************
+  \remarks		...
+ 
+  \file		test_batch_propagator.h
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef TEST_BATCH_PROPAGATOR_H_
+#define TEST_BATCH_PROPAGATOR_H_
+
+// system includes
+
+// local includes
+
+namespace test_dmp
+{
+
+/*! Compares the rollouts of BatchPropagator against propagating each DMP sequentially
+ */
+class TestBatchPropagator
+{
+
+public:
+
+    /*!
+     * @param num_threads
+     * @param num_dmps
+     * @return True if the test passed, otherwise False
+     */
+    static bool test(const int num_threads = 3, const int num_dmps = 8);
+
+private:
+
+    /*!
+     */
+    TestBatchPropagator() {};
+    /*!
+     */
+    virtual ~TestBatchPropagator() {};
+
+};
+
+}
+
+
+#endif /* TEST_BATCH_PROPAGATOR_H_ */
@@ -0,0 +1,132 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		...
+
+  \file		test_fixed_dynamic_movement_primitive.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+// local includes
+#include <dmp_lib/logger.h>
+#include <dmp_lib/nc2010_dynamic_movement_primitive.h>
+#include <dmp_lib/fixed_dynamic_movement_primitive.h>
+#include "test_fixed_dynamic_movement_primitive.h"
+
+using namespace Eigen;
+
+namespace test_dmp
+{
+
+static const int NUM_DIMENSIONS = 3;
+typedef dmp_lib::FixedDynamicMovementPrimitive<NUM_DIMENSIONS> FixedDMP;
+
+bool TestFixedDynamicMovementPrimitive::test(const double threshold)
+{
+  const double k_gain = 250.0;
+  const double sampling_frequency = 1000.0;
+  const double duration = 1.0;
+  std::vector<std::string> variable_names;
+  for (int i = 0; i < NUM_DIMENSIONS; ++i)
+  {
+    std::stringstream ss;
+    ss << "variable_" << i;
+    variable_names.push_back(ss.str());
+  }
+  lwr_lib::LWRParamPtr lwr_parameters(new lwr_lib::LWRParameters());
+  if (!lwr_parameters->initialize(30, 0.7, true, 0.001))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize LWR parameters.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  dmp_lib::NC2010DMP dmp;
+  if (!dmp.initialize(variable_names, lwr_parameters, k_gain, dmp_lib::NC2010TS::getDGain(k_gain)))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  VectorXd start = VectorXd::Zero(NUM_DIMENSIONS);
+  VectorXd goal = VectorXd::LinSpaced(NUM_DIMENSIONS, 0.2, 1.0);
+  if (!dmp.learnFromMinimumJerk(start, goal, sampling_frequency, duration))
+  {
+    dmp_lib::Logger::logPrintf("Could not learn DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  // the fixed dmp takes over the setup of the dmp
+  VectorXd new_goal = goal * 1.5;
+  if (!dmp.setup(start, new_goal, duration, sampling_frequency))
+  {
+    dmp_lib::Logger::logPrintf("Could not setup DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  FixedDMP fixed_dmp;
+  if (!fixed_dmp.initialize(dmp) || !fixed_dmp.isSetup())
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize fixed DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  VectorXd positions = VectorXd::Zero(NUM_DIMENSIONS);
+  VectorXd velocities = VectorXd::Zero(NUM_DIMENSIONS);
+  VectorXd accelerations = VectorXd::Zero(NUM_DIMENSIONS);
+  FixedDMP::Vector fixed_positions, fixed_velocities, fixed_accelerations;
+  bool movement_finished = false;
+  bool fixed_movement_finished = false;
+  int num_steps = 0;
+  double max_difference = 0;
+  while (!movement_finished)
+  {
+    // change the goal of one dimension half way through
+    if (num_steps == 500)
+    {
+      if (!dmp.changeGoal(0.5, 1) || !fixed_dmp.changeGoal(0.5, 1))
+      {
+        dmp_lib::Logger::logPrintf("Could not change goal.", dmp_lib::Logger::ERROR);
+        return false;
+      }
+    }
+    if (!dmp.propagateStep(positions, velocities, accelerations, movement_finished)
+        || !fixed_dmp.propagateStep(fixed_positions, fixed_velocities, fixed_accelerations, fixed_movement_finished))
+    {
+      dmp_lib::Logger::logPrintf("Could not propagate DMP.", dmp_lib::Logger::ERROR);
+      return false;
+    }
+    num_steps++;
+    if (movement_finished != fixed_movement_finished)
+    {
+      dmp_lib::Logger::logPrintf("Fixed DMP finished after a different number of steps than the DMP >%i<.", dmp_lib::Logger::ERROR, num_steps);
+      return false;
+    }
+    max_difference = std::max(max_difference, (positions - fixed_positions).cwiseAbs().maxCoeff());
+    max_difference = std::max(max_difference, (velocities - fixed_velocities).cwiseAbs().maxCoeff());
+    max_difference = std::max(max_difference, (accelerations - fixed_accelerations).cwiseAbs().maxCoeff());
+  }
+  if (max_difference > threshold)
+  {
+    dmp_lib::Logger::logPrintf("Fixed DMP differs from the DMP by >%e< which exceeds the threshold >%e<.", dmp_lib::Logger::ERROR, max_difference, threshold);
+    return false;
+  }
+
+  // a fixed dmp can be setup again without the dmp
+  if (!fixed_dmp.setup() || fixed_dmp.getProgress() != 0.0)
+  {
+    dmp_lib::Logger::logPrintf("Could not setup fixed DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+}
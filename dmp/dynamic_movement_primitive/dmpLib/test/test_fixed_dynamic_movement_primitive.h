@@ -0,0 +1,52 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal 
+ *********************************************************************
+  \remarks		...
+ 
+  \file		test_fixed_dynamic_movement_primitive.h
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef TEST_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+#define TEST_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_
+
+// system includes
+
+// local includes
+
+namespace test_dmp
+{
+
+/*! Compares FixedDynamicMovementPrimitive::propagateStep against the NC2010 DMP it has been initialized from
+ */
+class TestFixedDynamicMovementPrimitive
+{
+
+public:
+
+    /*!
+     * @param threshold : maximum difference of the positions, velocities, and accelerations
+     * @return True if the test passed, otherwise False
+     */
+    static bool test(const double threshold = 1e-6);
+
+private:
+
+    /*!
+     */
+    TestFixedDynamicMovementPrimitive() {};
+    /*!
+     */
+    virtual ~TestFixedDynamicMovementPrimitive() {};
+
+};
+
+}
+
+
+#endif /* TEST_FIXED_DYNAMIC_MOVEMENT_PRIMITIVE_H_ */
@@ -0,0 +1,117 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal 
+ *********************************************************************
+  \remarks		...
+ 
+  \file		test_offline_propagation.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <math.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+// local includes
+#include <dmp_lib/logger.h>
+#include <dmp_lib/nc2010_dynamic_movement_primitive.h>
+#include "test_offline_propagation.h"
+
+using namespace Eigen;
+
+namespace test_dmp
+{
+
+bool TestOfflinePropagation::test(const double error_threshold)
+{
+  const int num_dimensions = 3;
+  const double k_gain = 250.0;
+  const double sampling_frequency = 1000.0;
+  const double duration = 1.0;
+
+  std::vector<std::string> variable_names;
+  for (int i = 0; i < num_dimensions; ++i)
+  {
+    std::stringstream ss;
+    ss << "variable_" << i;
+    variable_names.push_back(ss.str());
+  }
+  lwr_lib::LWRParamPtr lwr_parameters(new lwr_lib::LWRParameters());
+  if (!lwr_parameters->initialize(30, 0.7, true, 0.001))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize LWR parameters.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  dmp_lib::NC2010DMP dmp;
+  if (!dmp.initialize(variable_names, lwr_parameters, k_gain, dmp_lib::NC2010TS::getDGain(k_gain)))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  VectorXd start = VectorXd::Zero(num_dimensions);
+  VectorXd goal = VectorXd::LinSpaced(num_dimensions, 0.2, 1.0);
+  if (!dmp.learnFromMinimumJerk(start, goal, sampling_frequency, duration))
+  {
+    dmp_lib::Logger::logPrintf("Could not learn DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  // propagate both ways with a different goal and duration than the demonstration
+  VectorXd new_goal = goal * 1.5;
+  const double new_duration = 1.5;
+  const int num_samples = static_cast<int> (new_duration * sampling_frequency);
+  dmp_lib::Trajectory rollout;
+  dmp_lib::Trajectory offline_rollout;
+  if (!dmp.setup(start, new_goal, new_duration, sampling_frequency) || !dmp.propagateFull(rollout, new_duration, num_samples))
+  {
+    dmp_lib::Logger::logPrintf("Could not propagate DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  if (!dmp.setup(start, new_goal, new_duration, sampling_frequency) || !dmp.propagateFullOffline(offline_rollout, new_duration, num_samples))
+  {
+    dmp_lib::Logger::logPrintf("Could not propagate DMP offline.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+
+  if (rollout.getNumContainedSamples() != offline_rollout.getNumContainedSamples())
+  {
+    dmp_lib::Logger::logPrintf("Number of samples >%i< and >%i< differ.", dmp_lib::Logger::ERROR,
+                               rollout.getNumContainedSamples(), offline_rollout.getNumContainedSamples());
+    return false;
+  }
+  double max_error = 0;
+  for (int n = 0; n < rollout.getNumContainedSamples(); ++n)
+  {
+    for (int i = 0; i < num_dimensions; ++i)
+    {
+      double position = 0;
+      double offline_position = 0;
+      if (!rollout.getTrajectoryPosition(n, i, position) || !offline_rollout.getTrajectoryPosition(n, i, offline_position))
+      {
+        return false;
+      }
+      double error = fabs(position - offline_position);
+      if (error > max_error)
+      {
+        max_error = error;
+      }
+    }
+  }
+  if (max_error > error_threshold)
+  {
+    dmp_lib::Logger::logPrintf("Offline propagation differs by >%f< which exceeds the threshold >%f<.", dmp_lib::Logger::ERROR, max_error, error_threshold);
+    return false;
+  }
+  dmp_lib::Logger::logPrintf("Offline propagation differs by >%f<.", dmp_lib::Logger::INFO, max_error);
+  return true;
+}
+
+}
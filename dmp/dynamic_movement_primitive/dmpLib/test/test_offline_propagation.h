@@ -0,0 +1,53 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal 
+ *********************************************************************
+  \remarks		...
+ 
+  \file		test_offline_propagation.h
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef TEST_OFFLINE_PROPAGATION_H_
+#define TEST_OFFLINE_PROPAGATION_H_
+
+// system includes
+
+// local includes
+#include <dmp_lib/trajectory.h>
+
+namespace test_dmp
+{
+
+/*! Compares DynamicMovementPrimitive::propagateFullOffline against DynamicMovementPrimitive::propagateFull
+ */
+class TestOfflinePropagation
+{
+
+public:
+
+    /*!
+     * @param error_threshold : maximum allowed absolute position difference
+     * @return True if the test passed, otherwise False
+     */
+    static bool test(const double error_threshold = 0.01);
+
+private:
+
+    /*!
+     */
+    TestOfflinePropagation() {};
+    /*!
+     */
+    virtual ~TestOfflinePropagation() {};
+
+};
+
+}
+
+
+#endif /* TEST_OFFLINE_PROPAGATION_H_ */
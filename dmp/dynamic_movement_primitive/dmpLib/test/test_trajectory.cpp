@@ -21,6 +21,7 @@
 #include <Eigen/Core>
 
 #include <dmp_lib/logger.h>
+#include <dmp_lib/mapped_trajectory.h>
 
 // local includes
 #include "test_trajectory.h"
@@ -73,6 +74,59 @@ bool TestTrajectory::test(const string& filename, const TestData& testdata, cons
     return false;
   }
 
+  // binary files are read back bit-exact, both mapped and copied
+  fname.assign(result_directory_name + filename + string("_pos_vel_acc.bin"));
+  if (!pos_vel_acc_trajectory.writeToBinaryFile(fname))
+  {
+    dmp_lib::Logger::logPrintf("Could not write binary file >%s<.", Logger::ERROR, fname.c_str());
+    return false;
+  }
+  MappedTrajectory mapped_trajectory;
+  if (!mapped_trajectory.initialize(fname))
+  {
+    dmp_lib::Logger::logPrintf("Could not map binary file >%s<.", Logger::ERROR, fname.c_str());
+    return false;
+  }
+  Trajectory binary_trajectory;
+  if (!binary_trajectory.readFromBinaryFile(fname))
+  {
+    dmp_lib::Logger::logPrintf("Could not read binary file >%s<.", Logger::ERROR, fname.c_str());
+    return false;
+  }
+  if (mapped_trajectory.containsPositionsOnly()
+      || mapped_trajectory.getVariableNames() != pos_vel_acc_trajectory.getVariableNames()
+      || mapped_trajectory.getNumSamples() != pos_vel_acc_trajectory.getNumContainedSamples()
+      || mapped_trajectory.getSamplingFrequency() != pos_vel_acc_trajectory.getSamplingFrequency()
+      || binary_trajectory.getNumContainedSamples() != pos_vel_acc_trajectory.getNumContainedSamples())
+  {
+    dmp_lib::Logger::logPrintf("Binary file >%s< does not match the trajectory.", Logger::ERROR, fname.c_str());
+    return false;
+  }
+  for (int i = 0; i < pos_vel_acc_trajectory.getNumContainedSamples(); ++i)
+  {
+    for (int j = 0; j < pos_vel_acc_trajectory.getDimension(); ++j)
+    {
+      double position, velocity, acceleration, binary_position, binary_velocity, binary_acceleration;
+      if (!pos_vel_acc_trajectory.getTrajectoryPosition(i, j, position)
+          || !pos_vel_acc_trajectory.getTrajectoryVelocity(i, j, velocity)
+          || !pos_vel_acc_trajectory.getTrajectoryAcceleration(i, j, acceleration)
+          || !binary_trajectory.getTrajectoryPosition(i, j, binary_position)
+          || !binary_trajectory.getTrajectoryVelocity(i, j, binary_velocity)
+          || !binary_trajectory.getTrajectoryAcceleration(i, j, binary_acceleration))
+      {
+        dmp_lib::Logger::logPrintf("Could not get trajectory sample >%i< of dimension >%i<.", Logger::ERROR, i, j);
+        return false;
+      }
+      if (mapped_trajectory.getPositions()(i, j) != position || mapped_trajectory.getVelocities()(i, j) != velocity
+          || mapped_trajectory.getAccelerations()(i, j) != acceleration || binary_position != position
+          || binary_velocity != velocity || binary_acceleration != acceleration)
+      {
+        dmp_lib::Logger::logPrintf("Binary file >%s< differs at sample >%i< of dimension >%i<.", Logger::ERROR, fname.c_str(), i, j);
+        return false;
+      }
+    }
+  }
+
   Trajectory pos_trajectory;
   fname.assign(data_directory_name + filename + prefix);
   if (!pos_trajectory.readFromCLMCFile(fname, variable_names, true))
@@ -176,7 +230,7 @@ bool TestTrajectory::test(const string& filename, const TestData& testdata, cons
   }
   double sampling_frequency = 300.0;
   int num_samples = 900;
-  if(!min_jerk_trajectory.initializeWithMinJerk(variable_names, sampling_frequency, start, goal, num_samples))
+  if(!min_jerk_trajectory.initializeWithMinJerk(variable_names, sampling_frequency, start, goal, num_samples, false, DYNAMIC_TRAJECTORY_LENGTH))
   {
     dmp_lib::Logger::logPrintf("Could not initilaize trajectory with minimum jerk.", Logger::ERROR);
     return false;
@@ -187,6 +241,73 @@ bool TestTrajectory::test(const string& filename, const TestData& testdata, cons
     dmp_lib::Logger::logPrintf("Could not write clmc file >%s<.", Logger::ERROR, fname.c_str());
     return false;
   }
+  if (min_jerk_trajectory.getNumTotalCapacity() != num_samples || min_jerk_trajectory.hasFixedCapacity())
+  {
+    dmp_lib::Logger::logPrintf("Minimum jerk trajectory holds >%i< instead of >%i< samples.", Logger::ERROR,
+                               min_jerk_trajectory.getNumTotalCapacity(), num_samples);
+    return false;
+  }
+
+  // dynamic trajectories grow on demand and can be shrunk to the contained samples
+  Trajectory dynamic_trajectory;
+  if (!dynamic_trajectory.initialize(variable_names, sampling_frequency, true, DYNAMIC_TRAJECTORY_LENGTH))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize dynamic trajectory.", Logger::ERROR);
+    return false;
+  }
+  for (int i = 0; i < num_samples; ++i)
+  {
+    if (!dynamic_trajectory.add(VectorXd::Constant(variable_names.size(), i)))
+    {
+      dmp_lib::Logger::logPrintf("Could not add sample >%i< to dynamic trajectory.", Logger::ERROR, i);
+      return false;
+    }
+  }
+  if (dynamic_trajectory.getNumTotalCapacity() < num_samples)
+  {
+    dmp_lib::Logger::logPrintf("Dynamic trajectory did not grow.", Logger::ERROR);
+    return false;
+  }
+  dynamic_trajectory.shrinkToFit();
+  if (dynamic_trajectory.getNumTotalCapacity() != num_samples || !dynamic_trajectory.reserve(2 * num_samples))
+  {
+    dmp_lib::Logger::logPrintf("Could not change capacity of dynamic trajectory.", Logger::ERROR);
+    return false;
+  }
+  double position = 0.0;
+  if (!dynamic_trajectory.getTrajectoryPosition(num_samples - 1, 0, position) || position != num_samples - 1)
+  {
+    dmp_lib::Logger::logPrintf("Dynamic trajectory did not preserve its samples.", Logger::ERROR);
+    return false;
+  }
+
+  // trajectories with fixed capacity never grow
+  Trajectory fixed_trajectory;
+  if (!fixed_trajectory.initialize(variable_names, sampling_frequency, true, 1) || !fixed_trajectory.add(start)
+      || fixed_trajectory.add(start) || fixed_trajectory.getNumTotalCapacity() != 1)
+  {
+    dmp_lib::Logger::logPrintf("Trajectory with fixed capacity grew.", Logger::ERROR);
+    return false;
+  }
+  if (fixed_trajectory.append(dynamic_trajectory) || fixed_trajectory.getNumTotalCapacity() != 1)
+  {
+    dmp_lib::Logger::logPrintf("Trajectory with fixed capacity grew when appending.", Logger::ERROR);
+    return false;
+  }
+  if (!dynamic_trajectory.append(fixed_trajectory) || dynamic_trajectory.getNumContainedSamples() != num_samples + 1)
+  {
+    dmp_lib::Logger::logPrintf("Could not append to dynamic trajectory.", Logger::ERROR);
+    return false;
+  }
+
+  // trajectories are preallocated (and real-time safe) by default
+  Trajectory default_trajectory;
+  if (!default_trajectory.initialize(variable_names, sampling_frequency) || !default_trajectory.hasFixedCapacity()
+      || default_trajectory.getNumTotalCapacity() != MAX_TRAJECTORY_LENGTH)
+  {
+    dmp_lib::Logger::logPrintf("Default trajectory is not preallocated.", Logger::ERROR);
+    return false;
+  }
 
   return true;
 }
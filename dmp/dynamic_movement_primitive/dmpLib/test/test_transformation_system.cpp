@@ -0,0 +1,235 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal 
+ *********************************************************************
+  \remarks		...
+ 
+  \file		test_transformation_system.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <math.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+// local includes
+#include <dmp_lib/logger.h>
+#include <dmp_lib/nc2010_dynamic_movement_primitive.h>
+#include "test_transformation_system.h"
+
+using namespace Eigen;
+
+namespace test_dmp
+{
+
+static const int NUM_DIMENSIONS = 3;
+static const double SAMPLING_FREQUENCY = 1000.0;
+static const double DURATION = 1.0;
+
+/*! Initializes a DMP whose dimensions share the same receptive fields and learns a minimum jerk movement
+ */
+static bool initializeDMP(dmp_lib::NC2010DMP& dmp)
+{
+  const double k_gain = 250.0;
+  std::vector<std::string> variable_names;
+  for (int i = 0; i < NUM_DIMENSIONS; ++i)
+  {
+    std::stringstream ss;
+    ss << "variable_" << i;
+    variable_names.push_back(ss.str());
+  }
+  lwr_lib::LWRParamPtr lwr_parameters(new lwr_lib::LWRParameters());
+  if (!lwr_parameters->initialize(30, 0.7, true, 0.001))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize LWR parameters.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  if (!dmp.initialize(variable_names, lwr_parameters, k_gain, dmp_lib::NC2010TS::getDGain(k_gain)))
+  {
+    dmp_lib::Logger::logPrintf("Could not initialize DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  if (!dmp.learnFromMinimumJerk(VectorXd::Zero(NUM_DIMENSIONS), VectorXd::LinSpaced(NUM_DIMENSIONS, 0.2, 1.0), SAMPLING_FREQUENCY, DURATION))
+  {
+    dmp_lib::Logger::logPrintf("Could not learn DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+/*! Propagates the DMP towards the goal it has been learned with
+ */
+static bool propagate(dmp_lib::NC2010DMP& dmp, dmp_lib::Trajectory& rollout)
+{
+  const int num_samples = static_cast<int> (DURATION * SAMPLING_FREQUENCY);
+  if (!dmp.setup(VectorXd::Zero(NUM_DIMENSIONS), VectorXd::LinSpaced(NUM_DIMENSIONS, 0.2, 1.0), DURATION, SAMPLING_FREQUENCY)
+      || !dmp.propagateFull(rollout, DURATION, num_samples))
+  {
+    dmp_lib::Logger::logPrintf("Could not propagate DMP.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+/*! Computes the largest absolute position difference of both rollouts
+ */
+static bool getMaxDifference(const dmp_lib::Trajectory& rollout, const dmp_lib::Trajectory& other_rollout, double& max_difference)
+{
+  if (rollout.getNumContainedSamples() != other_rollout.getNumContainedSamples())
+  {
+    dmp_lib::Logger::logPrintf("Number of samples >%i< and >%i< differ.", dmp_lib::Logger::ERROR,
+                               rollout.getNumContainedSamples(), other_rollout.getNumContainedSamples());
+    return false;
+  }
+  max_difference = 0;
+  for (int n = 0; n < rollout.getNumContainedSamples(); ++n)
+  {
+    for (int i = 0; i < NUM_DIMENSIONS; ++i)
+    {
+      double position = 0;
+      double other_position = 0;
+      if (!rollout.getTrajectoryPosition(n, i, position) || !other_rollout.getTrajectoryPosition(n, i, other_position))
+      {
+        return false;
+      }
+      max_difference = std::max(max_difference, fabs(position - other_position));
+    }
+  }
+  return true;
+}
+
+/*! Sets up the buffers of the transformation system of the DMP from scratch by assigning a copy of it
+ */
+static void reinitialize(dmp_lib::NC2010DMP& dmp)
+{
+  dmp_lib::NC2010TSPtr transformation_system = boost::dynamic_pointer_cast<dmp_lib::NC2010TS>(dmp.getTransformationSystem(0));
+  dmp_lib::NC2010TS copy;
+  copy = *transformation_system;
+  *transformation_system = copy;
+}
+
+/*! The DMP that has been modified after initialization needs to match the reference DMP, which has been modified
+ * the same way and re-initialized afterwards, but must differ from the unmodified one.
+ */
+static bool compare(dmp_lib::NC2010DMP& modified_dmp, dmp_lib::NC2010DMP& reference_dmp,
+                    dmp_lib::NC2010DMP& unmodified_dmp, const std::string& modification)
+{
+  dmp_lib::Trajectory rollout, reference_rollout, unmodified_rollout;
+  if (!propagate(modified_dmp, rollout) || !propagate(reference_dmp, reference_rollout) || !propagate(unmodified_dmp, unmodified_rollout))
+  {
+    return false;
+  }
+  double difference = 0;
+  if (!getMaxDifference(rollout, reference_rollout, difference))
+  {
+    return false;
+  }
+  if (difference > 0.0)
+  {
+    dmp_lib::Logger::logPrintf("Changing the %s after initialization changes the rollout by >%f< compared to a re-initialized DMP.",
+                               dmp_lib::Logger::ERROR, modification.c_str(), difference);
+    return false;
+  }
+  if (!getMaxDifference(rollout, unmodified_rollout, difference))
+  {
+    return false;
+  }
+  if (difference < 1e-6)
+  {
+    dmp_lib::Logger::logPrintf("Changing the %s did not have an effect on the rollout.", dmp_lib::Logger::ERROR, modification.c_str());
+    return false;
+  }
+  return true;
+}
+
+/*! All dimensions share one transformation system with the same receptive fields, widens those of one dimension
+ */
+static bool widenReceptiveFields(dmp_lib::NC2010DMP& dmp)
+{
+  lwr_lib::LWRPtr lwr_model = dmp.getTransformationSystem(0)->getParameters(1)->getLWRModel();
+  VectorXd widths = VectorXd::Zero(lwr_model->getNumRFS());
+  VectorXd centers = VectorXd::Zero(lwr_model->getNumRFS());
+  if (!lwr_model->getWidthsAndCenters(widths, centers) || !lwr_model->setWidthsAndCenters(widths * 4.0, centers))
+  {
+    dmp_lib::Logger::logPrintf("Could not change receptive fields.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+/*! All dimensions share one transformation system with the same gains, stiffens one dimension
+ */
+static bool stiffenGains(dmp_lib::NC2010DMP& dmp)
+{
+  dmp_lib::NC2010TSParamPtr parameters
+      = boost::dynamic_pointer_cast<dmp_lib::NC2010TSParam>(dmp.getTransformationSystem(0)->getParameters(1));
+  const double k_gain = 500.0;
+  if (!parameters || !parameters->initialize(k_gain, dmp_lib::NC2010TS::getDGain(k_gain)))
+  {
+    dmp_lib::Logger::logPrintf("Could not change gains.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+bool TestTransformationSystem::testReceptiveFields()
+{
+  dmp_lib::NC2010DMP dmp, reference_dmp, unmodified_dmp;
+  if (!initializeDMP(dmp) || !initializeDMP(reference_dmp) || !initializeDMP(unmodified_dmp))
+  {
+    return false;
+  }
+  if (!widenReceptiveFields(dmp) || !widenReceptiveFields(reference_dmp))
+  {
+    return false;
+  }
+  reinitialize(reference_dmp);
+  return compare(dmp, reference_dmp, unmodified_dmp, "receptive fields");
+}
+
+bool TestTransformationSystem::testGains()
+{
+  dmp_lib::NC2010DMP dmp, reference_dmp, unmodified_dmp;
+  if (!initializeDMP(dmp) || !initializeDMP(reference_dmp) || !initializeDMP(unmodified_dmp))
+  {
+    return false;
+  }
+  // propagate once such that the gains have been used before they are changed
+  dmp_lib::Trajectory rollout;
+  if (!propagate(dmp, rollout))
+  {
+    return false;
+  }
+  if (!stiffenGains(dmp) || !stiffenGains(reference_dmp))
+  {
+    return false;
+  }
+  reinitialize(reference_dmp);
+  return compare(dmp, reference_dmp, unmodified_dmp, "gains");
+}
+
+bool TestTransformationSystem::test()
+{
+  if (!testReceptiveFields())
+  {
+    dmp_lib::Logger::logPrintf("Receptive field test failed.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  if (!testGains())
+  {
+    dmp_lib::Logger::logPrintf("Gain test failed.", dmp_lib::Logger::ERROR);
+    return false;
+  }
+  return true;
+}
+
+}
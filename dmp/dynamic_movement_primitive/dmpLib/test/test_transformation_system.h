@@ -0,0 +1,61 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal 
+ *********************************************************************
+  \remarks		...
+ 
+  \file		test_transformation_system.h
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef TEST_TRANSFORMATION_SYSTEM_H_
+#define TEST_TRANSFORMATION_SYSTEM_H_
+
+// system includes
+
+// local includes
+
+namespace test_dmp
+{
+
+/*! Checks that the buffers of multi dimensional transformation systems follow changes of the per dimension parameters
+ */
+class TestTransformationSystem
+{
+
+public:
+
+    /*!
+     * @return True if the test passed, otherwise False
+     */
+    static bool test();
+
+private:
+
+    /*! Changes the receptive fields of one dimension after initialization
+     * @return True if the test passed, otherwise False
+     */
+    static bool testReceptiveFields();
+
+    /*! Changes the gains of one dimension after initialization
+     * @return True if the test passed, otherwise False
+     */
+    static bool testGains();
+
+    /*!
+     */
+    TestTransformationSystem() {};
+    /*!
+     */
+    virtual ~TestTransformationSystem() {};
+
+};
+
+}
+
+
+#endif /* TEST_TRANSFORMATION_SYSTEM_H_ */
@@ -79,7 +79,7 @@ public:
 
 private:
 
-  /*!
+  /*! Initializes one (multi dimensional) transformation system from the array of one dimensional transformation system parameters
    * @param transformation_systems
    * @param transformation_systems_parameters_xml
    * @param node_handle
@@ -31,43 +31,14 @@ bool ICRA2009TransformationSystem::initOneDimensionalTransformationSystemHelper(
                                                                                 dmp_lib::TransformationSystem::IntegrationMethod integration_method)
 {
   ROS_ASSERT(transformation_systems_parameters_xml.getType() == XmlRpc::XmlRpcValue::TypeArray);
-  for (int j = 0; j < transformation_systems_parameters_xml.size(); ++j)
+  if (transformation_systems_parameters_xml.size() == 0)
   {
-    ROS_DEBUG("Initializing ICRA2009 transformation system number >%i< from node handle.",j);
-
-    // create transformation system
-    dmp_lib::ICRA2009TSPtr transformation_system(new dmp_lib::ICRA2009TransformationSystem());
-
-    XmlRpc::XmlRpcValue ts_xml = transformation_systems_parameters_xml[j];
-    ROS_ASSERT(ts_xml.hasMember(transformation_system->getVersionString()));
-    XmlRpc::XmlRpcValue icra2009_ts_xml = ts_xml[transformation_system->getVersionString()];
-
-    double k_gain = 0;
-    if (!usc_utilities::getParam(icra2009_ts_xml, "k_gain", k_gain))
-    {
-      return false;
-    }
-    double d_gain = dmp_lib::ICRA2009TransformationSystem::getDGain(k_gain);
-
-    // create parameters
-    dmp_lib::ICRA2009TSParamPtr parameters(new dmp_lib::ICRA2009TransformationSystemParameters());
-
-    // initialize parameters
-    ROS_VERIFY(parameters->initialize(k_gain, d_gain));
-
-    // initialize base class
-    ROS_VERIFY(TransformationSystem::initFromNodeHandle(parameters, ts_xml, node_handle));
-
-    // create state
-    dmp_lib::ICRA2009TSStatePtr state(new dmp_lib::ICRA2009TransformationSystemState());
-
-    // initialize transformation system with parameters and state
-    ROS_VERIFY(transformation_system->initialize(parameters, state, integration_method));
-    ROS_VERIFY(transformation_system->setIntegrationMethod(integration_method));
-
-    transformation_systems.push_back(transformation_system);
+    return true;
   }
-  return true;
+  // all variables are integrated by a single multi dimensional transformation system such that the
+  // integration operates on contiguous buffers and the basis functions are evaluated only once
+  return ICRA2009TransformationSystem::initMultiDimensionalTransformationSystemHelper(transformation_systems, transformation_systems_parameters_xml,
+                                                                                     node_handle, integration_method);
 }
 
 bool ICRA2009TransformationSystem::initMultiDimensionalTransformationSystemHelper(std::vector<dmp_lib::ICRA2009TSPtr>& transformation_systems,
@@ -75,7 +46,7 @@ bool ICRA2009TransformationSystem::initMultiDimensionalTransformationSystemHelpe
                                                                                   ros::NodeHandle& node_handle,
                                                                                   dmp_lib::TransformationSystem::IntegrationMethod integration_method)
 {
-  ROS_INFO("Initializing ICRA2009 orientation transformation system from node handle.");
+  ROS_DEBUG("Initializing ICRA2009 transformation system with >%i< dimensions from node handle.", transformation_systems_parameters_xml.size());
   std::vector<dmp_lib::ICRA2009TSParamPtr> parameters_vector;
   std::vector<dmp_lib::ICRA2009TSStatePtr> state_vector;
 
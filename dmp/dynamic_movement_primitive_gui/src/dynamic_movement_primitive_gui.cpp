@@ -393,6 +393,7 @@ void DynamicMovementPrimitiveGUI::simulate(dmp_lib::Trajectory& endeffector, dmp
 
   std::vector<Eigen::VectorXd> joint_angles;
   ROS_VERIFY(ik->ik(poses, rest_postures, rest_postures[0], joint_angles));
+  ROS_VERIFY(ik->visualize(poses, joint_angles, 1, true));
 }
 
 void DynamicMovementPrimitiveGUI::labelSelected(QListWidgetItem* current, QListWidgetItem* previous)
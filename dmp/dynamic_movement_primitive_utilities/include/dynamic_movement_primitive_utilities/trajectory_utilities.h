@@ -30,6 +30,7 @@
 
 #include <dmp_lib/dynamic_movement_primitive.h>
 #include <dmp_lib/trajectory.h>
+#include <dmp_lib/mapped_trajectory.h>
 
 // local includes
 
@@ -147,6 +148,54 @@ public:
   static bool filter(dmp_lib::Trajectory& trajectory,
                      const std::string& filter_name);
 
+  /*! Converts a CLMC file into a binary trajectory file (see dmp_lib::MappedTrajectory)
+   * @param abs_clmc_file_name
+   * @param variable_names
+   * @param abs_binary_file_name
+   * @param positions_only
+   * @return True if success, otherwise False
+   */
+  static bool convertCLMCToBinaryFile(const std::string& abs_clmc_file_name,
+                                      const std::vector<std::string>& variable_names,
+                                      const std::string& abs_binary_file_name,
+                                      const bool positions_only = false);
+
+  /*! Converts a binary trajectory file into a CLMC file
+   * @param abs_binary_file_name
+   * @param abs_clmc_file_name
+   * @param positions_only
+   * @return True if success, otherwise False
+   */
+  static bool convertBinaryToCLMCFile(const std::string& abs_binary_file_name,
+                                      const std::string& abs_clmc_file_name,
+                                      const bool positions_only = false);
+
+  /*! Resamples the joint states contained in the bag file (see createJointStateTrajectory) and writes them into a
+   *  binary trajectory file
+   * @param abs_bag_file_name
+   * @param variable_names
+   * @param abs_binary_file_name
+   * @param sampling_frequency
+   * @param topic_name
+   * @return True if success, otherwise False
+   */
+  static bool convertJointStateBagToBinaryFile(const std::string& abs_bag_file_name,
+                                               const std::vector<std::string>& variable_names,
+                                               const std::string& abs_binary_file_name,
+                                               const double sampling_frequency,
+                                               const std::string& topic_name = "/joint_states");
+
+  /*! Writes the positions (and velocities) of the binary trajectory file as joint states into a bag file. The
+   *  time stamps start at ros::TIME_MIN and are spaced according to the sampling frequency of the trajectory.
+   * @param abs_binary_file_name
+   * @param abs_bag_file_name
+   * @param topic_name
+   * @return True if success, otherwise False
+   */
+  static bool convertBinaryToJointStateBagFile(const std::string& abs_binary_file_name,
+                                               const std::string& abs_bag_file_name,
+                                               const std::string& topic_name = "/joint_states");
+
 private:
 
   /*! Constructor
@@ -515,5 +515,104 @@ bool TrajectoryUtilities::filter(dmp_lib::Trajectory& trajectory, const std::str
   return true;
 }
 
+bool TrajectoryUtilities::convertCLMCToBinaryFile(const string& abs_clmc_file_name,
+                                                  const vector<string>& variable_names,
+                                                  const string& abs_binary_file_name,
+                                                  const bool positions_only)
+{
+  dmp_lib::Trajectory trajectory;
+  if (!trajectory.readFromCLMCFile(abs_clmc_file_name, variable_names, positions_only))
+  {
+    ROS_ERROR("Could not read clmc file >%s<.", abs_clmc_file_name.c_str());
+    return false;
+  }
+  if (!trajectory.writeToBinaryFile(abs_binary_file_name, positions_only))
+  {
+    ROS_ERROR("Could not write binary trajectory file >%s<.", abs_binary_file_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool TrajectoryUtilities::convertBinaryToCLMCFile(const string& abs_binary_file_name,
+                                                  const string& abs_clmc_file_name,
+                                                  const bool positions_only)
+{
+  dmp_lib::Trajectory trajectory;
+  if (!trajectory.readFromBinaryFile(abs_binary_file_name, positions_only))
+  {
+    ROS_ERROR("Could not read binary trajectory file >%s<.", abs_binary_file_name.c_str());
+    return false;
+  }
+  if (!trajectory.writeToCLMCFile(abs_clmc_file_name, positions_only))
+  {
+    ROS_ERROR("Could not write clmc file >%s<.", abs_clmc_file_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool TrajectoryUtilities::convertJointStateBagToBinaryFile(const string& abs_bag_file_name,
+                                                           const vector<string>& variable_names,
+                                                           const string& abs_binary_file_name,
+                                                           const double sampling_frequency,
+                                                           const string& topic_name)
+{
+  dmp_lib::Trajectory trajectory;
+  if (!createJointStateTrajectory(trajectory, variable_names, abs_bag_file_name, sampling_frequency, topic_name))
+  {
+    ROS_ERROR("Could not create joint trajectory from bag file >%s<.", abs_bag_file_name.c_str());
+    return false;
+  }
+  if (!trajectory.writeToBinaryFile(abs_binary_file_name))
+  {
+    ROS_ERROR("Could not write binary trajectory file >%s<.", abs_binary_file_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool TrajectoryUtilities::convertBinaryToJointStateBagFile(const string& abs_binary_file_name,
+                                                           const string& abs_bag_file_name,
+                                                           const string& topic_name)
+{
+  // the data is read straight from the mapped file
+  dmp_lib::MappedTrajectory trajectory;
+  if (!trajectory.initialize(abs_binary_file_name))
+  {
+    ROS_ERROR("Could not map binary trajectory file >%s<.", abs_binary_file_name.c_str());
+    return false;
+  }
+  const int num_samples = trajectory.getNumSamples();
+  const int num_joints = trajectory.getDimension();
+  const double delta_t = 1.0 / trajectory.getSamplingFrequency();
+  dmp_lib::MappedTrajectory::ConstMatrixMap positions = trajectory.getPositions();
+
+  JointStateMsg joint_state_msg;
+  joint_state_msg.name = trajectory.getVariableNames();
+  joint_state_msg.position.resize(num_joints);
+  if (!trajectory.containsPositionsOnly())
+  {
+    joint_state_msg.velocity.resize(num_joints);
+  }
+  vector<JointStateMsg> joint_state_msgs(num_samples, joint_state_msg);
+  for (int i = 0; i < num_samples; ++i)
+  {
+    joint_state_msgs[i].header.stamp = ros::TIME_MIN + ros::Duration(static_cast<double> (i) * delta_t);
+    for (int j = 0; j < num_joints; ++j)
+    {
+      joint_state_msgs[i].position[j] = positions(i, j);
+    }
+    if (!trajectory.containsPositionsOnly())
+    {
+      dmp_lib::MappedTrajectory::ConstMatrixMap velocities = trajectory.getVelocities();
+      for (int j = 0; j < num_joints; ++j)
+      {
+        joint_state_msgs[i].velocity[j] = velocities(i, j);
+      }
+    }
+  }
+  return usc_utilities::FileIO<JointStateMsg>::writeToBagFileWithTimeStamps(joint_state_msgs, topic_name, abs_bag_file_name, false);
+}
 
 }
@@ -41,7 +41,8 @@ public:
 
     /*! Constructor
      */
-    LWR() {};
+    LWR() :
+      receptive_field_revision_(0), use_kernel_lookup_table_(false), lookup_table_min_x_(0.0), lookup_table_max_x_(0.0), lookup_table_log_min_x_(0.0), lookup_table_inv_du_(0.0), lookup_table_error_bound_(0.0) {};
 
     /*! Destructor
      */
@@ -74,6 +75,34 @@ public:
      */
     bool predict(const double x_query, double& y_prediction);
 
+    /*! Predicts the output from basis function activations that have been computed beforehand
+     * (see generateBasisFunctionVector). This allows to evaluate the kernels only once for several
+     * LWR models that share the same receptive fields (see hasSameReceptiveFields).
+     * @param x_query
+     * @param basis_functions (size must be equal to the number of receptive fields)
+     * @param y_prediction
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool predict(const double x_query, const Eigen::VectorXd& basis_functions, double& y_prediction) const;
+
+    /*! Checks whether the provided LWR model uses the same centers and widths (and lookup table settings)
+     * @param lwr_model
+     * @return True if both models generate identical basis functions, otherwise False
+     */
+    bool hasSameReceptiveFields(const LWR& lwr_model) const;
+
+    /*! Returns a number that changes whenever the receptive fields (or the way the basis functions are
+     * evaluated) change. The numbers are unique among all LWR models, such that users that rely on the
+     * receptive fields of several models can detect changes as well as replaced models.
+     * @return
+     * REAL-TIME REQUIREMENTS
+     */
+    unsigned long getReceptiveFieldRevision() const
+    {
+      return receptive_field_revision_;
+    }
+
     /*! Gets the theta vector
      * @param thetas
      * @return True on success, false on failure
@@ -189,6 +218,7 @@ public:
      * @param x_input
      * @param basis_functions
      * @return True on success, false on failure
+     * REAL-TIME REQUIREMENTS
      */
     bool generateBasisFunctionVector(const double x_input, Eigen::VectorXd& basis_functions) const;
 
@@ -200,6 +230,38 @@ public:
      */
     bool generateBasisFunction(const double x_input, const int rfs_index, double& basis_function) const;
 
+    /*! Enables tabulated basis functions. All kernels are sampled on num_samples inputs within
+     * [min_x, max_x] that are equally spaced in log(x) and linearly interpolated in between. This
+     * matches the exponentially spaced receptive fields used for DMPs, whose widths shrink with x.
+     * Queries outside of this range are evaluated exactly. The table is rebuilt whenever the
+     * receptive fields change.
+     * @param num_samples
+     * @param min_x (needs to be positive)
+     * @param max_x
+     * @return True on success, false on failure
+     */
+    bool enableKernelLookupTable(const int num_samples = 2000, const double min_x = 0.001, const double max_x = 1.0);
+
+    /*! Disables tabulated basis functions and frees the lookup table
+     */
+    void disableKernelLookupTable();
+
+    /*!
+     * @return True if basis functions are obtained from the lookup table
+     */
+    bool isKernelLookupTableEnabled() const
+    {
+      return use_kernel_lookup_table_;
+    }
+
+    /*! Returns the maximum absolute error of the interpolated basis functions within the table range
+     * @return Error bound (0 if the lookup table is disabled)
+     */
+    double getKernelLookupTableErrorBound() const
+    {
+      return lookup_table_error_bound_;
+    }
+
     /*! Return a string containing information about the LWR model
      * @return string containing information about the LWR model
      */
@@ -211,11 +273,43 @@ private:
      */
     LWRParamPtr parameters_;
 
+    /*! Revision of the receptive fields (see getReceptiveFieldRevision)
+     */
+    unsigned long receptive_field_revision_;
+
+    /*! Assigns a new receptive field revision, needs to be called whenever the receptive fields change
+     */
+    void updateReceptiveFieldRevision();
+
     /*! Evaluates the kernel
      * REAL-TIME REQUIREMENTS
      */
     double evaluateKernel(const double x_input, const int center_index) const;
 
+    /*! Computes the lookup table row and interpolation weight for the given input (log spaced)
+     * @param x_input
+     * @param row_index
+     * @param weight
+     * @return True if x_input is covered by the lookup table, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool getLookupTableIndex(const double x_input, int& row_index, double& weight) const;
+
+    /*! (Re-)builds the lookup table from the current receptive fields
+     * @return True on success, false on failure
+     */
+    bool buildKernelLookupTable();
+
+    /*! Lookup table settings and the sampled kernels (one row per input sample)
+     */
+    bool use_kernel_lookup_table_;
+    double lookup_table_min_x_;
+    double lookup_table_max_x_;
+    double lookup_table_log_min_x_;
+    double lookup_table_inv_du_;
+    double lookup_table_error_bound_;
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> kernel_lookup_table_;
+
 };
 
 /*! Abbreviation for convinience
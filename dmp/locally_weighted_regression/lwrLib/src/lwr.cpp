@@ -14,7 +14,12 @@
 
 // system include
 #include <stdio.h>
+#include <math.h>
 #include <cassert>
+#include <limits>
+#include <algorithm>
+
+#include <boost/detail/atomic_count.hpp>
 
 // local include
 #include <lwr_lib/lwr.h>
@@ -27,12 +32,31 @@ using namespace std;
 namespace lwr_lib
 {
 
+static const double MIN_KERNEL_EXPONENT = -700.0;
+
+/*! Source of the receptive field revisions of all LWR models
+ */
+static boost::detail::atomic_count receptive_field_revision_counter(0);
+
+void LWR::updateReceptiveFieldRevision()
+{
+  receptive_field_revision_ = ++receptive_field_revision_counter;
+}
+
 LWR& LWR::operator=(const LWR& lwr_model)
 {
   Logger::logPrintf("LWR assignment.", Logger::DEBUG);
 
   // assign memeber variables
   assert(Utilities<LWRParameters>::assign(parameters_, lwr_model.parameters_));
+  receptive_field_revision_ = lwr_model.receptive_field_revision_;
+  use_kernel_lookup_table_ = lwr_model.use_kernel_lookup_table_;
+  lookup_table_min_x_ = lwr_model.lookup_table_min_x_;
+  lookup_table_max_x_ = lwr_model.lookup_table_max_x_;
+  lookup_table_log_min_x_ = lwr_model.lookup_table_log_min_x_;
+  lookup_table_inv_du_ = lwr_model.lookup_table_inv_du_;
+  lookup_table_error_bound_ = lwr_model.lookup_table_error_bound_;
+  kernel_lookup_table_ = lwr_model.kernel_lookup_table_;
   initialized_ = lwr_model.initialized_;
   return *this;
 }
@@ -47,7 +71,13 @@ bool LWR::initialize(const LWRParamPtr parameters)
   // copy the content of parameters
   Logger::logPrintf(initialized_, "LWR model already initialized. Re-initializing...", Logger::WARN);
   assert(Utilities<LWRParameters>::assign(parameters_, parameters));
-  return (initialized_ = true);
+  initialized_ = true;
+  updateReceptiveFieldRevision();
+  if (use_kernel_lookup_table_ && !buildKernelLookupTable())
+  {
+    return (initialized_ = false);
+  }
+  return initialized_;
 }
 
 // REAL-TIME REQUIREMENTS
@@ -58,6 +88,119 @@ double LWR::evaluateKernel(const double x_input,
   return exp(-(static_cast<double> (1.0) / parameters_->widths_(center_index)) * pow(x_input - parameters_->centers_(center_index), 2));
 }
 
+// REAL-TIME REQUIREMENTS
+bool LWR::getLookupTableIndex(const double x_input,
+                              int& row_index,
+                              double& weight) const
+{
+  if (x_input < lookup_table_min_x_ || x_input > lookup_table_max_x_)
+  {
+    return false;
+  }
+  double t = (log(x_input) - lookup_table_log_min_x_) * lookup_table_inv_du_;
+  row_index = static_cast<int> (t);
+  if (row_index > kernel_lookup_table_.rows() - 2)
+  {
+    row_index = kernel_lookup_table_.rows() - 2;
+  }
+  weight = t - static_cast<double> (row_index);
+  return true;
+}
+
+bool LWR::buildKernelLookupTable()
+{
+  if (!initialized_)
+  {
+    Logger::logPrintf("Cannot build kernel lookup table, LWR model is not initialized.", Logger::ERROR);
+    return false;
+  }
+  const int num_samples = kernel_lookup_table_.rows();
+  assert(num_samples > 1);
+  kernel_lookup_table_.resize(num_samples, parameters_->centers_.size());
+  const double du = static_cast<double> (1.0) / lookup_table_inv_du_;
+
+  for (int i = 0; i < num_samples; ++i)
+  {
+    double x_input = exp(lookup_table_log_min_x_ + static_cast<double> (i) * du);
+    for (int j = 0; j < parameters_->centers_.size(); ++j)
+    {
+      kernel_lookup_table_(i, j) = evaluateKernel(x_input, j);
+    }
+  }
+
+  // the linear interpolation error within an interval of size du is bounded by du^2/8 * max|f''(u)| with
+  // f(u) = exp(-(x-c)^2/w), x = exp(u), and f''(u) = (4*(x-c)^2*x^2/w^2 - 2*(2*x-c)*x/w) * f(u). Within each
+  // interval [x0 x1] the kernel and both terms in brackets are bounded separately by their maximum over the interval.
+  double max_second_derivative = 0;
+  for (int i = 0; i < num_samples - 1; ++i)
+  {
+    double x0 = exp(lookup_table_log_min_x_ + static_cast<double> (i) * du);
+    double x1 = exp(lookup_table_log_min_x_ + static_cast<double> (i + 1) * du);
+    for (int j = 0; j < parameters_->centers_.size(); ++j)
+    {
+      double center = parameters_->centers_(j);
+      double width = parameters_->widths_(j);
+      double min_distance = 0;
+      if (center < x0)
+      {
+        min_distance = x0 - center;
+      }
+      else if (center > x1)
+      {
+        min_distance = center - x1;
+      }
+      double max_distance = std::max(fabs(x0 - center), fabs(x1 - center));
+      double max_kernel = exp(-(min_distance * min_distance) / width);
+      double max_bracket = static_cast<double> (4.0) * max_distance * max_distance * x1 * x1 / (width * width)
+          + static_cast<double> (2.0) * std::max(fabs(static_cast<double> (2.0) * x0 - center), fabs(static_cast<double> (2.0) * x1 - center)) * x1 / width;
+      double second_derivative = max_kernel * max_bracket;
+      if (second_derivative > max_second_derivative)
+      {
+        max_second_derivative = second_derivative;
+      }
+    }
+  }
+  lookup_table_error_bound_ = ((du * du) / static_cast<double> (8.0)) * max_second_derivative;
+  return true;
+}
+
+bool LWR::enableKernelLookupTable(const int num_samples,
+                                  const double min_x,
+                                  const double max_x)
+{
+  if (num_samples < 2)
+  {
+    Logger::logPrintf("Number of lookup table samples >%i< is invalid. It needs to be at least 2.", Logger::ERROR, num_samples);
+    return false;
+  }
+  if (min_x <= 0.0 || max_x <= min_x)
+  {
+    Logger::logPrintf("Lookup table range [%f %f] is invalid.", Logger::ERROR, min_x, max_x);
+    return false;
+  }
+  use_kernel_lookup_table_ = true;
+  lookup_table_min_x_ = min_x;
+  lookup_table_max_x_ = max_x;
+  lookup_table_log_min_x_ = log(min_x);
+  lookup_table_inv_du_ = static_cast<double> (num_samples - 1) / (log(max_x) - log(min_x));
+  kernel_lookup_table_.resize(num_samples, 1);
+  updateReceptiveFieldRevision();
+  if (!buildKernelLookupTable())
+  {
+    disableKernelLookupTable();
+    return false;
+  }
+  return true;
+}
+
+void LWR::disableKernelLookupTable()
+{
+  use_kernel_lookup_table_ = false;
+  lookup_table_error_bound_ = 0.0;
+  kernel_lookup_table_.resize(0, 0);
+  updateReceptiveFieldRevision();
+}
+
 bool LWR::generateBasisFunctionMatrix(const VectorXd& x_input_vector,
                                       MatrixXd& basis_function_matrix) const
 {
@@ -91,10 +234,22 @@ bool LWR::generateBasisFunctionVector(const double x_input, VectorXd& basis_func
     Logger::logPrintf("Size of provided basis function vector >%i< is incorrect, it should be of size >%i<.", Logger::ERROR, basis_functions.size(), parameters_->centers_.size());
     return false;
   }
-  for (int i = 0; i < parameters_->centers_.size(); ++i)
+  int row_index;
+  double weight;
+  if (use_kernel_lookup_table_ && getLookupTableIndex(x_input, row_index, weight))
+  {
+    basis_functions = ((static_cast<double> (1.0) - weight) * kernel_lookup_table_.row(row_index)
+        + weight * kernel_lookup_table_.row(row_index + 1)).transpose();
+  }
+  else
   {
-    basis_functions(i) = evaluateKernel(x_input, i);
+    // evaluate all kernels at once such that Eigen can vectorize it. The exponent is clamped such
+    // that exp does not need to take its slow underflow path for kernels far away from x_input
+    basis_functions = (-(x_input - parameters_->centers_.array()).square() / parameters_->widths_.array()).max(MIN_KERNEL_EXPONENT).exp().matrix();
   }
+  // kernels far away from x_input would otherwise end up as denormals which make every subsequent
+  // product (e.g. the dot product in predict) an order of magnitude slower. Their contribution is zero anyway.
+  basis_functions = (basis_functions.array() < numeric_limits<double>::min()).select(0.0, basis_functions.array()).matrix();
   return true;
 }
 
@@ -156,9 +311,20 @@ bool LWR::predict(const double x_query,
   assert(parameters_->initialized_);
   double sx = 0;
   double sxtd = 0;
+  int row_index = 0;
+  double weight = 0;
+  bool use_lookup_table = use_kernel_lookup_table_ && getLookupTableIndex(x_query, row_index, weight);
   for (int i = 0; i < parameters_->num_rfs_; i++)
   {
-    double psi = evaluateKernel(x_query, i);
+    double psi;
+    if (use_lookup_table)
+    {
+      psi = (static_cast<double> (1.0) - weight) * kernel_lookup_table_(row_index, i) + weight * kernel_lookup_table_(row_index + 1, i);
+    }
+    else
+    {
+      psi = evaluateKernel(x_query, i);
+    }
     sxtd += psi * parameters_->slopes_(i) * x_query;
     sx += psi;
   }
@@ -172,6 +338,37 @@ bool LWR::predict(const double x_query,
   return true;
 }
 
+// REAL-TIME REQUIREMENTS
+bool LWR::predict(const double x_query,
+                  const VectorXd& basis_functions,
+                  double& y_prediction) const
+{
+  assert(parameters_->initialized_);
+  assert(basis_functions.size() == parameters_->slopes_.size());
+  double sx = basis_functions.sum();
+  if (sx < 0.000000001 && sx > -0.000000001)
+  {
+    y_prediction = 0;
+    return false;
+  }
+  y_prediction = (x_query * parameters_->slopes_.dot(basis_functions)) / sx;
+  return true;
+}
+
+bool LWR::hasSameReceptiveFields(const LWR& lwr_model) const
+{
+  if (!initialized_ || !lwr_model.initialized_)
+  {
+    return false;
+  }
+  return (parameters_->centers_.size() == lwr_model.parameters_->centers_.size())
+      && (parameters_->centers_ == lwr_model.parameters_->centers_)
+      && (parameters_->widths_ == lwr_model.parameters_->widths_)
+      && (use_kernel_lookup_table_ == lwr_model.use_kernel_lookup_table_)
+      && (!use_kernel_lookup_table_ || ((kernel_lookup_table_.rows() == lwr_model.kernel_lookup_table_.rows())
+          && (lookup_table_min_x_ == lwr_model.lookup_table_min_x_) && (lookup_table_max_x_ == lwr_model.lookup_table_max_x_)));
+}
+
 bool LWR::getThetas(VectorXd& thetas) const
 {
   if (!initialized_)
@@ -230,7 +427,12 @@ bool LWR::setWidthsAndCenters(const VectorXd& widths,
     Logger::logPrintf("Cannot set widths and centers, LWR model is not initialized.", Logger::ERROR);
     return false;
   }
-  return parameters_->setWidthsAndCenters(widths, centers);
+  if (!parameters_->setWidthsAndCenters(widths, centers))
+  {
+    return false;
+  }
+  updateReceptiveFieldRevision();
+  return (!use_kernel_lookup_table_ || buildKernelLookupTable());
 }
 
 bool LWR::setWidthsAndCenters(const vector<double>& widths,
@@ -241,7 +443,12 @@ bool LWR::setWidthsAndCenters(const vector<double>& widths,
     Logger::logPrintf("Cannot set widths and centers, LWR model is not initialized.", Logger::ERROR);
     return false;
   }
-  return parameters_->setWidthsAndCenters(widths, centers);
+  if (!parameters_->setWidthsAndCenters(widths, centers))
+  {
+    return false;
+  }
+  updateReceptiveFieldRevision();
+  return (!use_kernel_lookup_table_ || buildKernelLookupTable());
 }
 
 bool LWR::getWidthsAndCenters(VectorXd& widths,
@@ -313,7 +520,12 @@ bool LWR::setNumRFS(const int num_rfs)
     Logger::logPrintf("Cannot set number of receptive fields, LWR model is not initialzed.", Logger::ERROR);
     return false;
   }
-  return parameters_->setNumRFS(num_rfs);
+  if (!parameters_->setNumRFS(num_rfs))
+  {
+    return false;
+  }
+  updateReceptiveFieldRevision();
+  return (!use_kernel_lookup_table_ || buildKernelLookupTable());
 }
 
 int LWR::getNumRFS() const
@@ -0,0 +1,88 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Measures the per call cost of LWR::predict with exact and
+            tabulated kernels.
+
+ \file		benchmark_locally_weighted_regression.cpp
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <stdio.h>
+#include <time.h>
+
+#include <Eigen/Core>
+
+// local includes
+#include <lwr_lib/lwr.h>
+#include <lwr_lib/logger.h>
+
+using namespace Eigen;
+using namespace lwr_lib;
+
+static double getTime()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<double> (t.tv_sec) + static_cast<double> (t.tv_nsec) * 1e-9;
+}
+
+static bool benchmark(const int num_rfs, const int num_queries, const bool use_lookup_table)
+{
+  LWRParamPtr params(new LWRParameters());
+  if (!params->initialize(num_rfs, 0.7, true))
+  {
+    Logger::logPrintf("Could not initialize lwr parameters.", Logger::ERROR);
+    return false;
+  }
+  LWR lwr;
+  if (!lwr.initialize(params))
+  {
+    Logger::logPrintf("Could not initialize LWR model.", Logger::ERROR);
+    return false;
+  }
+  if (!lwr.setThetas(VectorXd::Ones(num_rfs)))
+  {
+    return false;
+  }
+  if (use_lookup_table && !lwr.enableKernelLookupTable())
+  {
+    Logger::logPrintf("Could not enable kernel lookup table.", Logger::ERROR);
+    return false;
+  }
+
+  double sum = 0;
+  double dx = static_cast<double> (1.0) / static_cast<double> (num_queries - 1);
+  double start_time = getTime();
+  for (int i = 0; i < num_queries; ++i)
+  {
+    double y_prediction = 0;
+    lwr.predict(static_cast<double> (i) * dx, y_prediction);
+    sum += y_prediction;
+  }
+  double duration = getTime() - start_time;
+
+  printf("num_rfs: %4i  lookup table: %3s  per call: %8.1f ns  (error bound: %.2e, checksum: %f)\n", num_rfs, use_lookup_table ? "yes" : "no",
+         (duration / static_cast<double> (num_queries)) * 1e9, lwr.getKernelLookupTableErrorBound(), sum);
+  return true;
+}
+
+int main()
+{
+  const int num_queries = 1000000;
+  const int num_rfs[] = {10, 50, 100, 200};
+  for (int i = 0; i < static_cast<int> (sizeof(num_rfs) / sizeof(num_rfs[0])); ++i)
+  {
+    if (!benchmark(num_rfs[i], num_queries, false) || !benchmark(num_rfs[i], num_queries, true))
+    {
+      return -1;
+    }
+  }
+  return 0;
+}
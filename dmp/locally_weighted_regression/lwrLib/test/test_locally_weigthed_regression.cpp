@@ -14,6 +14,7 @@
 
 // system includes
 #include <stdio.h>
+#include <math.h>
 #include <time.h>
 #include <iostream>
 #include <fstream>
@@ -44,6 +45,10 @@ public:
 
   bool testLearning();
 
+  bool testSharedBasisFunctionPrediction();
+
+  bool testKernelLookupTable();
+
   double targetFunction(const double test_x);
 
 private:
@@ -168,6 +173,149 @@ bool LWRTest::testLearning()
   return true;
 }
 
+bool LWRTest::testSharedBasisFunctionPrediction()
+{
+  int num_data_query = 2000;
+  double max_prediction_error = 1e-10;
+
+  LWRPtr other_lwr(new LWR());
+  LWRParamPtr other_params(new LWRParameters());
+  *other_params = *params_;
+  if (!other_lwr->initialize(other_params))
+  {
+    Logger::logPrintf("Could not initialize second LWR model.", Logger::ERROR);
+    return false;
+  }
+  if (!lwr_->hasSameReceptiveFields(*other_lwr))
+  {
+    Logger::logPrintf("LWR models do not share the same receptive fields.", Logger::ERROR);
+    return false;
+  }
+
+  VectorXd basis_functions = VectorXd::Zero(lwr_->getNumRFS());
+  double dx = static_cast<double> (1.0) / (num_data_query - 1);
+  for (int i = 0; i < num_data_query; i++)
+  {
+    double x_query = i * dx;
+    double y_prediction = 0;
+    double y_shared_prediction = 0;
+    if (!lwr_->predict(x_query, y_prediction)
+        || !lwr_->generateBasisFunctionVector(x_query, basis_functions)
+        || !lwr_->predict(x_query, basis_functions, y_shared_prediction))
+    {
+      Logger::logPrintf("Could not predict from LWR model.", Logger::ERROR);
+      return false;
+    }
+    if (fabs(y_prediction - y_shared_prediction) > max_prediction_error)
+    {
+      Logger::logPrintf("Prediction from shared basis functions >%f< differs from prediction >%f<.", Logger::ERROR, y_shared_prediction, y_prediction);
+      return false;
+    }
+  }
+
+  Logger::logPrintf("Test finished successfully.", Logger::INFO);
+  return true;
+}
+
+bool LWRTest::testKernelLookupTable()
+{
+  int num_lookup_table_samples = 10000;
+  int num_data_query = 7919;
+  double max_prediction_error = 1e-4;
+
+  LWRPtr exact_lwr(new LWR());
+  *exact_lwr = *lwr_;
+  if (!lwr_->enableKernelLookupTable(num_lookup_table_samples))
+  {
+    Logger::logPrintf("Could not enable kernel lookup table.", Logger::ERROR);
+    return false;
+  }
+  double error_bound = lwr_->getKernelLookupTableErrorBound();
+
+  VectorXd basis_functions = VectorXd::Zero(lwr_->getNumRFS());
+  double dx = static_cast<double> (1.0) / (num_data_query - 1);
+  for (int i = 0; i < num_data_query; i++)
+  {
+    double x_query = i * dx;
+    if (!lwr_->generateBasisFunctionVector(x_query, basis_functions))
+    {
+      Logger::logPrintf("Could not generate basis functions from lookup table.", Logger::ERROR);
+      return false;
+    }
+    for (int j = 0; j < lwr_->getNumRFS(); ++j)
+    {
+      double exact_basis_function = 0;
+      if (!exact_lwr->generateBasisFunction(x_query, j, exact_basis_function))
+      {
+        Logger::logPrintf("Could not generate basis function.", Logger::ERROR);
+        return false;
+      }
+      if (fabs(basis_functions(j) - exact_basis_function) > error_bound)
+      {
+        Logger::logPrintf("Tabulated basis function >%f< exceeds error bound >%e< (exact value is >%f<).", Logger::ERROR,
+                          basis_functions(j), error_bound, exact_basis_function);
+        return false;
+      }
+    }
+
+    double y_prediction = 0;
+    double y_exact_prediction = 0;
+    if (!lwr_->predict(x_query, y_prediction) || !exact_lwr->predict(x_query, y_exact_prediction))
+    {
+      Logger::logPrintf("Could not predict from LWR model.", Logger::ERROR);
+      return false;
+    }
+    if (fabs(y_prediction - y_exact_prediction) > max_prediction_error)
+    {
+      Logger::logPrintf("Prediction from lookup table >%f< differs from exact prediction >%f<.", Logger::ERROR, y_prediction, y_exact_prediction);
+      return false;
+    }
+  }
+
+  // dense sweep within every interval of a coarse table, the largest error needs to stay below the error bound
+  int num_coarse_samples = 200;
+  int num_queries_per_interval = 16;
+  double min_x = 0.001;
+  double max_x = 1.0;
+  if (!lwr_->enableKernelLookupTable(num_coarse_samples, min_x, max_x))
+  {
+    Logger::logPrintf("Could not enable coarse kernel lookup table.", Logger::ERROR);
+    return false;
+  }
+  error_bound = lwr_->getKernelLookupTableErrorBound();
+  double max_error = 0;
+  double du = (log(max_x) - log(min_x)) / (num_coarse_samples - 1);
+  for (int i = 0; i < (num_coarse_samples - 1) * num_queries_per_interval; i++)
+  {
+    double x_query = exp(log(min_x) + (static_cast<double> (i) / num_queries_per_interval) * du);
+    if (!lwr_->generateBasisFunctionVector(x_query, basis_functions))
+    {
+      Logger::logPrintf("Could not generate basis functions from coarse lookup table.", Logger::ERROR);
+      return false;
+    }
+    for (int j = 0; j < lwr_->getNumRFS(); ++j)
+    {
+      double exact_basis_function = 0;
+      if (!exact_lwr->generateBasisFunction(x_query, j, exact_basis_function))
+      {
+        Logger::logPrintf("Could not generate basis function.", Logger::ERROR);
+        return false;
+      }
+      max_error = std::max(max_error, fabs(basis_functions(j) - exact_basis_function));
+    }
+  }
+  Logger::logPrintf("Largest error of the coarse lookup table is >%e<, error bound is >%e<.", Logger::INFO, max_error, error_bound);
+  if (max_error > error_bound)
+  {
+    Logger::logPrintf("Largest error >%e< of the coarse lookup table exceeds error bound >%e<.", Logger::ERROR, max_error, error_bound);
+    return false;
+  }
+
+  lwr_->disableKernelLookupTable();
+  Logger::logPrintf("Test finished successfully.", Logger::INFO);
+  return true;
+}
+
 int main()
 {
   LWRTest lwr_test;
@@ -175,7 +323,7 @@ int main()
   {
     return -1;
   }
-  if (lwr_test.testLearning())
+  if (lwr_test.testLearning() && lwr_test.testSharedBasisFunctionPrediction() && lwr_test.testKernelLookupTable())
   {
     return -1;
   }
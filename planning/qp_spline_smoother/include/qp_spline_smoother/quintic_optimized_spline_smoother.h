@@ -11,6 +11,7 @@
 #include <spline_smoother/spline_smoother.h>
 #include <spline_smoother/spline_smoother_utils.h>
 #include <quadprog/QuadProg++.hh>
+#include <vector>
 
 namespace qp_spline_smoother
 {
@@ -35,10 +36,13 @@ private:
   };
 
   std::vector<double> cost_function_weights_;
+  // if positive, the trajectory is optimized in overlapping chunks using QuadProg++, otherwise as a whole
   int chunk_size_;
   double min_dt_;
 
+  void computeSegmentCost(const double duration, double cost[5][5]) const;
   bool optimize(const double *x, double *xd, double *xdd, double *t, int length) const;
+  bool optimizeBanded(const double *x, double *xd, double *xdd, const double *t, int length) const;
   bool numericalDifferentiation(const T& trajectory_in, T& trajectory_out) const;
   double weightedAvg(double w1, double v1, double w2, double v2) const;
 
@@ -51,7 +55,7 @@ QuinticOptimizedSplineSmoother<T>::QuinticOptimizedSplineSmoother()
   cost_function_weights_[MIN_VEL]=0.0;
   cost_function_weights_[MIN_ACC]=1.0;
   cost_function_weights_[MIN_JERK]=0.0;
-  chunk_size_=10;
+  chunk_size_=0;
   min_dt_ = 0.01;
 }
 
@@ -77,7 +81,7 @@ bool QuinticOptimizedSplineSmoother<T>::configure()
   ROS_INFO("velocity cost = %f", cost_function_weights_[MIN_VEL]);
   ROS_INFO("acceleration cost = %f", cost_function_weights_[MIN_ACC]);
   ROS_INFO("jerk cost = %f", cost_function_weights_[MIN_JERK]);
-  ROS_INFO("chunk size = %d", chunk_size_);
+  ROS_INFO("chunk size = %d (0 optimizes the whole trajectory at once)", chunk_size_);
   ROS_INFO("min_dt = %f", min_dt_);
   
   for (int i=0; i<NUM_WEIGHTS; ++i)
@@ -177,7 +181,33 @@ bool QuinticOptimizedSplineSmoother<T>::smooth(const T& trajectory_in, T& trajec
   // initialize with numerical differentiation
   numericalDifferentiation(trajectory_out, trajectory_out);
 
-  if (size>=3)
+  if (size>=3 && chunk_size_<=0)
+  {
+    // optimize the whole trajectory at once
+#pragma omp parallel for
+    for (int j = 0; j < num_traj; ++j)
+    {
+      std::vector<double> x(size), xd(size), xdd(size), t(size);
+      for (int i=0; i<size; ++i)
+      {
+        x[i] = trajectory_out.trajectory.points[i].positions[j];
+        xd[i] = trajectory_out.trajectory.points[i].velocities[j];
+        xdd[i] = trajectory_out.trajectory.points[i].accelerations[j];
+        t[i] = trajectory_out.trajectory.points[i].time_from_start.toSec();
+      }
+      if (!optimizeBanded(&x[0], &xd[0], &xdd[0], &t[0], size))
+        qp_success = false;
+      else
+      {
+        for (int i=1; i<size-1; ++i)
+        {
+          trajectory_out.trajectory.points[i].velocities[j] = xd[i];
+          trajectory_out.trajectory.points[i].accelerations[j] = xdd[i];
+        }
+      }
+    }
+  }
+  else if (size>=3)
   {
     // optimize in chunks
 #pragma omp parallel for
@@ -261,6 +291,87 @@ bool QuinticOptimizedSplineSmoother<T>::smooth(const T& trajectory_in, T& trajec
   return success;
 }
 
+template<typename T>
+void QuinticOptimizedSplineSmoother<T>::computeSegmentCost(const double duration, double cost[5][5]) const
+{
+  // dt and powers of dt
+  double dt[10];
+  dt[1] = duration;
+  for (int j = 2; j <= 9; j++)
+  {
+    dt[j] = dt[j - 1] * dt[1];
+  }
+
+  for (int i = 0; i < 5; i++)
+  {
+    for (int j = 0; j < 5; j++)
+    {
+      cost[i][j] = 0.0;
+    }
+  }
+
+  const int a = 0;
+  const int b = 1;
+  const int c = 2;
+  const int d = 3;
+  const int e = 4;
+  if (cost_function_weights_[MIN_VEL] > 0.0)
+  {
+    double w = cost_function_weights_[MIN_VEL];
+    cost[a][a] = (25.0 / 9.0) * dt[9] * w;
+    cost[a][b] = cost[b][a] = (5.0 / 2.0) * dt[8] * w;
+    cost[a][c] = cost[c][a] = ((30.0 / 7.0) / 2.0) * dt[7] * w;
+    cost[b][b] = (16.0 / 7.0) * dt[7] * w;
+    cost[a][d] = cost[d][a] = ((20.0 / 6.0) / 2.0) * dt[6] * w;
+    cost[c][b] = cost[b][c] = ((24.0 / 6.0) / 2.0) * dt[6] * w;
+    cost[a][e] = cost[e][a] = ((10.0 / 5.0) / 2.0) * dt[5] * w;
+    cost[b][d] = cost[d][b] = ((16.0 / 5.0) / 2.0) * dt[5] * w;
+    cost[c][c] = (9.0 / 5.0) * dt[5] * w;
+    cost[b][e] = cost[e][b] = ((8.0 / 4.0) / 2.0) * dt[4] * w;
+    cost[c][d] = cost[d][c] = ((12.0 / 4.0) / 2.0) * dt[4] * w;
+    cost[c][e] = cost[e][c] = ((6.0 / 3.0) / 2.0) * dt[3] * w;
+    cost[d][d] = (4.0 / 3.0) * dt[3] * w;
+    cost[d][e] = cost[e][d] = dt[2] * w;
+    cost[e][e] = dt[1] * w;
+  }
+  if (cost_function_weights_[MIN_ACC] > 0.0)
+  {
+    double w = cost_function_weights_[MIN_ACC];
+    cost[a][a] += (400.0 / 7.0) * dt[7] * w;
+    cost[a][b] += (80.0 / 2.0) * dt[6] * w;
+    cost[b][a] += (80.0 / 2.0) * dt[6] * w;
+    cost[b][b] += (144.0 / 5.0) * dt[5] * w;
+    cost[a][c] += ((240.0 / 5.0) / 2.0) * dt[5] * w;
+    cost[c][a] += ((240.0 / 5.0) / 2.0) * dt[5] * w;
+    cost[c][b] += ((144.0 / 4.0) / 2.0) * dt[4] * w;
+    cost[b][c] += ((144.0 / 4.0) / 2.0) * dt[4] * w;
+    cost[a][d] += ((80.0 / 4.0) / 2.0) * dt[4] * w;
+    cost[d][a] += ((80.0 / 4.0) / 2.0) * dt[4] * w;
+    cost[b][d] += ((48.0 / 3.0) / 2.0) * dt[3] * w;
+    cost[d][b] += ((48.0 / 3.0) / 2.0) * dt[3] * w;
+    cost[c][c] += (36.0 / 3.0) * dt[3] * w;
+    cost[c][d] += ((12.0) / 2.0) * dt[2] * w;
+    cost[d][c] += ((12.0) / 2.0) * dt[2] * w;
+    cost[d][d] += (4.0) * dt[1] * w;
+    cost[e][e] += 10e-10 * w;
+  }
+  if (cost_function_weights_[MIN_JERK] > 0.0)
+  {
+    double w = cost_function_weights_[MIN_JERK];
+    cost[a][a] += (720) * dt[5] * w;
+    cost[a][b] += (720.0 / 2.0) * dt[4] * w;
+    cost[b][a] += (720.0 / 2.0) * dt[4] * w;
+    cost[a][c] += ((720.0 / 3.0) / 2.0) * dt[3] * w;
+    cost[c][a] += ((720.0 / 3.0) / 2.0) * dt[3] * w;
+    cost[b][b] += (576.0 / 3.0) * dt[3] * w;
+    cost[c][b] += ((144.0) / 2.0) * dt[2] * w;
+    cost[b][c] += ((144.0) / 2.0) * dt[2] * w;
+    cost[c][c] += (36.0) * dt[1] * w;
+    cost[d][d] += 10e-10 * w;
+    cost[e][e] += 10e-10 * w;
+  }
+}
+
 template<typename T>
 bool QuinticOptimizedSplineSmoother<T>::optimize(const double *x, double *xd, double *xdd, double *t, int length) const
 {
@@ -307,84 +418,16 @@ bool QuinticOptimizedSplineSmoother<T>::optimize(const double *x, double *xd, do
   }
 
   // construct the quadratic cost matrix:
-
-  if (cost_function_weights_[MIN_VEL] > 0.0)
+  double segment_cost[5][5];
+  for (int i = 0; i < numSegments; i++)
   {
-    double w = cost_function_weights_[MIN_VEL];
-    for (int i = 0; i < numSegments; i++)
+    computeSegmentCost(dt[i][1], segment_cost);
+    for (int r = 0; r < 5; r++)
     {
-      int a = i * 5;
-      int b = i * 5 + 1;
-      int c = i * 5 + 2;
-      int d = i * 5 + 3;
-      int e = i * 5 + 4;
-      quadCost[a][a] = (25.0 / 9.0) * dt[i][9] * w;
-      quadCost[a][b] = quadCost[b][a] = (5.0 / 2.0) * dt[i][8] * w;
-      quadCost[a][c] = quadCost[c][a] = ((30.0 / 7.0) / 2.0) * dt[i][7] * w;
-      quadCost[b][b] = (16.0 / 7.0) * dt[i][7] * w;
-      quadCost[a][d] = quadCost[d][a] = ((20.0 / 6.0) / 2.0) * dt[i][6] * w;
-      quadCost[c][b] = quadCost[b][c] = ((24.0 / 6.0) / 2.0) * dt[i][6] * w;
-      quadCost[a][e] = quadCost[e][a] = ((10.0 / 5.0) / 2.0) * dt[i][5] * w;
-      quadCost[b][d] = quadCost[d][b] = ((16.0 / 5.0) / 2.0) * dt[i][5] * w;
-      quadCost[c][c] = (9.0 / 5.0) * dt[i][5] * w;
-      quadCost[b][e] = quadCost[e][b] = ((8.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[c][d] = quadCost[d][c] = ((12.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[c][e] = quadCost[e][c] = ((6.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[d][d] = (4.0 / 3.0) * dt[i][3] * w;
-      quadCost[d][e] = quadCost[e][d] = dt[i][2] * w;
-      quadCost[e][e] = dt[i][1] * w;
-    }
-  }
-  if (cost_function_weights_[MIN_ACC] > 0.0)
-  {
-    double w = cost_function_weights_[MIN_ACC];
-    for (int i = 0; i < numSegments; i++)
-    {
-      int a = i * 5;
-      int b = i * 5 + 1;
-      int c = i * 5 + 2;
-      int d = i * 5 + 3;
-      int e = i * 5 + 4;
-      quadCost[a][a] += (400.0 / 7.0) * dt[i][7] * w;
-      quadCost[a][b] += (80.0 / 2.0) * dt[i][6] * w;
-      quadCost[b][a] += (80.0 / 2.0) * dt[i][6] * w;
-      quadCost[b][b] += (144.0 / 5.0) * dt[i][5] * w;
-      quadCost[a][c] += ((240.0 / 5.0) / 2.0) * dt[i][5] * w;
-      quadCost[c][a] += ((240.0 / 5.0) / 2.0) * dt[i][5] * w;
-      quadCost[c][b] += ((144.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[b][c] += ((144.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[a][d] += ((80.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[d][a] += ((80.0 / 4.0) / 2.0) * dt[i][4] * w;
-      quadCost[b][d] += ((48.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[d][b] += ((48.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[c][c] += (36.0 / 3.0) * dt[i][3] * w;
-      quadCost[c][d] += ((12.0) / 2.0) * dt[i][2] * w;
-      quadCost[d][c] += ((12.0) / 2.0) * dt[i][2] * w;
-      quadCost[d][d] += (4.0) * dt[i][1] * w;
-      quadCost[e][e] += 10e-10 * w;
-    }
-  }
-  if (cost_function_weights_[MIN_JERK] > 0.0)
-  {
-    double w = cost_function_weights_[MIN_JERK];
-    for (int i = 0; i < numSegments; i++)
-    {
-      int a = i * 5;
-      int b = i * 5 + 1;
-      int c = i * 5 + 2;
-      int d = i * 5 + 3;
-      int e = i * 5 + 4;
-      quadCost[a][a] += (720) * dt[i][5] * w;
-      quadCost[a][b] += (720.0 / 2.0) * dt[i][4] * w;
-      quadCost[b][a] += (720.0 / 2.0) * dt[i][4] * w;
-      quadCost[a][c] += ((720.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[c][a] += ((720.0 / 3.0) / 2.0) * dt[i][3] * w;
-      quadCost[b][b] += (576.0 / 3.0) * dt[i][3] * w;
-      quadCost[c][b] += ((144.0) / 2.0) * dt[i][2] * w;
-      quadCost[b][c] += ((144.0) / 2.0) * dt[i][2] * w;
-      quadCost[c][c] += (36.0) * dt[i][1] * w;
-      quadCost[d][d] += 10e-10 * w;
-      quadCost[e][e] += 10e-10 * w;
+      for (int c = 0; c < 5; c++)
+      {
+        quadCost[i * 5 + r][i * 5 + c] = segment_cost[r][c];
+      }
     }
   }
 
@@ -521,6 +564,166 @@ bool QuinticOptimizedSplineSmoother<T>::optimize(const double *x, double *xd, do
   return true;
 }
 
+template<typename T>
+bool QuinticOptimizedSplineSmoother<T>::optimizeBanded(const double *x, double *xd, double *xdd, const double *t, int length) const
+{
+  // Each segment is parameterized by the velocities and accelerations at both of its ends, i.e. it is the quintic
+  // that interpolates x, xd and xdd at its knots. This eliminates the equality constraints of optimize(): the cost
+  // becomes a quadratic in the knot states s_k = [xd_k xdd_k] whose Hessian is block tridiagonal with 2x2 blocks.
+  // It is solved by block forward elimination and back substitution, i.e. in linear time.
+  int numSegments = length - 1;
+  ROS_ASSERT(numSegments >= 2);
+
+  // 2x2 blocks are stored row major: diagonal[k] = H(k,k), upper[k] = H(k,k+1)
+  std::vector<double> diagonal(length * 4, 0.0);
+  std::vector<double> upper(numSegments * 4, 0.0);
+  std::vector<double> gradient(length * 2, 0.0);
+
+  double segment_cost[5][5];
+  for (int i = 0; i < numSegments; i++)
+  {
+    double h = t[i + 1] - t[i];
+    double h2 = h * h;
+    double h3 = h2 * h;
+    double h4 = h3 * h;
+    double h5 = h4 * h;
+    computeSegmentCost(h, segment_cost);
+
+    // the remaining end position, velocity and acceleration r = R * [xd_i xdd_i xd_i+1 xdd_i+1] + r0 that
+    // the coefficients a, b and c have to make up for
+    const double R[3][4] = {{-h, -0.5 * h2, 0.0, 0.0}, {-1.0, -h, 1.0, 0.0}, {0.0, -1.0, 0.0, 1.0}};
+    const double r0[3] = {x[i + 1] - x[i], 0.0, 0.0};
+    const double C[3][3] = {{6.0 / h5, -3.0 / h4, 0.5 / h3}, {-15.0 / h4, 7.0 / h3, -1.0 / h2}, {10.0 / h3, -4.0 / h2, 0.5 / h}};
+
+    // coefficients [a b c d e] = M * [xd_i xdd_i xd_i+1 xdd_i+1] + m
+    double M[5][4] = {{0.0}};
+    double m[5] = {0.0};
+    for (int r = 0; r < 3; r++)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        m[r] += C[r][k] * r0[k];
+        for (int c = 0; c < 4; c++)
+        {
+          M[r][c] += C[r][k] * R[k][c];
+        }
+      }
+    }
+    M[3][1] = 0.5; // d = xdd_i / 2
+    M[4][0] = 1.0; // e = xd_i
+
+    // segment Hessian M^T Q M and gradient M^T Q m
+    double QM[5][4];
+    double Qm[5];
+    for (int r = 0; r < 5; r++)
+    {
+      Qm[r] = 0.0;
+      for (int c = 0; c < 4; c++)
+      {
+        QM[r][c] = 0.0;
+      }
+      for (int k = 0; k < 5; k++)
+      {
+        Qm[r] += segment_cost[r][k] * m[k];
+        for (int c = 0; c < 4; c++)
+        {
+          QM[r][c] += segment_cost[r][k] * M[k][c];
+        }
+      }
+    }
+    for (int r = 0; r < 4; r++)
+    {
+      double g = 0.0;
+      for (int k = 0; k < 5; k++)
+      {
+        g += M[k][r] * Qm[k];
+      }
+      gradient[(i + r / 2) * 2 + r % 2] += g;
+      for (int c = 0; c < 4; c++)
+      {
+        double value = 0.0;
+        for (int k = 0; k < 5; k++)
+        {
+          value += M[k][r] * QM[k][c];
+        }
+        if (r / 2 == c / 2)
+          diagonal[(i + r / 2) * 4 + (r % 2) * 2 + c % 2] += value;
+        else if (r < 2)
+          upper[i * 4 + r * 2 + (c - 2)] += value;
+      }
+    }
+  }
+
+  // the states of the first and last knot are fixed
+  std::vector<double> rhs(length * 2, 0.0);
+  for (int k = 1; k < length - 1; k++)
+  {
+    rhs[k * 2] = -gradient[k * 2];
+    rhs[k * 2 + 1] = -gradient[k * 2 + 1];
+  }
+  const double *u = &upper[0];
+  rhs[2] -= u[0] * xd[0] + u[2] * xdd[0];
+  rhs[3] -= u[1] * xd[0] + u[3] * xdd[0];
+  u = &upper[(length - 2) * 4];
+  rhs[(length - 2) * 2] -= u[0] * xd[length - 1] + u[1] * xdd[length - 1];
+  rhs[(length - 2) * 2 + 1] -= u[2] * xd[length - 1] + u[3] * xdd[length - 1];
+
+  // forward elimination, the inverses of the reduced diagonal blocks are kept for the back substitution
+  std::vector<double> inverse(length * 4, 0.0);
+  for (int k = 1; k < length - 1; k++)
+  {
+    double *D = &diagonal[k * 4];
+    double *y = &rhs[k * 2];
+    if (k > 1)
+    {
+      // L = U(k-1)^T * inv(D(k-1))
+      const double *U = &upper[(k - 1) * 4];
+      const double *I = &inverse[(k - 1) * 4];
+      double L[4];
+      L[0] = U[0] * I[0] + U[2] * I[2];
+      L[1] = U[0] * I[1] + U[2] * I[3];
+      L[2] = U[1] * I[0] + U[3] * I[2];
+      L[3] = U[1] * I[1] + U[3] * I[3];
+      D[0] -= L[0] * U[0] + L[1] * U[2];
+      D[1] -= L[0] * U[1] + L[1] * U[3];
+      D[2] -= L[2] * U[0] + L[3] * U[2];
+      D[3] -= L[2] * U[1] + L[3] * U[3];
+      const double *y_previous = &rhs[(k - 1) * 2];
+      y[0] -= L[0] * y_previous[0] + L[1] * y_previous[1];
+      y[1] -= L[2] * y_previous[0] + L[3] * y_previous[1];
+    }
+    // a symmetric 2x2 pivot block is positive definite iff its diagonal and its determinant are positive
+    double determinant = D[0] * D[3] - D[1] * D[2];
+    if (!(D[0] > 0.0) || !(D[3] > 0.0) || !(determinant > 0.0))
+    {
+      ROS_ERROR("QuinticOptimizedSplineSmoother: Hessian is not positive definite!");
+      return false;
+    }
+    double *I = &inverse[k * 4];
+    I[0] = D[3] / determinant;
+    I[1] = -D[1] / determinant;
+    I[2] = -D[2] / determinant;
+    I[3] = D[0] / determinant;
+  }
+
+  // back substitution
+  for (int k = length - 2; k >= 1; k--)
+  {
+    double y0 = rhs[k * 2];
+    double y1 = rhs[k * 2 + 1];
+    if (k < length - 2)
+    {
+      const double *U = &upper[k * 4];
+      y0 -= U[0] * xd[k + 1] + U[1] * xdd[k + 1];
+      y1 -= U[2] * xd[k + 1] + U[3] * xdd[k + 1];
+    }
+    const double *I = &inverse[k * 4];
+    xd[k] = I[0] * y0 + I[1] * y1;
+    xdd[k] = I[2] * y0 + I[3] * y1;
+  }
+  return true;
+}
+
 }
 
 #endif /* QUINTIC_OPTIMIZED_SPLINE_SMOOTHER_H_ */
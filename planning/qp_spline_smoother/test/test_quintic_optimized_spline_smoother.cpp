@@ -0,0 +1,109 @@
+/*
+ * test_quintic_optimized_spline_smoother.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: kalakris
+ */
+
+#include <gtest/gtest.h>
+#include <qp_spline_smoother/quintic_optimized_spline_smoother.h>
+#include <motion_planning_msgs/FilterJointTrajectoryWithConstraints.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+typedef motion_planning_msgs::FilterJointTrajectoryWithConstraints::Request Trajectory;
+
+/**
+ * Sets the filter parameters that are otherwise read from the parameter server
+ */
+class TestSmoother : public qp_spline_smoother::QuinticOptimizedSplineSmoother<Trajectory>
+{
+public:
+  bool configure(const double velocity_cost, const double acceleration_cost, const double jerk_cost, const int chunk_size)
+  {
+    params_["velocity_cost"] = velocity_cost;
+    params_["acceleration_cost"] = acceleration_cost;
+    params_["jerk_cost"] = jerk_cost;
+    params_["chunk_size"] = chunk_size;
+    return qp_spline_smoother::QuinticOptimizedSplineSmoother<Trajectory>::configure();
+  }
+};
+
+static void createTrajectory(const int num_points, const int num_joints, const bool uniform, Trajectory& trajectory)
+{
+  trajectory.trajectory.joint_names.clear();
+  trajectory.trajectory.points.clear();
+  for (int j = 0; j < num_joints; ++j)
+  {
+    std::stringstream ss;
+    ss << "joint_" << j;
+    trajectory.trajectory.joint_names.push_back(ss.str());
+  }
+  trajectory.trajectory.points.resize(num_points);
+  double time = 0.0;
+  for (int i = 0; i < num_points; ++i)
+  {
+    if (i > 0)
+      time += uniform ? 0.05 : 0.05 + 0.05 * (rand() / (double)RAND_MAX);
+    trajectory.trajectory.points[i].time_from_start = ros::Duration(time);
+    trajectory.trajectory.points[i].positions.resize(num_joints);
+    trajectory.trajectory.points[i].velocities.resize(num_joints, 0.0);
+    trajectory.trajectory.points[i].accelerations.resize(num_joints, 0.0);
+    for (int j = 0; j < num_joints; ++j)
+    {
+      trajectory.trajectory.points[i].positions[j] = sin((j + 1) * time) + 0.1 * j * (rand() / (double)RAND_MAX);
+    }
+  }
+}
+
+/**
+ * Smooths the trajectory with the banded solver (chunk_size 0) and with QuadProg++ in a single chunk,
+ * i.e. both solve the same quadratic program
+ */
+static void testBandedMatchesQuadProg(const double velocity_cost, const double acceleration_cost, const double jerk_cost,
+                                      const int num_points, const bool uniform)
+{
+  srand(num_points);
+  Trajectory trajectory;
+  createTrajectory(num_points, 3, uniform, trajectory);
+
+  TestSmoother banded_smoother;
+  ASSERT_TRUE(banded_smoother.configure(velocity_cost, acceleration_cost, jerk_cost, 0));
+  Trajectory banded_trajectory;
+  ASSERT_TRUE(banded_smoother.smooth(trajectory, banded_trajectory));
+
+  TestSmoother quadprog_smoother;
+  ASSERT_TRUE(quadprog_smoother.configure(velocity_cost, acceleration_cost, jerk_cost, num_points));
+  Trajectory quadprog_trajectory;
+  ASSERT_TRUE(quadprog_smoother.smooth(trajectory, quadprog_trajectory));
+
+  ASSERT_EQ(quadprog_trajectory.trajectory.points.size(), banded_trajectory.trajectory.points.size());
+  for (int i = 0; i < num_points; ++i)
+  {
+    for (int j = 0; j < int(trajectory.trajectory.joint_names.size()); ++j)
+    {
+      double velocity = quadprog_trajectory.trajectory.points[i].velocities[j];
+      double acceleration = quadprog_trajectory.trajectory.points[i].accelerations[j];
+      EXPECT_NEAR(velocity, banded_trajectory.trajectory.points[i].velocities[j], 1e-6 * std::max(1.0, fabs(velocity)));
+      EXPECT_NEAR(acceleration, banded_trajectory.trajectory.points[i].accelerations[j], 1e-6 * std::max(1.0, fabs(acceleration)));
+    }
+  }
+}
+
+TEST(QuinticOptimizedSplineSmoother, bandedMatchesQuadProg)
+{
+  testBandedMatchesQuadProg(0.0, 1.0, 0.0, 3, true);
+  testBandedMatchesQuadProg(0.0, 1.0, 0.0, 40, false);
+  testBandedMatchesQuadProg(0.5, 1.0, 0.0, 40, false);
+  testBandedMatchesQuadProg(0.0, 0.0, 1.0, 40, false);
+  testBandedMatchesQuadProg(0.0, 0.0, 1.0, 25, true);
+}
+
+int main(int argc, char** argv)
+{
+  ros::Time::init();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -184,8 +184,17 @@ private:
 
     std::vector<Eigen::VectorXd> parameters_all_;
 
-    std::vector<Eigen::MatrixXd> differentiation_matrices_;
-    void createDifferentiationMatrices();
+    // differentiation stencils scaled by the time step, these are the rows of the (banded) differentiation matrices
+    double differentiation_rules_[NUM_DIFF_RULES][DIFF_RULE_LENGTH];
+
+    // buffers for computeControlCosts
+    Eigen::VectorXd tmp_parameters_all_;
+    Eigen::VectorXd tmp_costs_all_;
+    void createDifferentiationRules();
+    /**
+     * Adds weight * derivative_cost * derivative^2 of all differentiation rules to costs_all, in O(num_vars_all)
+     */
+    void addDerivativeCosts(const Eigen::VectorXd& params_all, const double weight, Eigen::VectorXd& costs_all) const;
     bool readParameters();
     bool initializeVariables();
     bool initializeCosts();
@@ -86,6 +86,23 @@ class StompCollisionSpace
 //   };
 
 public:
+
+  /**
+   * \brief Scratch space of getCollisionPointPotentialGradients(), one per calling thread
+   */
+  struct CollisionPointQuery
+  {
+    int index;                    /**< Index of the collision point */
+    int cell;                     /**< Linear index of the lower corner voxel, -1 if outside of the field */
+    int x, y, z;                  /**< Lower corner voxel */
+    double fx, fy, fz;            /**< Position inside the voxel cube, in [0, 1) */
+
+    bool operator<(const CollisionPointQuery& other) const
+    {
+      return cell < other.cell;
+    }
+  };
+
   StompCollisionSpace();
   virtual ~StompCollisionSpace();
 
@@ -122,6 +139,19 @@ public:
 
   inline void gridToWorld(btVector3 origin, int gx, int gy, int gz, double &wx, double &wy, double &wz) const;
 
+  /**
+   * \brief Computes potentials and gradients of all collision points of one time step at once
+   *
+   * The points are visited in the memory order of the voxels they fall into, and the distance is trilinearly
+   * interpolated between the eight surrounding voxels.
+   *
+   * \return true if any of the points is in collision
+   */
+  bool getCollisionPointPotentialGradients(const std::vector<StompCollisionPoint>& collision_points,
+      const std::vector<KDL::Vector>& collision_point_pos, std::vector<double>& potentials,
+      std::vector<Eigen::Vector3d>& gradients, std::vector<int>& point_is_in_collision,
+      std::vector<CollisionPointQuery>& queries) const;
+
   template<typename Derived, typename DerivedOther>
   bool getCollisionPointPotentialGradient(const StompCollisionPoint& collision_point, const Eigen::MatrixBase<Derived>& collision_point_pos,
       double& potential, Eigen::MatrixBase<DerivedOther>& gradient) const;
@@ -148,6 +178,12 @@ private:
 
   double max_expansion_;
   double resolution_;
+  double field_origin_x_;
+  double field_origin_y_;
+  double field_origin_z_;
+  int field_num_cells_x_;
+  int field_num_cells_y_;
+  int field_num_cells_z_;
   double field_bias_x_;
   double field_bias_y_;
   double field_bias_z_;
@@ -171,6 +207,10 @@ private:
   std::map<std::string, std::vector<std::string> > distance_exclude_links_;
   std::map<std::string, std::vector<std::string> > distance_include_links_;
 
+  template<typename Derived>
+  bool getPotentialGradient(const StompCollisionPoint& collision_point, double field_distance,
+      const Eigen::Vector3d& field_gradient, double& potential, Eigen::MatrixBase<Derived>& gradient) const;
+
 };
 
 ///////////////////////////// inline functions follow ///////////////////////////////////
@@ -204,6 +244,13 @@ bool StompCollisionSpace::getCollisionPointPotentialGradient(const StompCollisio
   field_gradient(1) += field_bias_y_;
   field_gradient(2) += field_bias_z_;
 
+  return getPotentialGradient(collision_point, field_distance, field_gradient, potential, gradient);
+}
+
+template<typename Derived>
+bool StompCollisionSpace::getPotentialGradient(const StompCollisionPoint& collision_point, double field_distance,
+    const Eigen::Vector3d& field_gradient, double& potential, Eigen::MatrixBase<Derived>& gradient) const
+{
   double d = field_distance - collision_point.getRadius();
 
   // three cases below:
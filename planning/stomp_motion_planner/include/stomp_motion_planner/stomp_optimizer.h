@@ -39,6 +39,7 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
 #include <planning_environment/monitors/planning_monitor.h>
 #include <stomp_motion_planner/stomp_parameters.h>
 #include <stomp_motion_planner/stomp_trajectory.h>
@@ -95,6 +96,17 @@ public:
    */
   bool execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, const int iteration_number);
 
+  /**
+   * Executes a batch of rollouts on num_rollout_threads workers. The worker optimizers and their threads are created
+   * on the first call and reused for all following iterations. Each worker owns a copy of the trajectories,
+   * forward kinematics buffers, collision point arrays and inverse dynamics solver, rollout r is evaluated by
+   * worker r % num_workers and written into row r of costs, so the result does not depend on the thread count.
+   * @param parameters [num_rollouts][num_dimensions] num_parameters - policy parameters to execute
+   * @param costs num_rollouts x num_time_steps
+   * @return
+   */
+  bool executeRollouts(std::vector<std::vector<Eigen::VectorXd> >& parameters, Eigen::MatrixXd& costs, const int iteration_number);
+
   /**
    * Get the Policy object of this Task
    * @param policy
@@ -119,6 +131,12 @@ public:
 
 private:
 
+  /**
+   * Creates a rollout worker from the master optimizer. Must only be called after the forward kinematics of the
+   * full trajectory has been computed, the worker only recomputes the free part of the trajectory.
+   */
+  StompOptimizer(const StompOptimizer& master);
+
   int num_joints_;
   int num_vars_free_;
   int num_vars_all_;
@@ -156,6 +174,7 @@ private:
   std::vector<std::vector<double> > collision_point_potential_;
   std::vector<std::vector<double> > collision_point_vel_mag_;
   std::vector<std::vector<Eigen::Vector3d> > collision_point_potential_gradient_;
+  std::vector<StompCollisionSpace::CollisionPointQuery> collision_point_queries_;
   Eigen::MatrixXd group_trajectory_backup_;
   Eigen::MatrixXd best_group_trajectory_;
   double best_group_trajectory_cost_;
@@ -215,6 +234,34 @@ private:
   motion_planning_msgs::Constraints constraints_;
   std::vector<boost::shared_ptr<ConstraintEvaluator> > constraint_evaluators_;
 
+  // parallel rollout evaluation:
+  boost::shared_ptr<KDL::ChainIdSolver> id_solver_;
+  boost::shared_ptr<StompTrajectory> worker_full_trajectory_;
+  std::vector<boost::shared_ptr<StompOptimizer> > rollout_workers_;
+  std::vector<std::vector<int> > rollout_state_validity_;
+  std::vector<int> rollout_trajectory_validity_;
+  Eigen::VectorXd rollout_costs_;
+
+  // forward kinematics cache, the results of time step i are kept in the buffers above and are reused as long as
+  // the joint angles of that time step do not change by more than fk_cache_tolerance
+  Eigen::MatrixXd fk_cache_joint_positions_;
+  std::vector<int> fk_cache_valid_;
+  int fk_cache_lookups_;
+  int fk_cache_hits_;
+
+  // persistent rollout threads, thread w-1 runs worker w (the calling thread runs worker 0). A batch is announced
+  // by incrementing rollout_generation_, the threads that are not needed for a batch only report that they finished
+  std::vector<boost::shared_ptr<boost::thread> > rollout_threads_;
+  boost::mutex rollout_mutex_;
+  boost::condition_variable rollout_available_condition_;
+  boost::condition_variable rollout_finished_condition_;
+  unsigned int rollout_generation_;
+  int num_rollout_threads_finished_;
+  int num_active_rollout_workers_;
+  bool stop_rollout_threads_;
+  const std::vector<std::vector<Eigen::VectorXd> >* rollout_parameters_;
+  Eigen::MatrixXd* rollout_cost_matrix_;
+
   void initialize();
   void calculateSmoothnessIncrements();
   void calculateCollisionIncrements();
@@ -247,6 +294,16 @@ private:
   void clearAnimations();
 
   void getTorques(int index, std::vector<double>& torques, const std::vector<KDL::Wrench>& wrenches);
+
+  bool isForwardKinematicsCached(int index) const;
+  void getForwardKinematicsCacheStatistics(int& lookups, int& hits) const;
+  void setGroupTrajectoryFromParameters(const std::vector<Eigen::VectorXd>& parameters);
+  void computeRolloutCosts(Eigen::VectorXd& costs);
+  int getNumRolloutWorkers(int num_rollouts) const;
+  void executeRolloutWorker(int worker, int num_workers, const std::vector<std::vector<Eigen::VectorXd> >& parameters, Eigen::MatrixXd& costs);
+  void startRolloutThreads(int num_workers);
+  void stopRolloutThreads();
+  void runRolloutThread(int worker, unsigned int generation);
 };
 
 }
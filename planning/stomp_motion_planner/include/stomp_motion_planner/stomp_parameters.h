@@ -77,6 +77,10 @@ public:
   bool getAnimateEndeffector() const;
   std::string getAnimateEndeffectorSegment() const;
   bool getUseChomp() const;
+  int getNumRolloutThreads() const;
+  bool getUseFkCache() const;
+  double getFkCacheTolerance() const;
+  bool getInterpolateDistanceField() const;
 
 private:
   double planning_time_limit_;
@@ -104,6 +108,10 @@ private:
   bool animate_endeffector_;
   std::string animate_endeffector_segment_;
   bool use_chomp_;
+  int num_rollout_threads_;
+  bool use_fk_cache_;
+  double fk_cache_tolerance_;
+  bool interpolate_distance_field_;
 
 };
 
@@ -248,6 +256,26 @@ inline bool StompParameters::getUseChomp() const
   return use_chomp_;
 }
 
+inline int StompParameters::getNumRolloutThreads() const
+{
+  return num_rollout_threads_;
+}
+
+inline bool StompParameters::getUseFkCache() const
+{
+  return use_fk_cache_;
+}
+
+inline double StompParameters::getFkCacheTolerance() const
+{
+  return fk_cache_tolerance_;
+}
+
+inline bool StompParameters::getInterpolateDistanceField() const
+{
+  return interpolate_distance_field_;
+}
+
 
 } // namespace stomp
 
@@ -69,6 +69,25 @@ public:
      */
     virtual bool execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, const int iteration_number) = 0;
 
+    /**
+     * Executes the task for a batch of policy parameters. The default implementation calls execute() for each rollout,
+     * tasks may override it to evaluate the rollouts concurrently.
+     * @param parameters [num_rollouts][num_dimensions] num_parameters - policy parameters to execute
+     * @param costs num_rollouts x num_time_steps, row r is set to the costs of rollout r
+     * @return
+     */
+    virtual bool executeRollouts(std::vector<std::vector<Eigen::VectorXd> >& parameters, Eigen::MatrixXd& costs, const int iteration_number)
+    {
+        Eigen::VectorXd rollout_costs = Eigen::VectorXd::Zero(costs.cols());
+        for (int r=0; r<int(parameters.size()); ++r)
+        {
+            if (!execute(parameters[r], rollout_costs, iteration_number))
+                return false;
+            costs.row(r) = rollout_costs.transpose();
+        }
+        return true;
+    }
+
     /**
      * Get the Policy object of this Task
      * @param policy
@@ -41,6 +41,7 @@
 #include <Eigen/Core>
 #include <Eigen/Array>
 #include <sstream>
+#include <algorithm>
 
 using namespace Eigen;
 
@@ -161,13 +162,15 @@ bool CovariantTrajectoryPolicy::initializeVariables()
         num_parameters_.push_back(num_time_steps_);
 
     parameters_all_.resize(num_dimensions_, Eigen::VectorXd::Zero(num_vars_all_));
+    tmp_parameters_all_ = Eigen::VectorXd::Zero(num_vars_all_);
+    tmp_costs_all_ = Eigen::VectorXd::Zero(num_vars_all_);
 
     return true;
 }
 
 bool CovariantTrajectoryPolicy::initializeCosts()
 {
-    createDifferentiationMatrices();
+    createDifferentiationRules();
 
     control_costs_all_.clear();
     control_costs_.clear();
@@ -175,10 +178,23 @@ bool CovariantTrajectoryPolicy::initializeCosts()
     for (int d=0; d<num_dimensions_; ++d)
     {
         // construct the quadratic cost matrices (for all variables)
+        // sum of derivative_cost * D^T * D, accumulated row by row of the banded differentiation matrices D
         MatrixXd cost_all = MatrixXd::Identity(num_vars_all_, num_vars_all_) * cost_ridge_factor_;
         for (int i=0; i<NUM_DIFF_RULES; ++i)
         {
-            cost_all += derivative_costs_[i] * (differentiation_matrices_[i].transpose() * differentiation_matrices_[i]);
+            for (int r=0; r<num_vars_all_; ++r)
+            {
+                const int first = std::max(-DIFF_RULE_LENGTH/2, -r);
+                const int last = std::min(DIFF_RULE_LENGTH/2, num_vars_all_-1-r);
+                for (int j=first; j<=last; ++j)
+                {
+                    const double coefficient = derivative_costs_[i] * differentiation_rules_[i][j+DIFF_RULE_LENGTH/2];
+                    for (int k=first; k<=last; ++k)
+                    {
+                        cost_all(r+j, r+k) += coefficient * differentiation_rules_[i][k+DIFF_RULE_LENGTH/2];
+                    }
+                }
+            }
         }
         control_costs_all_.push_back(cost_all);
 
@@ -203,27 +219,36 @@ bool CovariantTrajectoryPolicy::initializeBasisFunctions()
 }
 
 
-void CovariantTrajectoryPolicy::createDifferentiationMatrices()
+void CovariantTrajectoryPolicy::createDifferentiationRules()
 {
     double multiplier = 1.0;
-    differentiation_matrices_.clear();
-    differentiation_matrices_.resize(NUM_DIFF_RULES, MatrixXd::Zero(num_vars_all_, num_vars_all_));
     for (int d=0; d<NUM_DIFF_RULES; ++d)
     {
         multiplier /= movement_dt_;
-        for (int i=0; i<num_vars_all_; i++)
+        for (int j=0; j<DIFF_RULE_LENGTH; ++j)
+        {
+            differentiation_rules_[d][j] = multiplier * DIFF_RULES[d][j];
+        }
+    }
+}
+
+void CovariantTrajectoryPolicy::addDerivativeCosts(const Eigen::VectorXd& params_all, const double weight, Eigen::VectorXd& costs_all) const
+{
+    // applies the stencils directly, the rows of the differentiation matrices are truncated at the boundaries
+    for (int d=0; d<NUM_DIFF_RULES; ++d)
+    {
+        const double cost_weight = weight * derivative_costs_[d];
+        for (int i=0; i<num_vars_all_; ++i)
         {
-            for (int j=-DIFF_RULE_LENGTH/2; j<=DIFF_RULE_LENGTH/2; j++)
+            const int first = std::max(-DIFF_RULE_LENGTH/2, -i);
+            const int last = std::min(DIFF_RULE_LENGTH/2, num_vars_all_-1-i);
+            double derivative = 0.0;
+            for (int j=first; j<=last; ++j)
             {
-                int index = i+j;
-                if (index < 0)
-                    continue;
-                if (index >= num_vars_all_)
-                    continue;
-                differentiation_matrices_[d](i,index) = multiplier * DIFF_RULES[d][j+DIFF_RULE_LENGTH/2];
+                derivative += differentiation_rules_[d][j+DIFF_RULE_LENGTH/2] * params_all(i+j);
             }
+            costs_all(i) += cost_weight * (derivative * derivative);
         }
-        //ROS_INFO_STREAM(differentiation_matrices_[d]);
     }
 }
 
@@ -233,22 +258,17 @@ bool CovariantTrajectoryPolicy::computeControlCosts(const std::vector<Eigen::Mat
   // this measures the accelerations and squares them
   for (int d=0; d<num_dimensions_; ++d)
   {
-      VectorXd params_all = parameters_all_[d];
-      VectorXd costs_all = VectorXd::Zero(num_vars_all_);
+      tmp_parameters_all_ = parameters_all_[d];
+      tmp_costs_all_.setZero();
 
-      params_all.segment(free_vars_start_index_, num_vars_free_) = parameters[d] + noise[d];
-      VectorXd acc_all = VectorXd::Zero(num_vars_all_);
-      for (int i=0; i<NUM_DIFF_RULES; ++i)
-      {
-          acc_all = differentiation_matrices_[i]*params_all;
-          costs_all += weight * derivative_costs_[i] * (acc_all.cwise()*acc_all);
-      }
+      tmp_parameters_all_.segment(free_vars_start_index_, num_vars_free_) = parameters[d] + noise[d];
+      addDerivativeCosts(tmp_parameters_all_, weight, tmp_costs_all_);
 
-      control_costs[d] = costs_all.segment(free_vars_start_index_, num_vars_free_);
+      control_costs[d] = tmp_costs_all_.segment(free_vars_start_index_, num_vars_free_);
       for (int i=0; i<free_vars_start_index_; ++i)
       {
-          control_costs[d](0) += costs_all(i);
-          control_costs[d](num_vars_free_-1) += costs_all(num_vars_all_-(i+1));
+          control_costs[d](0) += tmp_costs_all_(i);
+          control_costs[d](num_vars_free_-1) += tmp_costs_all_(num_vars_all_-(i+1));
       }
   }
 
@@ -281,23 +301,18 @@ bool CovariantTrajectoryPolicy::computeControlCosts(const std::vector<Eigen::Mat
     // this measures the accelerations and squares them
     for (int d=0; d<num_dimensions_; ++d)
     {
-        VectorXd params_all = parameters_all_[d];
-        VectorXd costs_all = VectorXd::Zero(num_vars_all_);
+        tmp_parameters_all_ = parameters_all_[d];
+        tmp_costs_all_.setZero();
         for (int t=0; t<num_time_steps_; ++t)
         {
-            params_all.segment(free_vars_start_index_, num_vars_free_) = parameters[d][t];
-            VectorXd acc_all = VectorXd::Zero(num_vars_all_);
-            for (int i=0; i<NUM_DIFF_RULES; ++i)
-            {
-                acc_all = differentiation_matrices_[i]*params_all;
-                costs_all += weight * derivative_costs_[i] * (acc_all.cwise()*acc_all);
-            }
+            tmp_parameters_all_.segment(free_vars_start_index_, num_vars_free_) = parameters[d][t];
+            addDerivativeCosts(tmp_parameters_all_, weight, tmp_costs_all_);
         }
-        control_costs[d] = costs_all.segment(free_vars_start_index_, num_vars_free_);
+        control_costs[d] = tmp_costs_all_.segment(free_vars_start_index_, num_vars_free_);
         for (int i=0; i<free_vars_start_index_; ++i)
         {
-            control_costs[d](0) += costs_all(i);
-            control_costs[d](num_vars_free_-1) += costs_all(num_vars_all_-(i+1));
+            control_costs[d](0) += tmp_costs_all_(i);
+            control_costs[d](num_vars_free_-1) += tmp_costs_all_(num_vars_all_-(i+1));
         }
     }
 
@@ -163,12 +163,7 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     // get rollouts and execute them
     ROS_ASSERT_FUNC(policy_improvement_.getRollouts(rollouts_, noise));
 
-    for (int r=0; r<int(rollouts_.size()); ++r)
-    {
-        ROS_ASSERT_FUNC(task_->execute(rollouts_[r], tmp_rollout_cost_, iteration_number));
-        rollout_costs_.row(r) = tmp_rollout_cost_.transpose();
-        //ROS_INFO("Rollout %d, cost = %lf", r+1, tmp_rollout_cost_.sum());
-    }
+    ROS_ASSERT_FUNC(task_->executeRollouts(rollouts_, rollout_costs_, iteration_number));
 
     // TODO: fix this std::vector<>
     std::vector<double> all_costs;
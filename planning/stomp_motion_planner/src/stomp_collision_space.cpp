@@ -81,6 +81,12 @@ bool StompCollisionSpace::init(planning_environment::CollisionSpaceMonitor* moni
   //initCollisionCuboids();
 
   distance_field_ = new distance_field::PropagationDistanceField(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z, max_radius_clearance);
+  field_origin_x_ = origin_x;
+  field_origin_y_ = origin_y;
+  field_origin_z_ = origin_z;
+  field_num_cells_x_ = distance_field_->getNumCells(distance_field::DIM_X);
+  field_num_cells_y_ = distance_field_->getNumCells(distance_field::DIM_Y);
+  field_num_cells_z_ = distance_field_->getNumCells(distance_field::DIM_Z);
 
   monitor_ = monitor;
   //now setting up robot bodies for potential inclusion in the distance field
@@ -167,6 +173,99 @@ bool StompCollisionSpace::init(planning_environment::CollisionSpaceMonitor* moni
   return true;
 }
 
+bool StompCollisionSpace::getCollisionPointPotentialGradients(const std::vector<StompCollisionPoint>& collision_points,
+    const std::vector<KDL::Vector>& collision_point_pos, std::vector<double>& potentials,
+    std::vector<Eigen::Vector3d>& gradients, std::vector<int>& point_is_in_collision,
+    std::vector<CollisionPointQuery>& queries) const
+{
+  int num_points = collision_point_pos.size();
+  double inv_resolution = 1.0 / resolution_;
+
+  // voxel i is centered at origin + i*resolution, find the voxel cube around each point:
+  queries.resize(num_points);
+  for (int j=0; j<num_points; ++j)
+  {
+    CollisionPointQuery& query = queries[j];
+    double gx = (collision_point_pos[j].x() - field_origin_x_) * inv_resolution;
+    double gy = (collision_point_pos[j].y() - field_origin_y_) * inv_resolution;
+    double gz = (collision_point_pos[j].z() - field_origin_z_) * inv_resolution;
+    query.index = j;
+    query.x = int(floor(gx));
+    query.y = int(floor(gy));
+    query.z = int(floor(gz));
+    query.fx = gx - query.x;
+    query.fy = gy - query.y;
+    query.fz = gz - query.z;
+    if (query.x < 0 || query.y < 0 || query.z < 0 ||
+        query.x >= field_num_cells_x_-1 || query.y >= field_num_cells_y_-1 || query.z >= field_num_cells_z_-1)
+    {
+      query.cell = -1;
+    }
+    else
+    {
+      query.cell = (query.x * field_num_cells_y_ + query.y) * field_num_cells_z_ + query.z;
+    }
+  }
+
+  // visit the voxels in memory order:
+  std::sort(queries.begin(), queries.end());
+
+  bool colliding = false;
+  Eigen::Vector3d field_gradient;
+  for (int n=0; n<num_points; ++n)
+  {
+    const CollisionPointQuery& q = queries[n];
+    double field_distance;
+    if (q.cell < 0)
+    {
+      // same as the distance field, out of bounds means free space
+      field_distance = max_expansion_;
+      field_gradient.setZero();
+    }
+    else
+    {
+      double d000 = distance_field_->getDistanceFromCell(q.x, q.y, q.z);
+      double d001 = distance_field_->getDistanceFromCell(q.x, q.y, q.z+1);
+      double d010 = distance_field_->getDistanceFromCell(q.x, q.y+1, q.z);
+      double d011 = distance_field_->getDistanceFromCell(q.x, q.y+1, q.z+1);
+      double d100 = distance_field_->getDistanceFromCell(q.x+1, q.y, q.z);
+      double d101 = distance_field_->getDistanceFromCell(q.x+1, q.y, q.z+1);
+      double d110 = distance_field_->getDistanceFromCell(q.x+1, q.y+1, q.z);
+      double d111 = distance_field_->getDistanceFromCell(q.x+1, q.y+1, q.z+1);
+
+      // differences along x:
+      double x00 = d100 - d000;
+      double x01 = d101 - d001;
+      double x10 = d110 - d010;
+      double x11 = d111 - d011;
+
+      // interpolate along x, then y, then z:
+      double d00 = d000 + q.fx * x00;
+      double d01 = d001 + q.fx * x01;
+      double d10 = d010 + q.fx * x10;
+      double d11 = d011 + q.fx * x11;
+      double d0 = d00 + q.fy * (d10 - d00);
+      double d1 = d01 + q.fy * (d11 - d01);
+      field_distance = d0 + q.fz * (d1 - d0);
+
+      // analytic gradient of the trilinear interpolation:
+      field_gradient(0) = ((1.0-q.fy) * ((1.0-q.fz) * x00 + q.fz * x01) + q.fy * ((1.0-q.fz) * x10 + q.fz * x11)) * inv_resolution;
+      field_gradient(1) = ((1.0-q.fz) * (d10 - d00) + q.fz * (d11 - d01)) * inv_resolution;
+      field_gradient(2) = (d1 - d0) * inv_resolution;
+    }
+
+    field_gradient(0) += field_bias_x_;
+    field_gradient(1) += field_bias_y_;
+    field_gradient(2) += field_bias_z_;
+
+    point_is_in_collision[q.index] = getPotentialGradient(collision_points[q.index], field_distance, field_gradient,
+                                                          potentials[q.index], gradients[q.index]);
+    if (point_is_in_collision[q.index])
+      colliding = true;
+  }
+  return colliding;
+}
+
 void StompCollisionSpace::setStartState(const StompRobotModel::StompPlanningGroup& planning_group, const motion_planning_msgs::RobotState& robot_state) {
 
   ros::WallTime start = ros::WallTime::now();
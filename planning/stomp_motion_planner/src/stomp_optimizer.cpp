@@ -39,6 +39,8 @@
 #include <visualization_msgs/MarkerArray.h>
 #include <stomp_motion_planner/stomp_utils.h>
 #include <Eigen/LU>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 
 using namespace std;
@@ -72,11 +74,88 @@ StompOptimizer::StompOptimizer(StompTrajectory *trajectory, const StompRobotMode
       vis_marker_array_pub_(vis_marker_array_publisher),
       vis_marker_pub_(vis_marker_publisher),
       stats_pub_(stats_publisher),
-      constraints_(constraints)
+      constraints_(constraints),
+      rollout_generation_(0),
+      num_rollout_threads_finished_(0),
+      num_active_rollout_workers_(0),
+      stop_rollout_threads_(false),
+      rollout_parameters_(NULL),
+      rollout_cost_matrix_(NULL)
 {
   initialize();
 }
 
+StompOptimizer::StompOptimizer(const StompOptimizer& master):
+      num_joints_(master.num_joints_),
+      num_vars_free_(master.num_vars_free_),
+      num_vars_all_(master.num_vars_all_),
+      num_collision_points_(master.num_collision_points_),
+      free_vars_start_(master.free_vars_start_),
+      free_vars_end_(master.free_vars_end_),
+      iteration_(1),
+      collision_free_iteration_(0),
+      full_trajectory_(NULL),
+      robot_model_(master.robot_model_),
+      monitor_(master.monitor_),
+      planning_group_(master.planning_group_),
+      parameters_(master.parameters_),
+      collision_space_(master.collision_space_),
+      group_trajectory_(master.group_trajectory_),
+      joint_costs_(master.joint_costs_),
+      group_joint_to_kdl_joint_index_(master.group_joint_to_kdl_joint_index_),
+      joint_axis_(master.joint_axis_),
+      joint_pos_(master.joint_pos_),
+      segment_frames_(master.segment_frames_),
+      collision_point_pos_(master.collision_point_pos_),
+      collision_point_vel_(master.collision_point_vel_),
+      collision_point_acc_(master.collision_point_acc_),
+      collision_point_potential_(master.collision_point_potential_),
+      collision_point_vel_mag_(master.collision_point_vel_mag_),
+      collision_point_potential_gradient_(master.collision_point_potential_gradient_),
+      state_is_in_collision_(master.state_is_in_collision_),
+      point_is_in_collision_(master.point_is_in_collision_),
+      kdl_joint_array_(master.kdl_joint_array_),
+      kdl_group_joint_array_(master.kdl_group_joint_array_),
+      kdl_group_vel_joint_array_(master.kdl_group_vel_joint_array_),
+      kdl_group_acc_joint_array_(master.kdl_group_acc_joint_array_),
+      kdl_group_torque_joint_array_(master.kdl_group_torque_joint_array_),
+      joint_state_velocities_(master.joint_state_velocities_),
+      joint_state_accelerations_(master.joint_state_accelerations_),
+      state_validity_(master.state_validity_),
+      trajectory_validity_(master.trajectory_validity_),
+      animate_endeffector_segment_number_(master.animate_endeffector_segment_number_),
+      constraints_(master.constraints_),
+      constraint_evaluators_(master.constraint_evaluators_),
+      fk_cache_joint_positions_(master.fk_cache_joint_positions_),
+      fk_cache_valid_(master.fk_cache_valid_),
+      fk_cache_lookups_(0),
+      fk_cache_hits_(0),
+      rollout_generation_(0),
+      num_rollout_threads_finished_(0),
+      num_active_rollout_workers_(0),
+      stop_rollout_threads_(false),
+      rollout_parameters_(NULL),
+      rollout_cost_matrix_(NULL)
+{
+  // the worker evaluates rollouts on its own full trajectory
+  worker_full_trajectory_.reset(new StompTrajectory(*master.full_trajectory_));
+  full_trajectory_ = worker_full_trajectory_.get();
+
+  // the maps have to point into the buffers of this worker:
+  kdlVecVecToEigenVecVec(joint_axis_, joint_axis_eigen_, 3, 1);
+  kdlVecVecToEigenVecVec(joint_pos_, joint_pos_eigen_, 3, 1);
+  kdlVecVecToEigenVecVec(collision_point_pos_, collision_point_pos_eigen_, 3, 1);
+  kdlVecVecToEigenVecVec(collision_point_vel_, collision_point_vel_eigen_, 3, 1);
+  kdlVecVecToEigenVecVec(collision_point_acc_, collision_point_acc_eigen_, 3, 1);
+
+  // the fk solver is shared since JntToCartPartial() does not modify it, the recursive newton euler solver keeps
+  // intermediate results and therefore needs to be duplicated:
+  KDL::Vector gravity(0,0,-9.8);
+  id_solver_.reset(new KDL::ChainIdSolver_RNE(planning_group_->kdl_chain_, gravity));
+
+  rollout_costs_ = Eigen::VectorXd::Zero(num_vars_free_);
+}
+
 void StompOptimizer::initialize()
 {
 
@@ -179,6 +258,11 @@ void StompOptimizer::initialize()
   kinematic_state_.reset(new planning_models::KinematicState(monitor_->getKinematicModel()));
   state_validity_.resize(num_vars_all_);
 
+  fk_cache_joint_positions_ = Eigen::MatrixXd::Zero(num_vars_all_, num_joints_);
+  fk_cache_valid_.resize(num_vars_all_, 0);
+  fk_cache_lookups_ = 0;
+  fk_cache_hits_ = 0;
+
   // HMC initialization:
   momentum_ = Eigen::MatrixXd::Zero(num_vars_free_, num_joints_);
   random_momentum_ = Eigen::MatrixXd::Zero(num_vars_free_, num_joints_);
@@ -217,6 +301,8 @@ void StompOptimizer::initialize()
 //    printf("%f\n", policy_params[0][i]);
 //  }
 
+  id_solver_ = planning_group_->id_solver_;
+
   // initialize the constraints:
   for (int i=0; i<int(constraints_.orientation_constraints.size()); ++i)
   {
@@ -228,6 +314,7 @@ void StompOptimizer::initialize()
 
 StompOptimizer::~StompOptimizer()
 {
+  stopRolloutThreads();
 }
 
 void StompOptimizer::doChompOptimization()
@@ -406,6 +493,11 @@ void StompOptimizer::optimize()
   ROS_INFO("Best cost = %f", best_group_trajectory_cost_);
   ROS_INFO("Optimization core finished in %f sec", (ros::WallTime::now() - start_time).toSec());
   stomp_statistics->best_cost = best_group_trajectory_cost_;
+  getForwardKinematicsCacheStatistics(stomp_statistics->fk_cache_lookups, stomp_statistics->fk_cache_hits);
+  if (stomp_statistics->fk_cache_lookups > 0)
+  {
+    ROS_INFO("Forward kinematics cache hit rate = %f", double(stomp_statistics->fk_cache_hits) / stomp_statistics->fk_cache_lookups);
+  }
 
   // calculate the torques for publishing
   std::vector<KDL::Wrench> wrenches(planning_group_->kdl_chain_.getNrOfSegments());
@@ -657,9 +749,24 @@ bool StompOptimizer::performForwardKinematics()
 
   is_collision_free_ = true;
 
+  // the full forward kinematics of the first iteration always has to be computed
+  bool use_fk_cache = parameters_->getUseFkCache() && iteration_!=0;
+
   // for each point in the trajectory
   for (int i=start; i<=end; ++i)
   {
+    if (use_fk_cache)
+    {
+      fk_cache_lookups_++;
+      if (isForwardKinematicsCached(i))
+      {
+        fk_cache_hits_++;
+        if (state_is_in_collision_[i])
+          is_collision_free_ = false;
+        continue;
+      }
+    }
+
     int full_traj_index = group_trajectory_.getFullTrajectoryIndex(i);
     full_trajectory_->getTrajectoryPointKDL(full_traj_index, kdl_joint_array_);
 
@@ -687,22 +794,40 @@ bool StompOptimizer::performForwardKinematics()
       planning_group_->collision_points_[j].getTransformedPosition(segment_frames_[i], collision_point_pos_[i][j]);
       //int segment_number = planning_group_->collision_points_[j].getSegmentNumber();
       //collision_point_pos_[i][j] = segment_frames_[i][segment_number] * planning_group_->collision_points_[j].getPosition();
+    }
 
-      bool colliding = collision_space_->getCollisionPointPotentialGradient(planning_group_->collision_points_[j],
-          collision_point_pos_eigen_[i][j],
-          collision_point_potential_[i][j],
-          collision_point_potential_gradient_[i][j]);
+    if (parameters_->getInterpolateDistanceField())
+    {
+      state_is_in_collision_[i] = collision_space_->getCollisionPointPotentialGradients(planning_group_->collision_points_,
+          collision_point_pos_[i], collision_point_potential_[i], collision_point_potential_gradient_[i],
+          point_is_in_collision_[i], collision_point_queries_);
+    }
+    else
+    {
+      for (int j=0; j<num_collision_points_; j++)
+      {
+        bool colliding = collision_space_->getCollisionPointPotentialGradient(planning_group_->collision_points_[j],
+            collision_point_pos_eigen_[i][j],
+            collision_point_potential_[i][j],
+            collision_point_potential_gradient_[i][j]);
 
-      point_is_in_collision_[i][j] = colliding;
+        point_is_in_collision_[i][j] = colliding;
 
-      if (colliding)
-        state_is_in_collision_[i] = true;
+        if (colliding)
+          state_is_in_collision_[i] = true;
+      }
     }
 
     if (state_is_in_collision_[i])
     {
       is_collision_free_ = false;
     }
+
+    if (parameters_->getUseFkCache())
+    {
+      fk_cache_joint_positions_.row(i) = group_trajectory_.getTrajectoryPoint(i);
+      fk_cache_valid_[i] = 1;
+    }
   }
 
   // now, get the vel and acc for each collision point (using finite differencing)
@@ -734,6 +859,29 @@ bool StompOptimizer::performForwardKinematics()
   return is_collision_free_;
 }
 
+bool StompOptimizer::isForwardKinematicsCached(int index) const
+{
+  if (!fk_cache_valid_[index])
+    return false;
+  for (int j=0; j<num_joints_; ++j)
+  {
+    if (fabs(group_trajectory_(index, j) - fk_cache_joint_positions_(index, j)) > parameters_->getFkCacheTolerance())
+      return false;
+  }
+  return true;
+}
+
+void StompOptimizer::getForwardKinematicsCacheStatistics(int& lookups, int& hits) const
+{
+  lookups = fk_cache_lookups_;
+  hits = fk_cache_hits_;
+  for (int w=0; w<int(rollout_workers_.size()); ++w)
+  {
+    lookups += rollout_workers_[w]->fk_cache_lookups_;
+    hits += rollout_workers_[w]->fk_cache_hits_;
+  }
+}
+
 void StompOptimizer::eigenMapTest()
 {
   double foo_eigen;
@@ -1055,11 +1203,11 @@ void StompOptimizer::getTorques(int index, std::vector<double>& torques, const s
     kdl_group_vel_joint_array_(j) = joint_state_velocities_(j);
     kdl_group_acc_joint_array_(j) = joint_state_accelerations_(j);
   }
-  planning_group_->id_solver_->CartToJnt(kdl_group_joint_array_,
-                                         kdl_group_vel_joint_array_,
-                                         kdl_group_acc_joint_array_,
-                                         wrenches,
-                                         kdl_group_torque_joint_array_);
+  id_solver_->CartToJnt(kdl_group_joint_array_,
+                        kdl_group_vel_joint_array_,
+                        kdl_group_acc_joint_array_,
+                        wrenches,
+                        kdl_group_torque_joint_array_);
 
   for (int j=0; j<num_joints_; ++j)
   {
@@ -1074,6 +1222,21 @@ bool StompOptimizer::execute(std::vector<Eigen::VectorXd>& parameters, Eigen::Ve
   //return true;
   ros::WallTime start_time = ros::WallTime::now();
 
+  setGroupTrajectoryFromParameters(parameters);
+
+  if (parameters_->getStateValidityCostWeight() > 1e-10)
+  {
+    computeTrajectoryValidity();
+  }
+
+  computeRolloutCosts(costs);
+
+  //ROS_INFO("Rollout took %f seconds, ", (ros::WallTime::now() - start_time).toSec());
+  return true;
+}
+
+void StompOptimizer::setGroupTrajectoryFromParameters(const std::vector<Eigen::VectorXd>& parameters)
+{
   // copy the parameters into group_trajectory_:
   for (int d=0; d<num_joints_; ++d)
   {
@@ -1085,13 +1248,15 @@ bool StompOptimizer::execute(std::vector<Eigen::VectorXd>& parameters, Eigen::Ve
 
   // copy to full traj:
   updateFullTrajectory();
+}
 
+void StompOptimizer::computeRolloutCosts(Eigen::VectorXd& costs)
+{
   // do forward kinematics:
   last_trajectory_collision_free_ = performForwardKinematics();
 
   if (parameters_->getStateValidityCostWeight() > 1e-10)
   {
-    computeTrajectoryValidity();
     last_trajectory_collision_free_ = trajectory_validity_;
   }
 
@@ -1186,11 +1351,140 @@ bool StompOptimizer::execute(std::vector<Eigen::VectorXd>& parameters, Eigen::Ve
   //animateEndeffector();
   //ros::spinOnce();
   //ros::Duration(1.0).sleep();
+}
 
-  //ROS_INFO("Rollout took %f seconds, ", (ros::WallTime::now() - start_time).toSec());
+int StompOptimizer::getNumRolloutWorkers(int num_rollouts) const
+{
+  int num_threads = parameters_->getNumRolloutThreads();
+  if (num_threads <= 0)
+    num_threads = boost::thread::hardware_concurrency();
+  return std::min(num_threads, num_rollouts);
+}
+
+bool StompOptimizer::executeRollouts(std::vector<std::vector<Eigen::VectorXd> >& parameters, Eigen::MatrixXd& costs, const int iteration_number)
+{
+  int num_rollouts = parameters.size();
+  int num_workers = getNumRolloutWorkers(num_rollouts);
+  if (num_workers <= 1)
+  {
+    return Task::executeRollouts(parameters, costs, iteration_number);
+  }
+
+  // exact collision checking goes through the planning monitor, which is not thread safe. Therefore, it is done
+  // for all rollouts up front and the workers only look up the result:
+  if (parameters_->getStateValidityCostWeight() > 1e-10)
+  {
+    rollout_state_validity_.resize(num_rollouts);
+    rollout_trajectory_validity_.resize(num_rollouts);
+    for (int r=0; r<num_rollouts; ++r)
+    {
+      setGroupTrajectoryFromParameters(parameters[r]);
+      computeTrajectoryValidity();
+      rollout_state_validity_[r] = state_validity_;
+      rollout_trajectory_validity_[r] = trajectory_validity_;
+    }
+  }
+
+  // the workers are created once the forward kinematics of the fixed states has been computed in optimize()
+  while (int(rollout_workers_.size()) < num_workers)
+  {
+    rollout_workers_.push_back(boost::shared_ptr<StompOptimizer>(new StompOptimizer(*this)));
+  }
+  startRolloutThreads(num_workers);
+
+  {
+    boost::mutex::scoped_lock lock(rollout_mutex_);
+    rollout_parameters_ = &parameters;
+    rollout_cost_matrix_ = &costs;
+    num_active_rollout_workers_ = num_workers;
+    num_rollout_threads_finished_ = 0;
+    rollout_generation_++;
+  }
+  rollout_available_condition_.notify_all();
+
+  executeRolloutWorker(0, num_workers, parameters, costs);
+
+  boost::mutex::scoped_lock lock(rollout_mutex_);
+  while (num_rollout_threads_finished_ < int(rollout_threads_.size()))
+  {
+    rollout_finished_condition_.wait(lock);
+  }
+  rollout_parameters_ = NULL;
+  rollout_cost_matrix_ = NULL;
   return true;
 }
 
+void StompOptimizer::startRolloutThreads(int num_workers)
+{
+  // the threads are passed the current generation such that a batch announced before they get to run is not missed
+  boost::mutex::scoped_lock lock(rollout_mutex_);
+  while (int(rollout_threads_.size()) < num_workers - 1)
+  {
+    int worker = rollout_threads_.size() + 1;
+    rollout_threads_.push_back(boost::shared_ptr<boost::thread>(new boost::thread(
+        boost::bind(&StompOptimizer::runRolloutThread, this, worker, rollout_generation_))));
+  }
+}
+
+void StompOptimizer::stopRolloutThreads()
+{
+  {
+    boost::mutex::scoped_lock lock(rollout_mutex_);
+    stop_rollout_threads_ = true;
+  }
+  rollout_available_condition_.notify_all();
+  for (int i=0; i<int(rollout_threads_.size()); ++i)
+  {
+    rollout_threads_[i]->join();
+  }
+  rollout_threads_.clear();
+}
+
+void StompOptimizer::runRolloutThread(int worker, unsigned int generation)
+{
+  while (true)
+  {
+    int num_workers = 0;
+    {
+      boost::mutex::scoped_lock lock(rollout_mutex_);
+      while (!stop_rollout_threads_ && generation == rollout_generation_)
+      {
+        rollout_available_condition_.wait(lock);
+      }
+      if (stop_rollout_threads_)
+        return;
+      generation = rollout_generation_;
+      num_workers = num_active_rollout_workers_;
+    }
+
+    if (worker < num_workers)
+      executeRolloutWorker(worker, num_workers, *rollout_parameters_, *rollout_cost_matrix_);
+
+    boost::mutex::scoped_lock lock(rollout_mutex_);
+    num_rollout_threads_finished_++;
+    if (num_rollout_threads_finished_ == int(rollout_threads_.size()))
+      rollout_finished_condition_.notify_all();
+  }
+}
+
+void StompOptimizer::executeRolloutWorker(int worker, int num_workers, const std::vector<std::vector<Eigen::VectorXd> >& parameters,
+                                          Eigen::MatrixXd& costs)
+{
+  StompOptimizer& w = *rollout_workers_[worker];
+  for (int r=worker; r<int(parameters.size()); r+=num_workers)
+  {
+    w.setGroupTrajectoryFromParameters(parameters[r]);
+    if (parameters_->getStateValidityCostWeight() > 1e-10)
+    {
+      w.state_validity_ = rollout_state_validity_[r];
+      w.trajectory_validity_ = rollout_trajectory_validity_[r];
+    }
+    w.computeRolloutCosts(w.rollout_costs_);
+    // each row is only written by a single worker
+    costs.row(r) = w.rollout_costs_.transpose();
+  }
+}
+
 void StompOptimizer::computeTrajectoryValidity()
 {
   trajectory_validity_ = true;
@@ -75,6 +75,10 @@ void StompParameters::initFromNodeHandle()
   node_handle.param("animate_endeffector", animate_endeffector_, false);
   node_handle.param("animate_endeffector_segment", animate_endeffector_segment_, std::string("r_gripper_tool_frame"));
   node_handle.param("use_chomp", use_chomp_, false);
+  node_handle.param("num_rollout_threads", num_rollout_threads_, 0);
+  node_handle.param("use_fk_cache", use_fk_cache_, true);
+  node_handle.param("fk_cache_tolerance", fk_cache_tolerance_, 0.0);
+  node_handle.param("interpolate_distance_field", interpolate_distance_field_, false);
 }
 
 
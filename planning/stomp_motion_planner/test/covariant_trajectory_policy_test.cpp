@@ -0,0 +1,218 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/** \author Mrinal Kalakrishnan */
+
+#include <gtest/gtest.h>
+#include <stomp_motion_planner/covariant_trajectory_policy.h>
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+
+using namespace stomp_motion_planner;
+USING_PART_OF_NAMESPACE_EIGEN
+
+/**
+ * The differentiation matrices as they were built before the stencils were applied directly:
+ * dense num_vars_all x num_vars_all, rows truncated at the boundaries
+ */
+static void createReferenceDifferentiationMatrices(const int num_vars_all, const double movement_dt,
+                                                   std::vector<MatrixXd>& differentiation_matrices)
+{
+    double multiplier = 1.0;
+    differentiation_matrices.clear();
+    differentiation_matrices.resize(NUM_DIFF_RULES, MatrixXd::Zero(num_vars_all, num_vars_all));
+    for (int d=0; d<NUM_DIFF_RULES; ++d)
+    {
+        multiplier /= movement_dt;
+        for (int i=0; i<num_vars_all; i++)
+        {
+            for (int j=-DIFF_RULE_LENGTH/2; j<=DIFF_RULE_LENGTH/2; j++)
+            {
+                int index = i+j;
+                if (index < 0 || index >= num_vars_all)
+                    continue;
+                differentiation_matrices[d](i,index) = multiplier * DIFF_RULES[d][j+DIFF_RULE_LENGTH/2];
+            }
+        }
+    }
+}
+
+/**
+ * The control costs of one dimension as they were computed with the dense differentiation matrices
+ * @param parameters_all all variables of the dimension, including the fixed start and goal
+ * @param parameters [num_time_steps] num_vars_free: the free variables over time
+ */
+static void computeReferenceControlCosts(const std::vector<MatrixXd>& differentiation_matrices, const std::vector<double>& derivative_costs,
+                                         const VectorXd& parameters_all, const std::vector<VectorXd>& parameters,
+                                         const double weight, VectorXd& control_costs)
+{
+    const int num_vars_all = parameters_all.size();
+    const int free_vars_start_index = DIFF_RULE_LENGTH - 1;
+    const int num_vars_free = num_vars_all - 2 * free_vars_start_index;
+    VectorXd params_all = parameters_all;
+    VectorXd costs_all = VectorXd::Zero(num_vars_all);
+    for (int t=0; t<int(parameters.size()); ++t)
+    {
+        params_all.segment(free_vars_start_index, num_vars_free) = parameters[t];
+        for (int i=0; i<NUM_DIFF_RULES; ++i)
+        {
+            VectorXd derivative_all = differentiation_matrices[i] * params_all;
+            for (int j=0; j<num_vars_all; ++j)
+            {
+                costs_all(j) += weight * derivative_costs[i] * derivative_all(j) * derivative_all(j);
+            }
+        }
+    }
+    control_costs = costs_all.segment(free_vars_start_index, num_vars_free);
+    for (int i=0; i<free_vars_start_index; ++i)
+    {
+        control_costs(0) += costs_all(i);
+        control_costs(num_vars_free-1) += costs_all(num_vars_all-(i+1));
+    }
+}
+
+TEST(CovariantTrajectoryPolicyTest, testControlCostsMatchDifferentiationMatrices)
+{
+    ros::NodeHandle node_handle;
+    const int NUM_TIME_STEPS = 50;
+    const int NUM_DIMENSIONS = 2;
+    const double MOVEMENT_DURATION = 1.5;
+    const double COST_RIDGE_FACTOR = 0.00001;
+    const double WEIGHT = 0.3;
+    std::vector<double> derivative_costs;
+    derivative_costs.push_back(0.1);
+    derivative_costs.push_back(1.0);
+    derivative_costs.push_back(0.01);
+
+    CovariantTrajectoryPolicy ctp;
+    ASSERT_TRUE(ctp.initialize(node_handle, NUM_TIME_STEPS, NUM_DIMENSIONS, MOVEMENT_DURATION, COST_RIDGE_FACTOR, derivative_costs));
+
+    // non zero start and goal, such that the boundary variables contribute to the costs
+    VectorXd start = VectorXd::Zero(NUM_DIMENSIONS);
+    VectorXd goal = VectorXd::Zero(NUM_DIMENSIONS);
+    for (int d=0; d<NUM_DIMENSIONS; ++d)
+    {
+        start(d) = 2.0 - d;
+        goal(d) = 1.0 + 0.5 * d;
+    }
+    ASSERT_TRUE(ctp.setToMinControlCost(start, goal));
+    std::vector<VectorXd> parameters_all;
+    ASSERT_TRUE(ctp.getParametersAll(parameters_all));
+    ASSERT_EQ(NUM_DIMENSIONS, int(parameters_all.size()));
+    const int num_vars_all = parameters_all[0].size();
+    const int free_vars_start_index = DIFF_RULE_LENGTH - 1;
+    ASSERT_EQ(NUM_TIME_STEPS + 2 * free_vars_start_index, num_vars_all);
+
+    std::vector<MatrixXd> differentiation_matrices;
+    createReferenceDifferentiationMatrices(num_vars_all, MOVEMENT_DURATION / (NUM_TIME_STEPS + 1), differentiation_matrices);
+
+    // the quadratic cost matrices
+    std::vector<MatrixXd> control_cost_matrices;
+    ASSERT_TRUE(ctp.getControlCosts(control_cost_matrices));
+    ASSERT_EQ(NUM_DIMENSIONS, int(control_cost_matrices.size()));
+    MatrixXd cost_all = MatrixXd::Identity(num_vars_all, num_vars_all) * COST_RIDGE_FACTOR;
+    for (int i=0; i<NUM_DIFF_RULES; ++i)
+    {
+        cost_all += derivative_costs[i] * (differentiation_matrices[i].transpose() * differentiation_matrices[i]);
+    }
+    MatrixXd cost_free = cost_all.block(free_vars_start_index, free_vars_start_index, NUM_TIME_STEPS, NUM_TIME_STEPS);
+    for (int d=0; d<NUM_DIMENSIONS; ++d)
+    {
+        ASSERT_EQ(NUM_TIME_STEPS, control_cost_matrices[d].rows());
+        ASSERT_EQ(NUM_TIME_STEPS, control_cost_matrices[d].cols());
+        for (int i=0; i<NUM_TIME_STEPS; ++i)
+        {
+            for (int j=0; j<NUM_TIME_STEPS; ++j)
+            {
+                EXPECT_NEAR(cost_free(i, j), control_cost_matrices[d](i, j), 1e-9 * std::max(1.0, fabs(cost_free(i, j))));
+            }
+        }
+    }
+
+    // noisy parameters over time around the minimum control cost trajectory
+    std::vector<std::vector<VectorXd> > parameters(NUM_DIMENSIONS, std::vector<VectorXd>(NUM_TIME_STEPS));
+    for (int d=0; d<NUM_DIMENSIONS; ++d)
+    {
+        for (int t=0; t<NUM_TIME_STEPS; ++t)
+        {
+            parameters[d][t] = parameters_all[d].segment(free_vars_start_index, NUM_TIME_STEPS);
+            for (int i=0; i<NUM_TIME_STEPS; ++i)
+            {
+                parameters[d][t](i) += 0.01 * sin(0.7 * i + 1.3 * t + d);
+            }
+        }
+    }
+    std::vector<VectorXd> control_costs(NUM_DIMENSIONS);
+    ASSERT_TRUE(ctp.computeControlCosts(control_cost_matrices, parameters, WEIGHT, control_costs));
+
+    for (int d=0; d<NUM_DIMENSIONS; ++d)
+    {
+        VectorXd reference;
+        computeReferenceControlCosts(differentiation_matrices, derivative_costs, parameters_all[d], parameters[d], WEIGHT, reference);
+        ASSERT_EQ(NUM_TIME_STEPS, control_costs[d].size());
+        for (int t=0; t<NUM_TIME_STEPS; ++t)
+        {
+            EXPECT_NEAR(reference(t), control_costs[d](t), 1e-9 * std::max(1.0, fabs(reference(t))));
+        }
+    }
+
+    // the overload for a single noisy parameter vector per dimension
+    std::vector<VectorXd> nominal_parameters(NUM_DIMENSIONS);
+    std::vector<VectorXd> noise(NUM_DIMENSIONS);
+    for (int d=0; d<NUM_DIMENSIONS; ++d)
+    {
+        nominal_parameters[d] = parameters_all[d].segment(free_vars_start_index, NUM_TIME_STEPS);
+        noise[d] = parameters[d][NUM_TIME_STEPS/2] - nominal_parameters[d];
+    }
+    ASSERT_TRUE(ctp.computeControlCosts(control_cost_matrices, nominal_parameters, noise, WEIGHT, control_costs));
+    for (int d=0; d<NUM_DIMENSIONS; ++d)
+    {
+        VectorXd reference;
+        computeReferenceControlCosts(differentiation_matrices, derivative_costs, parameters_all[d],
+                                     std::vector<VectorXd>(1, nominal_parameters[d] + noise[d]), WEIGHT, reference);
+        ASSERT_EQ(NUM_TIME_STEPS, control_costs[d].size());
+        for (int t=0; t<NUM_TIME_STEPS; ++t)
+        {
+            EXPECT_NEAR(reference(t), control_costs[d](t), 1e-9 * std::max(1.0, fabs(reference(t))));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "covariant_trajectory_policy_test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
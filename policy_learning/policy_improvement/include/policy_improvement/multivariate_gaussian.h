@@ -41,8 +41,11 @@
 #include <Eigen/Cholesky>
 #include <boost/random/variate_generator.hpp>
 #include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_01.hpp>
 #include <boost/random/mersenne_twister.hpp>
-#include <boost/shared_ptr.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <vector>
+#include <algorithm>
 #include <cstdlib>
 
 namespace pi2
@@ -50,25 +53,52 @@ namespace pi2
 
 /**
  * \brief Generates samples from a multivariate gaussian distribution
+ *
+ * Each generator is seeded with rand() when it is constructed, copies continue the random stream of the original.
  */
 class MultivariateGaussian
 {
 public:
+  /**
+   * How the standard normal samples are drawn by sample(samples) (the single sample version always uses MONTE_CARLO)
+   */
+  enum SamplingMethod
+  {
+    MONTE_CARLO,  /**< independent pseudo random samples */
+    ANTITHETIC,   /**< pairs of samples mirrored at the mean */
+    HALTON        /**< randomly shifted Halton sequence mapped through the inverse normal cdf */
+  };
+
   template <typename Derived1, typename Derived2>
   MultivariateGaussian(const Eigen::MatrixBase<Derived1>& mean, const Eigen::MatrixBase<Derived2>& covariance);
 
   template <typename Derived>
   void sample(Eigen::MatrixBase<Derived>& output);
 
+  /**
+   * Draws a batch of samples, one sample per row
+   * @param samples (output) num_samples x size, must be allocated
+   */
+  void sample(Eigen::MatrixXd& samples);
+
+  void setSamplingMethod(const SamplingMethod sampling_method);
+
 private:
   Eigen::VectorXd mean_;                /**< Mean of the gaussian distribution */
   Eigen::MatrixXd covariance_;          /**< Covariance of the gaussian distribution */
   Eigen::MatrixXd covariance_cholesky_; /**< Cholesky decomposition (LL^T) of the covariance */
 
   int size_;
-  boost::mt19937 rng_;
-  boost::normal_distribution<> normal_dist_;
-  boost::shared_ptr<boost::variate_generator<boost::mt19937, boost::normal_distribution<> > > gaussian_;
+  boost::variate_generator<boost::mt19937, boost::normal_distribution<> > gaussian_;
+
+  SamplingMethod sampling_method_;
+  std::vector<int> halton_bases_;       /**< [size] the first size primes */
+  std::vector<double> halton_shifts_;   /**< [size] random shift of the sequence modulo 1 */
+  unsigned int halton_index_;           /**< index of the next point of the sequence */
+
+  void seed(const unsigned int seed);
+  void initializeHalton(const unsigned int seed);
+  double getHaltonPoint(unsigned int index, const int base) const;
 };
 
 //////////////////////// template function definitions follow //////////////////////////////
@@ -78,21 +108,123 @@ MultivariateGaussian::MultivariateGaussian(const Eigen::MatrixBase<Derived1>& me
   mean_(mean),
   covariance_(covariance),
   covariance_cholesky_(covariance_.llt().matrixL()),
-  normal_dist_(0.0,1.0)
+  gaussian_(boost::mt19937(), boost::normal_distribution<>(0.0, 1.0)),
+  sampling_method_(MONTE_CARLO)
 {
-  rng_.seed(rand());
   size_ = mean.rows();
-  gaussian_.reset(new boost::variate_generator<boost::mt19937, boost::normal_distribution<> >(rng_, normal_dist_));
+
+  // the first size_ primes are the bases of the Halton sequence
+  for (int candidate=2; int(halton_bases_.size())<size_; ++candidate)
+  {
+    bool is_prime = true;
+    for (int i=0; i<int(halton_bases_.size()) && halton_bases_[i]*halton_bases_[i]<=candidate; ++i)
+    {
+      if (candidate % halton_bases_[i] == 0)
+      {
+        is_prime = false;
+        break;
+      }
+    }
+    if (is_prime)
+      halton_bases_.push_back(candidate);
+  }
+  seed(rand());
 }
 
 template <typename Derived>
 void MultivariateGaussian::sample(Eigen::MatrixBase<Derived>& output)
 {
   for (int i=0; i<size_; ++i)
-    output(i) = (*gaussian_)();
+    output(i) = gaussian_();
   output = mean_ + covariance_cholesky_*output;
 }
 
+inline void MultivariateGaussian::sample(Eigen::MatrixXd& samples)
+{
+  int num_samples = samples.rows();
+  switch (sampling_method_)
+  {
+    case MONTE_CARLO:
+    {
+      for (int s=0; s<num_samples; ++s)
+        for (int i=0; i<size_; ++i)
+          samples(s, i) = gaussian_();
+      break;
+    }
+    case ANTITHETIC:
+    {
+      for (int s=0; s<num_samples; s+=2)
+      {
+        for (int i=0; i<size_; ++i)
+          samples(s, i) = gaussian_();
+        if (s+1 < num_samples)
+          samples.row(s+1) = -samples.row(s);
+      }
+      break;
+    }
+    case HALTON:
+    {
+      boost::math::normal_distribution<> standard_normal;
+      for (int s=0; s<num_samples; ++s, ++halton_index_)
+      {
+        for (int i=0; i<size_; ++i)
+        {
+          double u = getHaltonPoint(halton_index_, halton_bases_[i]) + halton_shifts_[i];
+          if (u >= 1.0)
+            u -= 1.0;
+          // keep away from 0 and 1, where the inverse cdf diverges
+          u = std::min(std::max(u, 1e-10), 1.0 - 1e-10);
+          samples(s, i) = boost::math::quantile(standard_normal, u);
+        }
+      }
+      break;
+    }
+  }
+
+  // transform all standard normal samples at once
+  samples = samples * covariance_cholesky_.transpose();
+  for (int s=0; s<num_samples; ++s)
+    samples.row(s) += mean_.transpose();
+}
+
+inline void MultivariateGaussian::seed(const unsigned int seed)
+{
+  gaussian_.engine().seed(seed);
+  gaussian_.distribution().reset();
+  initializeHalton(seed);
+}
+
+inline void MultivariateGaussian::setSamplingMethod(const SamplingMethod sampling_method)
+{
+  sampling_method_ = sampling_method;
+}
+
+inline void MultivariateGaussian::initializeHalton(const unsigned int seed)
+{
+  // a random shift (Cranley-Patterson rotation) keeps the sequence uniformly distributed, but makes the
+  // samples differ between generators and seeds
+  boost::uniform_01<boost::mt19937> uniform((boost::mt19937(seed)));
+  halton_shifts_.resize(size_);
+  for (int i=0; i<size_; ++i)
+    halton_shifts_[i] = uniform();
+  // the first point of each sequence is 0
+  halton_index_ = 1;
+}
+
+inline double MultivariateGaussian::getHaltonPoint(unsigned int index, const int base) const
+{
+  // radical inverse of the index in the given base
+  double point = 0.0;
+  double fraction = 1.0 / base;
+  while (index > 0)
+  {
+    point += fraction * (index % base);
+    index /= base;
+    fraction /= base;
+  }
+  return point;
+}
+
 }
 
 #endif /* MULTIVARIATE_GAUSSIAN_H_ */
@@ -53,12 +53,10 @@ struct Rollout
     std::vector<Eigen::VectorXd> noise_;                            /**< [num_dimensions] num_parameters */
     std::vector<std::vector<Eigen::VectorXd> > noise_projected_;    /**< [num_dimensions][num_time_steps] num_parameters */
     std::vector<std::vector<Eigen::VectorXd> > parameters_noise_projected_;    /**< [num_dimensions][num_time_steps] num_parameters */
+    std::vector<Eigen::VectorXd> noise_projection_scales_;          /**< [num_dimensions] num_time_steps: g_t^T noise */
     Eigen::VectorXd state_costs_;                                   /**< num_time_steps */
     double terminal_cost_;
     std::vector<Eigen::VectorXd> control_costs_;                    /**< [num_dimensions] num_time_steps */
-    std::vector<Eigen::VectorXd> total_costs_;                      /**< [num_dimensions] num_time_steps */
-    std::vector<Eigen::VectorXd> cumulative_costs_;                 /**< [num_dimensions] num_time_steps */
-    std::vector<Eigen::VectorXd> probabilities_;                    /**< [num_dimensions] num_time_steps */
 
     int iteration_;                                                 /**< Which iteration did this rollout arise from? */
     double getCost();   /**< Gets the rollout cost = state cost + control costs per dimension */
@@ -135,6 +133,21 @@ public:
      */
     bool getTimeStepWeights(std::vector<Eigen::VectorXd>& time_step_weights);
 
+    /**
+     * Sets the number of threads improvePolicy() distributes the dimensions over (defaults to 1).
+     * The parameter updates do not depend on the number of threads.
+     * @param num_threads
+     * @return
+     */
+    bool setNumThreads(const int num_threads);
+
+    /**
+     * Sets how the noise of new rollouts is sampled (defaults to MultivariateGaussian::MONTE_CARLO)
+     * @param sampling_method
+     * @return
+     */
+    bool setNoiseSamplingMethod(const MultivariateGaussian::SamplingMethod sampling_method);
+
 private:
 
     bool initialized_;
@@ -169,23 +182,40 @@ private:
     std::vector<Rollout> extra_rollouts_;
 
     std::vector<MultivariateGaussian> noise_generators_;                    /**< objects that generate noise for each dimension */
-    std::vector<std::vector<Eigen::MatrixXd> > projection_matrices_;        /**< noise projection_matrices[dimension][time_step] */
+    MultivariateGaussian::SamplingMethod noise_sampling_method_;
+    std::vector<Eigen::MatrixXd> projection_factors_;                       /**< [num_dimensions] num_time_steps x num_parameters: row t is (R^-1 g_t / g_t^T R^-1 g_t)^T */
     std::vector<Eigen::MatrixXd> parameter_updates_;                        /**< [num_dimensions] num_time_steps x num_parameters */
     std::vector<Eigen::VectorXd> time_step_weights_;                        /**< [num_dimensions] num_time_steps: Weights computed for updates per time-step */
 
+    int num_threads_;                                                       /**< Number of threads the dimensions are improved on */
+
+    // rollout data of all rollouts, one row per rollout:
+    Eigen::MatrixXd rollout_state_costs_;                                   /**< num_rollouts x num_time_steps */
+    Eigen::VectorXd rollout_terminal_costs_;                                /**< num_rollouts */
+    std::vector<Eigen::MatrixXd> rollout_noise_projection_scales_;          /**< [num_dimensions] num_rollouts x num_time_steps: g_t^T noise */
+    std::vector<Eigen::MatrixXd> rollout_cumulative_costs_;                 /**< [num_dimensions] num_rollouts x num_time_steps */
+    std::vector<Eigen::MatrixXd> rollout_probabilities_;                    /**< [num_dimensions] num_rollouts x num_time_steps */
+
     // temporary variables pre-allocated for efficiency:
-    std::vector<Eigen::VectorXd> tmp_noise_;                /**< [num_dimensions] num_parameters */
+    std::vector<Eigen::MatrixXd> tmp_noise_;                /**< [num_dimensions] num_rollouts x num_parameters */
     std::vector<Eigen::VectorXd> tmp_parameters_;           /**< [num_dimensions] num_parameters */
-    Eigen::VectorXd tmp_sum_rollout_probabilities_;         /**< num_time_steps */
     std::vector<std::pair<double, int> > rollout_cost_sorter_;  /**< vector used for sorting rollouts by their cost */
+    std::vector<Eigen::MatrixXd> tmp_rollout_noise_;        /**< [num_dimensions] num_rollouts x num_parameters */
+    std::vector<Eigen::RowVectorXd> tmp_weighted_noise_projection_scales_;  /**< [num_dimensions] num_time_steps */
     bool preAllocateTempVariables();
-    bool preComputeProjectionMatrices();
+    bool preComputeProjectionFactors();
 
     bool computeProjectedNoise();
     bool computeRolloutControlCosts();
-    bool computeRolloutCumulativeCosts();
-    bool computeRolloutProbabilities();
-    bool computeParameterUpdates();
+
+    /**
+     * The per dimension steps of improvePolicy(), they only write to the data of the given dimension
+     * and therefore can run concurrently for different dimensions.
+     */
+    bool computeRolloutCumulativeCosts(const int dimension);
+    bool computeRolloutProbabilities(const int dimension);
+    bool computeParameterUpdates(const int dimension);
+    void improveDimensions(const int first_dimension, const int dimension_increment);
 
     bool computeNoise(Rollout& rollout);
     bool computeProjectedNoise(Rollout& rollout);
@@ -46,6 +46,8 @@
 #include <policy_improvement/policy_improvement.h>
 #include <usc_utilities/assert.h>
 #include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 USING_PART_OF_NAMESPACE_EIGEN
 using namespace policy_library;
@@ -54,7 +56,7 @@ namespace pi2
 {
 
 PolicyImprovement::PolicyImprovement():
-    initialized_(false)
+    initialized_(false), num_threads_(1), noise_sampling_method_(MultivariateGaussian::MONTE_CARLO)
 {
 }
 
@@ -85,12 +87,13 @@ bool PolicyImprovement::initialize(const int num_rollouts, const int num_time_st
     {
         inv_control_costs_.push_back(control_costs_[d].fullPivLu().inverse());
         MultivariateGaussian mvg(VectorXd::Zero(num_parameters_[d]), inv_control_costs_[d]);
+        mvg.setSamplingMethod(noise_sampling_method_);
         noise_generators_.push_back(mvg);
     }
 
     ROS_VERIFY(setNumRollouts(num_rollouts, num_reused_rollouts, num_extra_rollouts));
     ROS_VERIFY(preAllocateTempVariables());
-    ROS_VERIFY(preComputeProjectionMatrices());
+    ROS_VERIFY(preComputeProjectionFactors());
 
     return (initialized_ = true);
 }
@@ -114,10 +117,8 @@ bool PolicyImprovement::setNumRollouts(const int num_rollouts, const int num_reu
     rollout.noise_.clear();
     rollout.noise_projected_.clear();
     rollout.parameters_noise_projected_.clear();
+    rollout.noise_projection_scales_.clear();
     rollout.control_costs_.clear();
-    rollout.total_costs_.clear();
-    rollout.cumulative_costs_.clear();
-    rollout.probabilities_.clear();
     for (int d=0; d<num_dimensions_; ++d)
     {
         rollout.parameters_.push_back(VectorXd::Zero(num_parameters_[d]));
@@ -129,10 +130,8 @@ bool PolicyImprovement::setNumRollouts(const int num_rollouts, const int num_reu
         }
         rollout.noise_projected_.push_back(tmp_projected_noise);
         rollout.parameters_noise_projected_.push_back(tmp_projected_noise);
+        rollout.noise_projection_scales_.push_back(VectorXd::Zero(num_time_steps_));
         rollout.control_costs_.push_back(VectorXd::Zero(num_time_steps_));
-        rollout.total_costs_.push_back(VectorXd::Zero(num_time_steps_));
-        rollout.cumulative_costs_.push_back(VectorXd::Zero(num_time_steps_));
-        rollout.probabilities_.push_back(VectorXd::Zero(num_time_steps_));
     }
     rollout.state_costs_ = VectorXd::Zero(num_time_steps_);
 
@@ -232,13 +231,14 @@ bool PolicyImprovement::generateRollouts(const std::vector<double>& noise_stddev
         rollouts_reused_ = true;
     }
 
-    // generate new rollouts
+    // generate new rollouts, the noise of all of them is sampled at once
     for (int d=0; d<num_dimensions_; ++d)
     {
+        tmp_noise_[d].resize(num_rollouts_gen_, num_parameters_[d]);
+        noise_generators_[d].sample(tmp_noise_[d]);
         for (int r=0; r<num_rollouts_gen_; ++r)
         {
-            noise_generators_[d].sample(tmp_noise_[d]);
-            rollouts_[r].noise_[d] = noise_stddev[d]*tmp_noise_[d];
+            rollouts_[r].noise_[d] = noise_stddev[d]*tmp_noise_[d].row(r).transpose();
             rollouts_[r].parameters_[d] = parameters_[d] + rollouts_[r].noise_[d];
         }
     }
@@ -294,9 +294,25 @@ bool PolicyImprovement::setRolloutCosts(const Eigen::MatrixXd& costs, const Eige
 
 bool PolicyImprovement::computeProjectedNoise()
 {
-    for (int r=0; r<num_rollouts_; ++r)
+    for (int d=0; d<num_dimensions_; ++d)
     {
-        computeProjectedNoise(rollouts_[r]);
+        // project the noise of all rollouts onto the basis functions with a single matrix product
+        tmp_rollout_noise_[d].resize(num_rollouts_, num_parameters_[d]);
+        for (int r=0; r<num_rollouts_; ++r)
+        {
+            tmp_rollout_noise_[d].row(r) = rollouts_[r].noise_[d].transpose();
+        }
+        rollout_noise_projection_scales_[d] = tmp_rollout_noise_[d] * basis_functions_[d].transpose();
+
+        for (int r=0; r<num_rollouts_; ++r)
+        {
+            rollouts_[r].noise_projection_scales_[d] = rollout_noise_projection_scales_[d].row(r).transpose();
+            for (int t=0; t<num_time_steps_; ++t)
+            {
+                rollouts_[r].noise_projected_[d][t] = rollout_noise_projection_scales_[d](r, t) * projection_factors_[d].row(t).transpose();
+                rollouts_[r].parameters_noise_projected_[d][t] = rollouts_[r].parameters_[d] + rollouts_[r].noise_projected_[d][t];
+            }
+        }
     }
     return true;
 }
@@ -310,107 +326,116 @@ bool PolicyImprovement::computeRolloutControlCosts()
     return true;
 }
 
-bool PolicyImprovement::computeRolloutCumulativeCosts()
+bool PolicyImprovement::computeRolloutCumulativeCosts(const int d)
 {
-    // compute cumulative costs at each timestep
+    MatrixXd& cumulative_costs = rollout_cumulative_costs_[d];
+    cumulative_costs.resize(num_rollouts_, num_time_steps_);
     for (int r=0; r<num_rollouts_; ++r)
     {
-        for (int d=0; d<num_dimensions_; ++d)
+        cumulative_costs.row(r) = rollouts_[r].control_costs_[d].transpose();
+    }
+    cumulative_costs += rollout_state_costs_;
+
+    if (use_cumulative_costs_)
+    {
+        // add the terminal cost to the last state cost, and perform backwards cumulation
+        cumulative_costs.col(num_time_steps_-1) += rollout_terminal_costs_;
+        for (int t=num_time_steps_-2; t>=0; --t)
         {
-            rollouts_[r].total_costs_[d] = rollouts_[r].state_costs_ + rollouts_[r].control_costs_[d];
-            rollouts_[r].cumulative_costs_[d] = rollouts_[r].total_costs_[d];
-            if (use_cumulative_costs_)
-            {
-              // add the terminal cost to the last state cost, and perform backwards cumulation
-              rollouts_[r].cumulative_costs_[d](num_time_steps_-1) += rollouts_[r].terminal_cost_;
-              for (int t=num_time_steps_-2; t>=0; --t)
-              {
-                  rollouts_[r].cumulative_costs_[d](t) += rollouts_[r].cumulative_costs_[d](t+1);
-              }
-            }
-            else
-            {
-              // just add the terminal cost to all state costs
-              for (int t=num_time_steps_-1; t>=0; --t)
-              {
-                rollouts_[r].cumulative_costs_[d](t) += rollouts_[r].terminal_cost_;
-              }
-            }
+            cumulative_costs.col(t) += cumulative_costs.col(t+1);
+        }
+    }
+    else
+    {
+        // just add the terminal cost to all state costs
+        for (int t=0; t<num_time_steps_; ++t)
+        {
+            cumulative_costs.col(t) += rollout_terminal_costs_;
         }
     }
     return true;
 }
 
-bool PolicyImprovement::computeRolloutProbabilities()
+bool PolicyImprovement::computeRolloutProbabilities(const int d)
 {
-    for (int d=0; d<num_dimensions_; ++d)
-    {
+    const MatrixXd& cumulative_costs = rollout_cumulative_costs_[d];
+    MatrixXd& probabilities = rollout_probabilities_[d];
+    probabilities.resize(num_rollouts_, num_time_steps_);
 
-        for (int t=0; t<num_time_steps_; t++)
-        {
+    //time_step_weights_[d] = max_costs - min_costs;
+    time_step_weights_[d].setConstant(1.0);
 
-            // find min and max cost over all rollouts:
-            double min_cost = rollouts_[0].cumulative_costs_[d](t);
-            double max_cost = min_cost;
-            for (int r=1; r<num_rollouts_; ++r)
-            {
-                double c = rollouts_[r].cumulative_costs_[d](t);
-                if (c < min_cost)
-                    min_cost = c;
-                if (c > max_cost)
-                    max_cost = c;
-            }
-
-            double denom = max_cost - min_cost;
-
-            //time_step_weights_[d][t] = denom;
-            time_step_weights_[d][t] = 1.0;
+    // each column holds the costs of all rollouts at one time step
+    RowVectorXd min_costs = cumulative_costs.colwise().minCoeff();
+    RowVectorXd max_costs = cumulative_costs.colwise().maxCoeff();
+    for (int t=0; t<num_time_steps_; ++t)
+    {
+        double denom = max_costs(t) - min_costs(t);
 
-            // prevent divide by zero:
-            if (denom < 1e-8)
-                denom = 1e-8;
-
-            double p_sum = 0.0;
-            for (int r=0; r<num_rollouts_; ++r)
-            {
-                // the -10.0 here is taken from the paper:
-                rollouts_[r].probabilities_[d](t) = exp(-10.0*(rollouts_[r].cumulative_costs_[d](t) - min_cost)/denom);
-                p_sum += rollouts_[r].probabilities_[d](t);
-            }
-            for (int r=0; r<num_rollouts_; ++r)
-            {
-                rollouts_[r].probabilities_[d](t) /= p_sum;
-            }
-
-        }
+        // prevent divide by zero:
+        if (denom < 1e-8)
+            denom = 1e-8;
 
+        // the -10.0 here is taken from the paper:
+        probabilities.col(t) = ((cumulative_costs.col(t).cwise() - min_costs(t)) * (-10.0 / denom)).cwise().exp();
+    }
+    RowVectorXd sum_probabilities = probabilities.colwise().sum();
+    for (int t=0; t<num_time_steps_; ++t)
+    {
+        probabilities.col(t) /= sum_probabilities(t);
     }
     return true;
 }
 
-bool PolicyImprovement::computeParameterUpdates()
+bool PolicyImprovement::computeParameterUpdates(const int d)
 {
-    for (int d=0; d<num_dimensions_; ++d)
+    // all projected noise vectors of time step t are multiples of the same factor, so are their weighted sums
+    tmp_weighted_noise_projection_scales_[d] = (rollout_probabilities_[d].cwise() * rollout_noise_projection_scales_[d]).colwise().sum();
+    for (int t=0; t<num_time_steps_; ++t)
     {
-        parameter_updates_[d] = MatrixXd::Zero(num_time_steps_, num_parameters_[d]);
-        for (int t=0; t<num_time_steps_; ++t)
-        {
-            for (int r=0; r<num_rollouts_; ++r)
-            {
-                parameter_updates_[d].row(t).transpose() += rollouts_[r].noise_projected_[d][t] * rollouts_[r].probabilities_[d](t);
-            }
-        }
+        parameter_updates_[d].row(t) = tmp_weighted_noise_projection_scales_[d](t) * projection_factors_[d].row(t);
     }
     return true;
 }
 
+void PolicyImprovement::improveDimensions(const int first_dimension, const int dimension_increment)
+{
+    for (int d=first_dimension; d<num_dimensions_; d+=dimension_increment)
+    {
+        computeRolloutCumulativeCosts(d);
+        computeRolloutProbabilities(d);
+        computeParameterUpdates(d);
+    }
+}
+
 bool PolicyImprovement::improvePolicy(std::vector<Eigen::MatrixXd>& parameter_updates)
 {
     ROS_ASSERT(initialized_);
 
-    computeRolloutCumulativeCosts();
-    computeRolloutProbabilities();
-    computeParameterUpdates();
+    // gather the costs that are shared by all dimensions
+    rollout_state_costs_.resize(num_rollouts_, num_time_steps_);
+    rollout_terminal_costs_.resize(num_rollouts_);
+    for (int r=0; r<num_rollouts_; ++r)
+    {
+        rollout_state_costs_.row(r) = rollouts_[r].state_costs_.transpose();
+        rollout_terminal_costs_(r) = rollouts_[r].terminal_cost_;
+    }
+
+    int num_threads = std::min(num_threads_, num_dimensions_);
+    if (num_threads <= 1)
+    {
+        improveDimensions(0, 1);
+    }
+    else
+    {
+        boost::thread_group threads;
+        for (int i=1; i<num_threads; ++i)
+        {
+            threads.create_thread(boost::bind(&PolicyImprovement::improveDimensions, this, i, num_threads));
+        }
+        improveDimensions(0, num_threads);
+        threads.join_all();
+    }
     parameter_updates = parameter_updates_;
 
     return true;
@@ -420,25 +445,39 @@ bool PolicyImprovement::preAllocateTempVariables()
 {
     tmp_noise_.clear();
     tmp_parameters_.clear();
+    tmp_rollout_noise_.clear();
+    tmp_weighted_noise_projection_scales_.clear();
+    rollout_noise_projection_scales_.clear();
+    rollout_cumulative_costs_.clear();
+    rollout_probabilities_.clear();
     parameter_updates_.clear();
+    time_step_weights_.clear();
     for (int d=0; d<num_dimensions_; ++d)
     {
-        tmp_noise_.push_back(VectorXd::Zero(num_parameters_[d]));
+        tmp_noise_.push_back(MatrixXd::Zero(num_rollouts_, num_parameters_[d]));
         tmp_parameters_.push_back(VectorXd::Zero(num_parameters_[d]));
+        tmp_rollout_noise_.push_back(MatrixXd::Zero(num_rollouts_, num_parameters_[d]));
+        tmp_weighted_noise_projection_scales_.push_back(RowVectorXd::Zero(num_time_steps_));
+        rollout_noise_projection_scales_.push_back(MatrixXd::Zero(num_rollouts_, num_time_steps_));
+        rollout_cumulative_costs_.push_back(MatrixXd::Zero(num_rollouts_, num_time_steps_));
+        rollout_probabilities_.push_back(MatrixXd::Zero(num_rollouts_, num_time_steps_));
         parameter_updates_.push_back(MatrixXd::Zero(num_time_steps_, num_parameters_[d]));
         time_step_weights_.push_back(VectorXd::Zero(num_time_steps_));
     }
-    tmp_sum_rollout_probabilities_ = VectorXd::Zero(num_time_steps_);
+    rollout_state_costs_ = MatrixXd::Zero(num_rollouts_, num_time_steps_);
+    rollout_terminal_costs_ = VectorXd::Zero(num_rollouts_);
 
     return true;
 }
 
-bool PolicyImprovement::preComputeProjectionMatrices()
+bool PolicyImprovement::preComputeProjectionFactors()
 {
-    projection_matrices_.clear();
+    // the projection matrix of each time step is the rank one matrix (R^-1 g_t / g_t^T R^-1 g_t) * g_t^T,
+    // only its left factor is stored, the right factor is row t of the basis functions
+    projection_factors_.clear();
     for (int d=0; d<num_dimensions_; ++d)
     {
-        std::vector<MatrixXd> projection_matrices_for_dim;
+        MatrixXd projection_factors_for_dim(num_time_steps_, num_parameters_[d]);
 
         VectorXd basis_function(num_parameters_[d]);
         VectorXd inv_r_times_g(num_parameters_[d]);
@@ -453,10 +492,9 @@ bool PolicyImprovement::preComputeProjectionMatrices()
                 ROS_WARN("Denominator (g_transpose_r_g) is close to 0: %f", g_transpose_r_g);
             }
 
-            // outer product
-            projection_matrices_for_dim.push_back((inv_r_times_g / g_transpose_r_g) * basis_function.transpose());
+            projection_factors_for_dim.row(t) = (inv_r_times_g / g_transpose_r_g).transpose();
         }
-        projection_matrices_.push_back(projection_matrices_for_dim);
+        projection_factors_.push_back(projection_factors_for_dim);
 
     }
     return true;
@@ -498,9 +536,10 @@ bool PolicyImprovement::computeProjectedNoise(Rollout& rollout)
 {
     for (int d=0; d<num_dimensions_; ++d)
     {
+        rollout.noise_projection_scales_[d] = basis_functions_[d] * rollout.noise_[d];
         for (int t=0; t<num_time_steps_; ++t)
         {
-            rollout.noise_projected_[d][t] = projection_matrices_[d][t] * rollout.noise_[d];
+            rollout.noise_projected_[d][t] = rollout.noise_projection_scales_[d](t) * projection_factors_[d].row(t).transpose();
             rollout.parameters_noise_projected_[d][t] = rollout.parameters_[d] + rollout.noise_projected_[d][t];
         }
     }
@@ -530,4 +569,25 @@ bool PolicyImprovement::getTimeStepWeights(std::vector<Eigen::VectorXd>& time_st
   return true;
 }
 
+bool PolicyImprovement::setNoiseSamplingMethod(const MultivariateGaussian::SamplingMethod sampling_method)
+{
+    noise_sampling_method_ = sampling_method;
+    for (int d=0; d<int(noise_generators_.size()); ++d)
+    {
+        noise_generators_[d].setSamplingMethod(sampling_method);
+    }
+    return true;
+}
+
+bool PolicyImprovement::setNumThreads(const int num_threads)
+{
+    if (num_threads < 1)
+    {
+        ROS_ERROR("Number of threads >%i< must be positive.", num_threads);
+        return false;
+    }
+    num_threads_ = num_threads;
+    return true;
+}
+
 };
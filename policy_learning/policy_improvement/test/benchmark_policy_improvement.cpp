@@ -0,0 +1,157 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/** \author Mrinal Kalakrishnan */
+
+// Times the PI^2 update (cumulative costs, probabilities and parameter updates) for
+// rollout/time/parameter sizes as they occur for DMPs and STOMP, serially and on several threads.
+
+#include <boost/shared_ptr.hpp>
+#include <ros/ros.h>
+#include <cstdio>
+#include <cstdlib>
+
+#include <policy_improvement/policy_improvement.h>
+#include "gaussian_basis_policy.h"
+
+USING_PART_OF_NAMESPACE_EIGEN
+using namespace pi2;
+
+/**
+ * Runs num_iterations PI^2 updates and computes the average duration of improvePolicy() in milliseconds
+ */
+static bool benchmarkImprovePolicy(const int num_dimensions, const int num_parameters, const int num_time_steps,
+                                   const int num_rollouts, const int num_threads, const int num_iterations,
+                                   std::vector<Eigen::MatrixXd>& parameter_updates, double& milliseconds)
+{
+    // the noise generators are seeded with rand(), such that all thread counts see the same rollouts
+    srand(0);
+    boost::shared_ptr<policy_library::Policy> policy(new GaussianBasisPolicy(num_dimensions, num_parameters));
+    PolicyImprovement policy_improvement;
+    if (!policy_improvement.initialize(num_rollouts, num_time_steps, 0, 0, policy)
+        || !policy_improvement.setNumThreads(num_threads))
+    {
+        ROS_ERROR("Could not initialize policy improvement.");
+        return false;
+    }
+
+    std::vector<double> noise_stddev(num_dimensions, 1.0);
+    std::vector<std::vector<Eigen::VectorXd> > rollouts;
+    std::vector<double> rollout_costs_total;
+
+    double duration = 0.0;
+    for (int i=0; i<num_iterations; ++i)
+    {
+        if (!policy_improvement.getRollouts(rollouts, noise_stddev))
+        {
+            ROS_ERROR("Could not get rollouts.");
+            return false;
+        }
+        MatrixXd costs = MatrixXd::Zero(rollouts.size(), num_time_steps);
+        VectorXd terminal_costs = VectorXd::Zero(rollouts.size());
+        for (int r=0; r<int(rollouts.size()); ++r)
+        {
+            for (int t=0; t<num_time_steps; ++t)
+            {
+                costs(r, t) = rollouts[r][t % num_dimensions](t % num_parameters) * rollouts[r][0](0);
+            }
+            terminal_costs(r) = rollouts[r][0].squaredNorm();
+        }
+        if (!policy_improvement.setRolloutCosts(costs, terminal_costs, 0.001, rollout_costs_total))
+        {
+            ROS_ERROR("Could not set rollout costs.");
+            return false;
+        }
+
+        ros::WallTime start = ros::WallTime::now();
+        if (!policy_improvement.improvePolicy(parameter_updates))
+        {
+            ROS_ERROR("Could not improve policy.");
+            return false;
+        }
+        duration += (ros::WallTime::now() - start).toSec();
+    }
+    milliseconds = 1000.0 * duration / num_iterations;
+    return true;
+}
+
+static bool benchmark(const int num_dimensions, const int num_parameters, const int num_time_steps, const int num_rollouts)
+{
+    const int NUM_ITERATIONS = 20;
+    const int NUM_THREADS[] = {1, 2, 4};
+
+    std::vector<Eigen::MatrixXd> serial_parameter_updates;
+    for (int i=0; i<int(sizeof(NUM_THREADS)/sizeof(int)); ++i)
+    {
+        std::vector<Eigen::MatrixXd> parameter_updates;
+        double milliseconds = 0.0;
+        if (!benchmarkImprovePolicy(num_dimensions, num_parameters, num_time_steps, num_rollouts,
+                                    NUM_THREADS[i], NUM_ITERATIONS, parameter_updates, milliseconds))
+        {
+            return false;
+        }
+        printf("dimensions: %2i  parameters: %4i  time steps: %5i  rollouts: %3i  threads: %i  improvePolicy: %9.3f ms\n",
+               num_dimensions, num_parameters, num_time_steps, num_rollouts, NUM_THREADS[i], milliseconds);
+
+        if (i == 0)
+        {
+            serial_parameter_updates = parameter_updates;
+            continue;
+        }
+        // the dimensions are independent, therefore the updates must not depend on the number of threads
+        for (int d=0; d<int(parameter_updates.size()); ++d)
+        {
+            if (!(serial_parameter_updates[d] == parameter_updates[d]))
+            {
+                ROS_ERROR("Parameter updates of dimension %i differ with %i threads.", d, NUM_THREADS[i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    // 7 joints, DMPs with 10 and 30 basis functions
+    // 7 joints, STOMP has one parameter per time step
+    if (!benchmark(7, 10, 300, 10)
+        || !benchmark(7, 30, 1000, 20)
+        || !benchmark(7, 100, 100, 10)
+        || !benchmark(7, 200, 200, 20))
+    {
+        return -1;
+    }
+    return 0;
+}
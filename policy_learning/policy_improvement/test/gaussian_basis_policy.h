@@ -0,0 +1,149 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/** \author Mrinal Kalakrishnan */
+
+#ifndef GAUSSIAN_BASIS_POLICY_H_
+#define GAUSSIAN_BASIS_POLICY_H_
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <policy_library/policy.h>
+
+namespace pi2
+{
+
+/**
+ * Policy with normalized Gaussian basis functions and a diagonal control cost matrix,
+ * only provides what PolicyImprovement needs.
+ */
+class GaussianBasisPolicy: public policy_library::Policy
+{
+public:
+    GaussianBasisPolicy(const int num_dimensions, const int num_parameters) :
+        num_dimensions_(num_dimensions), num_parameters_(num_parameters), num_time_steps_(0)
+    {
+        parameters_.resize(num_dimensions_, Eigen::VectorXd::Zero(num_parameters_));
+    }
+    ~GaussianBasisPolicy() {};
+
+    bool setNumTimeSteps(const int num_time_steps)
+    {
+        num_time_steps_ = num_time_steps;
+        return true;
+    }
+    bool getNumTimeSteps(int& num_time_steps)
+    {
+        num_time_steps = num_time_steps_;
+        return true;
+    }
+    bool getNumDimensions(int& num_dimensions)
+    {
+        num_dimensions = num_dimensions_;
+        return true;
+    }
+    bool getNumParameters(std::vector<int>& num_params)
+    {
+        num_params.assign(num_dimensions_, num_parameters_);
+        return true;
+    }
+    bool getBasisFunctions(std::vector<Eigen::MatrixXd>& basis_functions)
+    {
+        Eigen::MatrixXd basis = Eigen::MatrixXd::Zero(num_time_steps_, num_parameters_);
+        double width = 1.0 / num_parameters_;
+        for (int t=0; t<num_time_steps_; ++t)
+        {
+            double phase = double(t) / std::max(num_time_steps_ - 1, 1);
+            for (int p=0; p<num_parameters_; ++p)
+            {
+                double center = (p + 0.5) * width;
+                basis(t, p) = exp(-0.5 * (phase - center) * (phase - center) / (width * width));
+            }
+            basis.row(t) /= basis.row(t).sum();
+        }
+        basis_functions.assign(num_dimensions_, basis);
+        return true;
+    }
+    bool getControlCosts(std::vector<Eigen::MatrixXd>& control_costs)
+    {
+        Eigen::MatrixXd control_cost = Eigen::MatrixXd::Zero(num_parameters_, num_parameters_);
+        for (int p=0; p<num_parameters_; ++p)
+        {
+            control_cost(p, p) = 1.0 + double(p) / num_parameters_;
+        }
+        control_costs.assign(num_dimensions_, control_cost);
+        return true;
+    }
+    bool updateParameters(const std::vector<Eigen::MatrixXd>& updates, const std::vector<Eigen::VectorXd>& time_step_weights)
+    {
+        return true;
+    }
+    bool getParameters(std::vector<Eigen::VectorXd>& parameters)
+    {
+        parameters = parameters_;
+        return true;
+    }
+    bool setParameters(const std::vector<Eigen::VectorXd>& parameters)
+    {
+        parameters_ = parameters;
+        return true;
+    }
+    bool readFromFile(const std::string& abs_file_name)
+    {
+        return true;
+    }
+    bool writeToFile(const std::string& abs_file_name)
+    {
+        return true;
+    }
+    std::string getClassName()
+    {
+        return "GaussianBasisPolicy";
+    }
+
+private:
+    int num_dimensions_;
+    int num_parameters_;
+    int num_time_steps_;
+    std::vector<Eigen::VectorXd> parameters_;
+};
+
+}
+
+#endif /* GAUSSIAN_BASIS_POLICY_H_ */
@@ -0,0 +1,214 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+
+/** \author Mrinal Kalakrishnan */
+
+#include <gtest/gtest.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <policy_improvement/multivariate_gaussian.h>
+#include <policy_improvement/policy_improvement.h>
+#include "gaussian_basis_policy.h"
+
+USING_PART_OF_NAMESPACE_EIGEN
+using namespace pi2;
+
+static const int NUM_VARIABLES = 3;
+
+static VectorXd getMean()
+{
+    VectorXd mean(NUM_VARIABLES);
+    mean << 1.0, -2.0, 0.5;
+    return mean;
+}
+
+static MatrixXd getCovariance()
+{
+    MatrixXd covariance(NUM_VARIABLES, NUM_VARIABLES);
+    covariance << 2.0, 0.5, 0.0,
+                  0.5, 1.0, 0.3,
+                  0.0, 0.3, 0.5;
+    return covariance;
+}
+
+/**
+ * Radical inverse of the index in the given base, the index-th point of the Halton sequence
+ */
+static double getRadicalInverse(int index, const int base)
+{
+    double point = 0.0;
+    double digit_value = 1.0;
+    while (index > 0)
+    {
+        digit_value /= base;
+        point += (index % base) * digit_value;
+        index /= base;
+    }
+    return point;
+}
+
+TEST(MultivariateGaussian, antitheticPairsAreMirroredAtTheMean)
+{
+    MultivariateGaussian gaussian(getMean(), getCovariance());
+    gaussian.setSamplingMethod(MultivariateGaussian::ANTITHETIC);
+    // an odd number of samples leaves the last one unpaired
+    MatrixXd samples(11, NUM_VARIABLES);
+    gaussian.sample(samples);
+    for (int s=0; s+1<samples.rows(); s+=2)
+    {
+        for (int i=0; i<NUM_VARIABLES; ++i)
+        {
+            EXPECT_NEAR(2.0 * getMean()(i), samples(s, i) + samples(s+1, i), 1e-12);
+            EXPECT_GT(fabs(samples(s, i) - getMean()(i)), 0.0);
+        }
+    }
+}
+
+TEST(MultivariateGaussian, haltonMatchesRadicalInverseBeforeShift)
+{
+    // with a standard normal distribution the samples are the inverse normal cdf of the shifted sequence
+    const int num_samples = 50;
+    MultivariateGaussian gaussian(VectorXd::Zero(NUM_VARIABLES), MatrixXd::Identity(NUM_VARIABLES, NUM_VARIABLES));
+    gaussian.setSamplingMethod(MultivariateGaussian::HALTON);
+    const int bases[NUM_VARIABLES] = {2, 3, 5};
+
+    boost::math::normal_distribution<> standard_normal;
+    std::vector<double> shifts(NUM_VARIABLES);
+    MatrixXd samples(num_samples, NUM_VARIABLES);
+    // the sequence continues across calls, it starts at index 1 since the first point is 0
+    for (int call=0; call<2; ++call)
+    {
+        gaussian.sample(samples);
+        for (int s=0; s<num_samples; ++s)
+        {
+            int index = call * num_samples + s + 1;
+            for (int i=0; i<NUM_VARIABLES; ++i)
+            {
+                double shift = boost::math::cdf(standard_normal, samples(s, i)) - getRadicalInverse(index, bases[i]);
+                shift -= floor(shift);
+                if (index == 1)
+                {
+                    shifts[i] = shift;
+                    continue;
+                }
+                // all points of a dimension are shifted by the same amount modulo 1
+                double difference = fabs(shift - shifts[i]);
+                EXPECT_NEAR(0.0, std::min(difference, 1.0 - difference), 1e-9) << "index " << index << " base " << bases[i];
+            }
+        }
+    }
+}
+
+TEST(MultivariateGaussian, sampleMeanAndCovarianceConverge)
+{
+    const int num_samples = 20000;
+    const MultivariateGaussian::SamplingMethod sampling_methods[] = {MultivariateGaussian::MONTE_CARLO,
+                                                                     MultivariateGaussian::ANTITHETIC,
+                                                                     MultivariateGaussian::HALTON};
+    for (int m=0; m<3; ++m)
+    {
+        srand(m);
+        MultivariateGaussian gaussian(getMean(), getCovariance());
+        gaussian.setSamplingMethod(sampling_methods[m]);
+        MatrixXd samples(num_samples, NUM_VARIABLES);
+        gaussian.sample(samples);
+
+        VectorXd mean = VectorXd::Zero(NUM_VARIABLES);
+        for (int s=0; s<num_samples; ++s)
+            mean += samples.row(s).transpose();
+        mean /= num_samples;
+        MatrixXd covariance = MatrixXd::Zero(NUM_VARIABLES, NUM_VARIABLES);
+        for (int s=0; s<num_samples; ++s)
+        {
+            VectorXd deviation = samples.row(s).transpose() - mean;
+            covariance += deviation * deviation.transpose();
+        }
+        covariance /= (num_samples - 1);
+
+        for (int i=0; i<NUM_VARIABLES; ++i)
+        {
+            EXPECT_NEAR(getMean()(i), mean(i), 0.05) << "sampling method " << m;
+            for (int j=0; j<NUM_VARIABLES; ++j)
+                EXPECT_NEAR(getCovariance()(i, j), covariance(i, j), 0.05) << "sampling method " << m;
+        }
+    }
+}
+
+TEST(PolicyImprovement, setNoiseSamplingMethodAppliesToRollouts)
+{
+    const int num_dimensions = 2;
+    const int num_parameters = 5;
+    const int num_time_steps = 20;
+    const int num_rollouts = 10;
+    boost::shared_ptr<policy_library::Policy> policy(new GaussianBasisPolicy(num_dimensions, num_parameters));
+    policy->setNumTimeSteps(num_time_steps);
+    std::vector<VectorXd> parameters(num_dimensions, VectorXd::Constant(num_parameters, 0.3));
+    ASSERT_TRUE(policy->setParameters(parameters));
+
+    // the method is kept if it is set before initialization and changed if it is set afterwards
+    for (int set_before_initialize=0; set_before_initialize<2; ++set_before_initialize)
+    {
+        PolicyImprovement policy_improvement;
+        if (set_before_initialize)
+            ASSERT_TRUE(policy_improvement.setNoiseSamplingMethod(MultivariateGaussian::ANTITHETIC));
+        ASSERT_TRUE(policy_improvement.initialize(num_rollouts, num_time_steps, 0, 0, policy));
+        if (!set_before_initialize)
+            ASSERT_TRUE(policy_improvement.setNoiseSamplingMethod(MultivariateGaussian::ANTITHETIC));
+
+        std::vector<std::vector<VectorXd> > rollouts;
+        ASSERT_TRUE(policy_improvement.getRollouts(rollouts, std::vector<double>(num_dimensions, 0.5)));
+        ASSERT_EQ(num_rollouts, int(rollouts.size()));
+        for (int r=0; r<num_rollouts; r+=2)
+        {
+            for (int d=0; d<num_dimensions; ++d)
+            {
+                for (int p=0; p<num_parameters; ++p)
+                {
+                    EXPECT_NEAR(2.0 * parameters[d](p), rollouts[r][d](p) + rollouts[r+1][d](p), 1e-12);
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,217 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/** \author Mrinal Kalakrishnan */
+
+#include <gtest/gtest.h>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include <policy_improvement/policy_improvement.h>
+#include "gaussian_basis_policy.h"
+
+USING_PART_OF_NAMESPACE_EIGEN
+using namespace pi2;
+
+static const double CONTROL_COST_WEIGHT = 0.001;
+
+/**
+ * The PI^2 update as it was computed before the projections were stored as factor vectors and the
+ * kernels were vectorized: full projection matrices per time step and one loop per rollout and time step.
+ * @param parameters [num_dimensions] num_parameters - parameters the rollouts have been sampled around
+ * @param rollouts [num_rollouts][num_dimensions] num_parameters
+ * @param costs num_rollouts x num_time_steps state costs
+ * @param parameter_updates [num_dimensions] num_time_steps x num_parameters
+ */
+static void computeReferenceUpdates(policy_library::Policy& policy, const std::vector<VectorXd>& parameters,
+                                    const std::vector<std::vector<VectorXd> >& rollouts, const MatrixXd& costs,
+                                    const VectorXd& terminal_costs, const bool use_cumulative_costs,
+                                    std::vector<MatrixXd>& parameter_updates)
+{
+    std::vector<MatrixXd> basis_functions, control_costs;
+    policy.getBasisFunctions(basis_functions);
+    policy.getControlCosts(control_costs);
+    const int num_rollouts = rollouts.size();
+    const int num_time_steps = costs.cols();
+
+    parameter_updates.clear();
+    for (int d=0; d<int(parameters.size()); ++d)
+    {
+        const int num_parameters = parameters[d].size();
+        MatrixXd inv_control_costs = MatrixXd::Zero(num_parameters, num_parameters);
+        for (int p=0; p<num_parameters; ++p)
+        {
+            inv_control_costs(p, p) = 1.0 / control_costs[d](p, p);
+        }
+
+        // projected noise and cumulative costs of all rollouts and time steps
+        std::vector<std::vector<VectorXd> > noise_projected(num_rollouts, std::vector<VectorXd>(num_time_steps));
+        MatrixXd cumulative_costs = MatrixXd::Zero(num_rollouts, num_time_steps);
+        for (int t=0; t<num_time_steps; ++t)
+        {
+            VectorXd basis_function = basis_functions[d].row(t).transpose();
+            VectorXd inv_r_times_g = inv_control_costs * basis_function;
+            MatrixXd projection_matrix = (inv_r_times_g / basis_function.dot(inv_r_times_g)) * basis_function.transpose();
+            for (int r=0; r<num_rollouts; ++r)
+            {
+                noise_projected[r][t] = projection_matrix * (rollouts[r][d] - parameters[d]);
+                // as in the original, the control costs are computed for the rollout parameters plus the projected noise
+                VectorXd parameters_noise_projected = rollouts[r][d] + noise_projected[r][t];
+                double control_cost = 0.5 * CONTROL_COST_WEIGHT * parameters_noise_projected.dot(control_costs[d] * parameters_noise_projected);
+                cumulative_costs(r, t) = costs(r, t) + control_cost;
+            }
+        }
+        for (int r=0; r<num_rollouts; ++r)
+        {
+            if (use_cumulative_costs)
+            {
+                cumulative_costs(r, num_time_steps-1) += terminal_costs(r);
+                for (int t=num_time_steps-2; t>=0; --t)
+                {
+                    cumulative_costs(r, t) += cumulative_costs(r, t+1);
+                }
+            }
+            else
+            {
+                for (int t=0; t<num_time_steps; ++t)
+                {
+                    cumulative_costs(r, t) += terminal_costs(r);
+                }
+            }
+        }
+
+        MatrixXd parameter_update = MatrixXd::Zero(num_time_steps, num_parameters);
+        for (int t=0; t<num_time_steps; ++t)
+        {
+            double min_cost = cumulative_costs(0, t);
+            double max_cost = min_cost;
+            for (int r=1; r<num_rollouts; ++r)
+            {
+                min_cost = std::min(min_cost, cumulative_costs(r, t));
+                max_cost = std::max(max_cost, cumulative_costs(r, t));
+            }
+            double denom = std::max(max_cost - min_cost, 1e-8);
+            std::vector<double> probabilities(num_rollouts);
+            double p_sum = 0.0;
+            for (int r=0; r<num_rollouts; ++r)
+            {
+                probabilities[r] = exp(-10.0*(cumulative_costs(r, t) - min_cost)/denom);
+                p_sum += probabilities[r];
+            }
+            for (int r=0; r<num_rollouts; ++r)
+            {
+                parameter_update.row(t) += (noise_projected[r][t] * (probabilities[r] / p_sum)).transpose();
+            }
+        }
+        parameter_updates.push_back(parameter_update);
+    }
+}
+
+static void testUpdate(const int num_dimensions, const int num_parameters, const int num_time_steps,
+                       const int num_rollouts, const int num_threads, const bool use_cumulative_costs)
+{
+    srand(num_dimensions * num_parameters + num_time_steps);
+    boost::shared_ptr<policy_library::Policy> policy(new GaussianBasisPolicy(num_dimensions, num_parameters));
+    policy->setNumTimeSteps(num_time_steps);
+
+    // the rollouts are sampled around non zero parameters
+    std::vector<VectorXd> parameters(num_dimensions, VectorXd::Zero(num_parameters));
+    for (int d=0; d<num_dimensions; ++d)
+    {
+        for (int p=0; p<num_parameters; ++p)
+        {
+            parameters[d](p) = sin(0.3 * d + 0.1 * p);
+        }
+    }
+    ASSERT_TRUE(policy->setParameters(parameters));
+
+    PolicyImprovement policy_improvement;
+    ASSERT_TRUE(policy_improvement.initialize(num_rollouts, num_time_steps, 0, 0, policy, use_cumulative_costs));
+    ASSERT_TRUE(policy_improvement.setNumThreads(num_threads));
+
+    std::vector<std::vector<VectorXd> > rollouts;
+    ASSERT_TRUE(policy_improvement.getRollouts(rollouts, std::vector<double>(num_dimensions, 0.5)));
+    ASSERT_EQ(num_rollouts, int(rollouts.size()));
+
+    MatrixXd costs = MatrixXd::Zero(num_rollouts, num_time_steps);
+    VectorXd terminal_costs = VectorXd::Zero(num_rollouts);
+    for (int r=0; r<num_rollouts; ++r)
+    {
+        for (int t=0; t<num_time_steps; ++t)
+        {
+            costs(r, t) = rollouts[r][t % num_dimensions](t % num_parameters) * rollouts[r][0](0);
+        }
+        terminal_costs(r) = rollouts[r][0].squaredNorm();
+    }
+    std::vector<double> rollout_costs_total;
+    ASSERT_TRUE(policy_improvement.setRolloutCosts(costs, terminal_costs, CONTROL_COST_WEIGHT, rollout_costs_total));
+
+    std::vector<MatrixXd> parameter_updates;
+    ASSERT_TRUE(policy_improvement.improvePolicy(parameter_updates));
+
+    std::vector<MatrixXd> reference_parameter_updates;
+    computeReferenceUpdates(*policy, parameters, rollouts, costs, terminal_costs, use_cumulative_costs, reference_parameter_updates);
+
+    ASSERT_EQ(reference_parameter_updates.size(), parameter_updates.size());
+    for (int d=0; d<num_dimensions; ++d)
+    {
+        ASSERT_EQ(num_time_steps, parameter_updates[d].rows());
+        ASSERT_EQ(num_parameters, parameter_updates[d].cols());
+        for (int t=0; t<num_time_steps; ++t)
+        {
+            for (int p=0; p<num_parameters; ++p)
+            {
+                double reference = reference_parameter_updates[d](t, p);
+                EXPECT_NEAR(reference, parameter_updates[d](t, p), 1e-9 * std::max(1.0, fabs(reference)));
+            }
+        }
+    }
+}
+
+TEST(PolicyImprovement, updateMatchesProjectionMatrices)
+{
+    // DMP sized (few basis functions, many time steps) and STOMP sized (one parameter per time step) problems
+    testUpdate(3, 10, 100, 10, 1, true);
+    testUpdate(3, 10, 100, 10, 1, false);
+    testUpdate(7, 30, 50, 15, 3, true);
+    testUpdate(2, 40, 40, 10, 2, true);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -47,6 +47,7 @@
 
 #include <policy_improvement/policy_improvement.h>
 #include <policy_improvement_loop/PolicyImprovementStatistics.h>
+#include <policy_improvement_loop/policy_improvement_writer.h>
 
 namespace policy_improvement_loop
 {
@@ -78,14 +79,21 @@ private:
     bool use_cumulative_costs_;
     bool reevaluate_reused_rollouts_;
     std::string filename_prefix_;
+    bool write_rollout_policies_;                 /**< write the policy of each rollout to its own file (read by MixedPolicy users) instead of the statistics bag */
+    bool write_parameter_deltas_;
+    int writer_queue_size_;
+    std::string noise_sampling_method_;           /**< "monte_carlo", "antithetic" or "halton" */
+    int num_rollout_threads_;                     /**< rollouts are executed concurrently on clones of the task if > 1 */
 
     boost::shared_ptr<task_manager_interface::Task> task_;
+    std::vector<boost::shared_ptr<task_manager_interface::Task> > rollout_tasks_; /**< [num_rollout_threads] task_ followed by its clones */
     boost::shared_ptr<policy_library::Policy> policy_;
     task_manager::TaskManager task_manager_;
 
     pi2::PolicyImprovement policy_improvement_;
 
     ros::Publisher stats_publisher_;
+    PolicyImprovementWriter writer_;
 
     std::vector<std::vector<Eigen::VectorXd> > rollouts_; /**< [num_rollouts][num_dimensions] num_parameters */
     std::vector<Eigen::MatrixXd> parameter_updates_;
@@ -99,15 +107,19 @@ private:
 
     // temporary variables
     Eigen::VectorXd tmp_rollout_cost_;
+    std::vector<Eigen::VectorXd> tmp_worker_rollout_costs_;  /**< [num_rollout_threads] num_time_steps */
+    std::vector<int> worker_succeeded_;                      /**< [num_rollout_threads] */
 
     bool readParameters();
 
+    bool createRolloutTasks();
+    bool executeRollouts(const int iteration_number);
+    void executeRolloutsWorker(const int worker, const int iteration_number);
+
     int policy_iteration_counter_;
     bool readPolicy(const int iteration_number);
     bool writePolicy(const int iteration_number, bool is_rollout = false, int rollout_id = 0);
 
-    bool writePolicyImprovementStatistics(const policy_improvement_loop::PolicyImprovementStatistics& stats_msg);
-
     std::string getFileName(int iteration_number);
 };
 
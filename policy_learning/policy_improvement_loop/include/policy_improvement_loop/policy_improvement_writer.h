@@ -0,0 +1,130 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks      Writes the learning statistics and policy parameters of
+                the policy improvement loop to a bag file on a background
+                thread.
+
+  \file         policy_improvement_writer.h
+
+  \author       Peter Pastor
+  \date         Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef POLICY_IMPROVEMENT_WRITER_H_
+#define POLICY_IMPROVEMENT_WRITER_H_
+
+// system includes
+#include <deque>
+#include <string>
+#include <vector>
+#include <rosbag/bag.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <Eigen/Core>
+
+// local includes
+#include <policy_improvement_loop/PolicyImprovementStatistics.h>
+#include <policy_improvement_loop/PolicyParameters.h>
+
+namespace policy_improvement_loop
+{
+
+/*! Writes to the statistics bag from a background thread, such that the learning loop only blocks if the bounded
+ *  queue is full. The writer thread takes all queued messages at once, appends them to the bag and closes it again,
+ *  i.e. the bag on disk is complete after every iteration. Statistics are written to the topic
+ *  "policy_improvement_statistics", rollout and policy parameters to "policy_parameters".
+ */
+class PolicyImprovementWriter
+{
+
+public:
+
+  /*! Constructor
+   */
+  PolicyImprovementWriter();
+  /*! Destructor, writes all queued messages and closes the bag
+   */
+  virtual ~PolicyImprovementWriter();
+
+  /*! Starts the writer thread. The bag is created (or appended to if the first message is not from iteration 1)
+   *  once the first message arrives, later batches are appended to it.
+   * @param abs_bag_file_name
+   * @param max_queue_size Number of messages that can be queued before the add functions block
+   * @param write_parameter_deltas Write parameters relative to the most recent policy parameters
+   * @return True on success, otherwise False
+   */
+  bool initialize(const std::string& abs_bag_file_name,
+                  const int max_queue_size,
+                  const bool write_parameter_deltas);
+
+  /*!
+   * @param statistics
+   * @return True on success, False if the writer is not initialized or failed to write
+   */
+  bool addStatistics(const PolicyImprovementStatistics& statistics);
+
+  /*!
+   * @param iteration
+   * @param rollout The rollout index, -1 for the updated policy
+   * @param parameters [num_dimensions] num_parameters
+   * @return True on success, False if the writer is not initialized or failed to write
+   */
+  bool addParameters(const int iteration,
+                     const int rollout,
+                     const std::vector<Eigen::VectorXd>& parameters);
+
+  /*! Blocks until all queued messages are written and the bag is closed
+   * @return True if all messages have been written, False if writing failed
+   */
+  bool waitForWrites();
+
+  /*! Blocks until all queued messages are written and stops the writer thread
+   */
+  void shutdown();
+
+private:
+
+  struct Message
+  {
+    boost::shared_ptr<PolicyImprovementStatistics> statistics;
+    boost::shared_ptr<PolicyParameters> parameters;
+  };
+
+  bool add(const Message& message);
+  void run();
+  bool write(Message& message);
+  bool open(const int iteration);
+  bool close();
+
+  std::string abs_bag_file_name_;
+  int max_queue_size_;
+  bool write_parameter_deltas_;
+
+  boost::mutex mutex_;
+  boost::condition_variable queue_not_empty_;
+  boost::condition_variable queue_not_full_;
+  boost::condition_variable batch_written_;
+  std::deque<Message> queue_;
+  bool running_;
+  bool writing_;
+  bool failed_;
+  boost::scoped_ptr<boost::thread> thread_;
+
+  /*! Only accessed by the writer thread
+   */
+  rosbag::Bag bag_;
+  bool bag_open_;
+  bool bag_created_;
+  std::vector<double> policy_parameters_;
+  std::vector<Message> batch_;
+
+};
+
+}
+
+#endif /* POLICY_IMPROVEMENT_WRITER_H_ */
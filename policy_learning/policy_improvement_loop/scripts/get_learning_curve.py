@@ -8,7 +8,7 @@ import math
 
 f = open('learning_curve.txt','w')
 bag=rosbag.Bag(sys.argv[1])
-for topic, msg, t in bag.read_messages():
+for topic, msg, t in bag.read_messages(topics=['policy_improvement_statistics']):
   f.write(str(msg.noiseless_cost) + '\n')
 bag.close()
 f.close()
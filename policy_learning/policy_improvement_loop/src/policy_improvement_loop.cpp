@@ -36,6 +36,7 @@
 
 // system includes
 #include <cassert>
+#include <algorithm>
 
 // ros includes
 #include <ros/package.h>
@@ -45,6 +46,8 @@
 
 #include <task_manager/task_manager.h>
 #include <boost/filesystem.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 using namespace task_manager;
 using namespace task_manager_interface;
@@ -53,6 +56,7 @@ namespace policy_improvement_loop
 {
 
 const std::string PI_STATISTICS_TOPIC_NAME = std::string("policy_improvement_statistics");
+const std::string PI_STATISTICS_FILE_NAME = std::string("/tmp/pi2_statistics/pi2_statistics.bag");
 
 PolicyImprovementLoop::PolicyImprovementLoop()
     : initialized_(false), policy_iteration_counter_(0)
@@ -105,12 +109,33 @@ bool PolicyImprovementLoop::initialize(ros::NodeHandle& node_handle, boost::shar
     ROS_ASSERT(num_dimensions_ == static_cast<int>(noise_stddev_.size()));
     ROS_INFO("Learning policy with %i dimensions.", num_dimensions_);
 
+    pi2::MultivariateGaussian::SamplingMethod sampling_method = pi2::MultivariateGaussian::MONTE_CARLO;
+    if (noise_sampling_method_ == "antithetic")
+    {
+        sampling_method = pi2::MultivariateGaussian::ANTITHETIC;
+    }
+    else if (noise_sampling_method_ == "halton")
+    {
+        sampling_method = pi2::MultivariateGaussian::HALTON;
+    }
+    else if (noise_sampling_method_ != "monte_carlo")
+    {
+        ROS_ERROR("Unknown noise sampling method >%s<.", noise_sampling_method_.c_str());
+        return false;
+    }
+    ROS_VERIFY(policy_improvement_.setNoiseSamplingMethod(sampling_method));
     policy_improvement_.initialize(num_rollouts_, num_time_steps_, num_reused_rollouts_, 1, policy_, use_cumulative_costs_, reevaluate_reused_rollouts_);
 
     tmp_rollout_cost_ = Eigen::VectorXd::Zero(num_time_steps_);
     rollout_costs_ = Eigen::MatrixXd::Zero(num_rollouts_, num_time_steps_);
     rollout_terminal_costs_ = Eigen::VectorXd::Zero(num_rollouts_);
     time_step_weights_.resize(num_dimensions_, Eigen::VectorXd::Zero(num_time_steps_));
+    ROS_VERIFY(createRolloutTasks());
+
+    if (write_to_file_)
+    {
+        ROS_VERIFY(writer_.initialize(PI_STATISTICS_FILE_NAME, writer_queue_size_, write_parameter_deltas_));
+    }
 
     // create the statistics publisher
     stats_publisher_ = node_handle_.advertise<policy_improvement_loop::PolicyImprovementStatistics>(PI_STATISTICS_TOPIC_NAME, 100);
@@ -131,9 +156,83 @@ bool PolicyImprovementLoop::readParameters()
     node_handle_.param("filename_prefix", filename_prefix_, std::string("/tmp/pi"));
     node_handle_.param("use_cumulative_costs", use_cumulative_costs_, true);
     node_handle_.param("reevaluate_reused_rollouts", reevaluate_reused_rollouts_, false);
+    node_handle_.param("noise_sampling_method", noise_sampling_method_, std::string("monte_carlo"));
+    node_handle_.param("num_rollout_threads", num_rollout_threads_, 1);
+    node_handle_.param("write_rollout_policies", write_rollout_policies_, false);
+    node_handle_.param("write_parameter_deltas", write_parameter_deltas_, false);
+    node_handle_.param("writer_queue_size", writer_queue_size_, 100);
+    if (num_rollout_threads_ < 1)
+    {
+        ROS_ERROR("Number of rollout threads >%i< must be positive.", num_rollout_threads_);
+        return false;
+    }
     return true;
 }
 
+bool PolicyImprovementLoop::createRolloutTasks()
+{
+    rollout_tasks_.clear();
+    rollout_tasks_.push_back(task_);
+    for (int i=1; i<num_rollout_threads_; ++i)
+    {
+        boost::shared_ptr<Task> clone;
+        if (!task_->clone(clone))
+        {
+            ROS_WARN("Task cannot be cloned, executing rollouts sequentially.");
+            rollout_tasks_.resize(1);
+            break;
+        }
+        rollout_tasks_.push_back(clone);
+    }
+    tmp_worker_rollout_costs_.assign(rollout_tasks_.size(), Eigen::VectorXd::Zero(num_time_steps_));
+    worker_succeeded_.assign(rollout_tasks_.size(), 0);
+    return true;
+}
+
+bool PolicyImprovementLoop::executeRollouts(const int iteration_number)
+{
+    int num_workers = std::min(static_cast<int>(rollout_tasks_.size()), static_cast<int>(rollouts_.size()));
+    if (num_workers <= 1)
+    {
+        executeRolloutsWorker(0, iteration_number);
+        return worker_succeeded_[0];
+    }
+
+    boost::thread_group workers;
+    for (int w=1; w<num_workers; ++w)
+    {
+        workers.create_thread(boost::bind(&PolicyImprovementLoop::executeRolloutsWorker, this, w, iteration_number));
+    }
+    executeRolloutsWorker(0, iteration_number);
+    workers.join_all();
+
+    for (int w=0; w<num_workers; ++w)
+    {
+        if (!worker_succeeded_[w])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PolicyImprovementLoop::executeRolloutsWorker(const int worker, const int iteration_number)
+{
+    // rollout r is always executed by worker r % num_workers and its costs are written to row r
+    int num_workers = std::min(static_cast<int>(rollout_tasks_.size()), static_cast<int>(rollouts_.size()));
+    worker_succeeded_[worker] = 1;
+    for (int r=worker; r<int(rollouts_.size()); r+=num_workers)
+    {
+        if (!rollout_tasks_[worker]->execute(rollouts_[r], tmp_worker_rollout_costs_[worker], rollout_terminal_costs_[r], iteration_number, r))
+        {
+            ROS_ERROR("Could not execute rollout >%i<.", r+1);
+            worker_succeeded_[worker] = 0;
+            return;
+        }
+        rollout_costs_.row(r) = tmp_worker_rollout_costs_[worker].transpose();
+    }
+}
+
 bool PolicyImprovementLoop::readPolicy(const int iteration_number)
 {
     // check whether reading the policy from file is neccessary
@@ -144,6 +243,8 @@ bool PolicyImprovementLoop::readPolicy(const int iteration_number)
     ROS_INFO("Read policy from file %s.", getFileName(iteration_number).c_str());
     ROS_VERIFY(policy_->readFromFile(getFileName(iteration_number)));
     ROS_VERIFY(task_->setPolicy(policy_));
+    // the clones need to be created from the task with the new policy
+    ROS_VERIFY(createRolloutTasks());
     return true;
 }
 
@@ -237,16 +338,25 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     // get rollouts and execute them
     ROS_VERIFY(policy_improvement_.getRollouts(rollouts_, noise));
 
+    ROS_VERIFY(executeRollouts(iteration_number));
+    // the statistics bag is a log, failing to write it does not stop learning
+    bool statistics_written = true;
     for (int r=0; r<int(rollouts_.size()); ++r)
     {
-        ROS_VERIFY(task_->execute(rollouts_[r], tmp_rollout_cost_, rollout_terminal_costs_[r], iteration_number));
-        rollout_costs_.row(r) = tmp_rollout_cost_.transpose();
-        ROS_INFO("Rollout %d, cost = %lf", r+1, tmp_rollout_cost_.sum() + rollout_terminal_costs_[r]);
+        ROS_INFO("Rollout %d, cost = %lf", r+1, rollout_costs_.row(r).sum() + rollout_terminal_costs_[r]);
 
         if (write_to_file_)
         {
-            // store updated policy to disc
-            ROS_VERIFY(writePolicy(iteration_number, true, r));
+            if (write_rollout_policies_)
+            {
+                // store updated policy to disc
+                ROS_VERIFY(writePolicy(iteration_number, true, r));
+            }
+            else
+            {
+                // store the rollout parameters in the statistics bag (on the writer thread)
+                statistics_written = writer_.addParameters(iteration_number, r, rollouts_[r]) && statistics_written;
+            }
         }
     }
 
@@ -268,7 +378,7 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     // get a noise-less rollout to check the cost
     ROS_VERIFY(policy_->getParameters(parameters_));
     double terminal_cost=0.0;
-    ROS_VERIFY(task_->execute(parameters_, tmp_rollout_cost_, terminal_cost, iteration_number));
+    ROS_VERIFY(task_->execute(parameters_, tmp_rollout_cost_, terminal_cost, iteration_number, Task::NOISELESS_ROLLOUT));
     stats_msg.noiseless_cost = tmp_rollout_cost_.sum() + terminal_cost;
     ROS_INFO("Noiseless cost = %lf", stats_msg.noiseless_cost);
     stats_msg.iteration = iteration_number;
@@ -288,7 +398,13 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     {
         // store updated policy to disc
         ROS_VERIFY(writePolicy(iteration_number));
-        ROS_VERIFY(writePolicyImprovementStatistics(stats_msg));
+        statistics_written = writer_.addParameters(iteration_number, -1, parameters_) && statistics_written;
+        statistics_written = writer_.addStatistics(stats_msg) && statistics_written;
+        if (!statistics_written)
+        {
+            ROS_ERROR("Could not write statistics of iteration %i to %s, continuing without them.",
+                      iteration_number, PI_STATISTICS_FILE_NAME.c_str());
+        }
     }
 
     ROS_INFO_STREAM(stats_msg);
@@ -297,46 +413,6 @@ bool PolicyImprovementLoop::runSingleIteration(const int iteration_number)
     return true;
 }
 
-bool PolicyImprovementLoop::writePolicyImprovementStatistics(const policy_improvement_loop::PolicyImprovementStatistics& stats_msg)
-{
-
-    std::string directory_name = std::string("/tmp/pi2_statistics/");
-    std::string file_name = directory_name;
-    file_name.append(std::string("pi2_statistics.bag"));
-
-    if (!boost::filesystem::exists(directory_name))
-    {
-        if(stats_msg.iteration == 1)
-        {
-            boost::filesystem::remove_all(directory_name);
-        }
-        ROS_INFO("Creating directory %s...", directory_name.c_str());
-        ROS_VERIFY(boost::filesystem::create_directories(directory_name));
-    }
-
-    try
-    {
-        if(stats_msg.iteration == 1)
-        {
-            rosbag::Bag bag(file_name, rosbag::bagmode::Write);
-            bag.write(PI_STATISTICS_TOPIC_NAME, ros::Time::now(), stats_msg);
-            bag.close();
-        }
-        else
-        {
-            rosbag::Bag bag(file_name, rosbag::bagmode::Append);
-            bag.write(PI_STATISTICS_TOPIC_NAME, ros::Time::now(), stats_msg);
-            bag.close();
-        }
-    }
-    catch (rosbag::BagIOException ex)
-    {
-        ROS_ERROR("Could write to bag file %s: %s", file_name.c_str(), ex.what());
-        return false;
-    }
-    return true;
-}
-
 std::string PolicyImprovementLoop::getFileName(int iteration_number)
 {
   return filename_prefix_+"_"+usc_utilities::getString(iteration_number);
@@ -0,0 +1,280 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks      ...
+
+  \file         policy_improvement_writer.cpp
+
+  \author       Peter Pastor
+  \date         Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+// local includes
+#include <policy_improvement_loop/policy_improvement_writer.h>
+
+namespace policy_improvement_loop
+{
+
+static const std::string STATISTICS_TOPIC_NAME = std::string("policy_improvement_statistics");
+static const std::string PARAMETERS_TOPIC_NAME = std::string("policy_parameters");
+
+PolicyImprovementWriter::PolicyImprovementWriter() :
+  max_queue_size_(0), write_parameter_deltas_(false), running_(false), writing_(false), failed_(false),
+  bag_open_(false), bag_created_(false)
+{
+}
+
+PolicyImprovementWriter::~PolicyImprovementWriter()
+{
+  shutdown();
+}
+
+bool PolicyImprovementWriter::initialize(const std::string& abs_bag_file_name,
+                                         const int max_queue_size,
+                                         const bool write_parameter_deltas)
+{
+  shutdown();
+  if(max_queue_size < 1)
+  {
+    ROS_ERROR("Queue size >%i< of the policy improvement writer must be positive.", max_queue_size);
+    return false;
+  }
+  abs_bag_file_name_ = abs_bag_file_name;
+  max_queue_size_ = max_queue_size;
+  write_parameter_deltas_ = write_parameter_deltas;
+  policy_parameters_.clear();
+  bag_created_ = false;
+  failed_ = false;
+  running_ = true;
+  thread_.reset(new boost::thread(boost::bind(&PolicyImprovementWriter::run, this)));
+  return true;
+}
+
+bool PolicyImprovementWriter::addStatistics(const PolicyImprovementStatistics& statistics)
+{
+  Message message;
+  message.statistics.reset(new PolicyImprovementStatistics(statistics));
+  return add(message);
+}
+
+bool PolicyImprovementWriter::addParameters(const int iteration,
+                                            const int rollout,
+                                            const std::vector<Eigen::VectorXd>& parameters)
+{
+  Message message;
+  message.parameters.reset(new PolicyParameters());
+  message.parameters->iteration = iteration;
+  message.parameters->rollout = rollout;
+  message.parameters->delta = false;
+  int num_parameters = 0;
+  message.parameters->num_parameters.resize(parameters.size());
+  for (int d = 0; d < (int)parameters.size(); ++d)
+  {
+    message.parameters->num_parameters[d] = parameters[d].size();
+    num_parameters += parameters[d].size();
+  }
+  message.parameters->parameters.resize(num_parameters);
+  int index = 0;
+  for (int d = 0; d < (int)parameters.size(); ++d)
+  {
+    for (int i = 0; i < parameters[d].size(); ++i)
+    {
+      message.parameters->parameters[index++] = parameters[d](i);
+    }
+  }
+  return add(message);
+}
+
+bool PolicyImprovementWriter::add(const Message& message)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  if(!running_ || failed_)
+  {
+    return false;
+  }
+  while((int)queue_.size() >= max_queue_size_ && !failed_)
+  {
+    queue_not_full_.wait(lock);
+  }
+  queue_.push_back(message);
+  queue_not_empty_.notify_one();
+  return true;
+}
+
+bool PolicyImprovementWriter::waitForWrites()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  while((!queue_.empty() || writing_) && thread_)
+  {
+    batch_written_.wait(lock);
+  }
+  return !failed_;
+}
+
+void PolicyImprovementWriter::shutdown()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    running_ = false;
+    queue_not_empty_.notify_all();
+  }
+  if(thread_)
+  {
+    thread_->join();
+    thread_.reset();
+  }
+}
+
+void PolicyImprovementWriter::run()
+{
+  while(true)
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while(queue_.empty() && running_)
+      {
+        queue_not_empty_.wait(lock);
+      }
+      if(queue_.empty())
+      {
+        break;
+      }
+      // take all queued messages at once, the learning loop can continue to add while they are written
+      batch_.assign(queue_.begin(), queue_.end());
+      queue_.clear();
+      writing_ = true;
+      queue_not_full_.notify_all();
+    }
+
+    bool batch_written = true;
+    for (int i = 0; i < (int)batch_.size() && batch_written; ++i)
+    {
+      batch_written = write(batch_[i]);
+    }
+    // close the bag after each batch such that a crash does not lose the iterations written so far
+    batch_written = close() && batch_written;
+    batch_.clear();
+
+    boost::mutex::scoped_lock lock(mutex_);
+    if(!batch_written)
+    {
+      failed_ = true;
+      queue_.clear();
+      queue_not_full_.notify_all();
+    }
+    writing_ = false;
+    batch_written_.notify_all();
+  }
+}
+
+bool PolicyImprovementWriter::open(const int iteration)
+{
+  boost::filesystem::path bag_file_path(abs_bag_file_name_);
+  try
+  {
+    if(bag_file_path.has_parent_path() && !boost::filesystem::exists(bag_file_path.parent_path()))
+    {
+      ROS_INFO("Creating directory %s...", bag_file_path.parent_path().string().c_str());
+      boost::filesystem::create_directories(bag_file_path.parent_path());
+    }
+    // continue the bag file of a previous batch or session, unless learning starts over
+    if((bag_created_ || iteration > 1) && boost::filesystem::exists(bag_file_path))
+    {
+      bag_.open(abs_bag_file_name_, rosbag::bagmode::Append);
+    }
+    else
+    {
+      bag_.open(abs_bag_file_name_, rosbag::bagmode::Write);
+    }
+  }
+  catch (boost::filesystem::filesystem_error& ex)
+  {
+    ROS_ERROR("Could not create directory for bag file %s: %s", abs_bag_file_name_.c_str(), ex.what());
+    return false;
+  }
+  catch (rosbag::BagException& ex)
+  {
+    ROS_ERROR("Could not open bag file %s: %s", abs_bag_file_name_.c_str(), ex.what());
+    return false;
+  }
+  bag_created_ = true;
+  return (bag_open_ = true);
+}
+
+bool PolicyImprovementWriter::close()
+{
+  if(!bag_open_)
+  {
+    return true;
+  }
+  bag_open_ = false;
+  try
+  {
+    bag_.close();
+  }
+  catch (rosbag::BagException& ex)
+  {
+    ROS_ERROR("Could not close bag file %s: %s", abs_bag_file_name_.c_str(), ex.what());
+    return false;
+  }
+  return true;
+}
+
+bool PolicyImprovementWriter::write(Message& message)
+{
+  int iteration = message.statistics ? message.statistics->iteration : message.parameters->iteration;
+  if(!bag_open_ && !open(iteration))
+  {
+    return false;
+  }
+
+  if(message.parameters && write_parameter_deltas_)
+  {
+    std::vector<double>& parameters = message.parameters->parameters;
+    std::vector<double> absolute_parameters;
+    if(message.parameters->rollout < 0)
+    {
+      absolute_parameters = parameters;
+    }
+    // the first policy (and the rollouts before it) are written as they are
+    if(policy_parameters_.size() == parameters.size())
+    {
+      for (int i = 0; i < (int)parameters.size(); ++i)
+      {
+        parameters[i] -= policy_parameters_[i];
+      }
+      message.parameters->delta = true;
+    }
+    if(message.parameters->rollout < 0)
+    {
+      policy_parameters_.swap(absolute_parameters);
+    }
+  }
+
+  try
+  {
+    if(message.statistics)
+    {
+      bag_.write(STATISTICS_TOPIC_NAME, ros::Time::now(), *message.statistics);
+    }
+    else
+    {
+      bag_.write(PARAMETERS_TOPIC_NAME, ros::Time::now(), *message.parameters);
+    }
+  }
+  catch (rosbag::BagException& ex)
+  {
+    ROS_ERROR("Could not write to bag file %s: %s", abs_bag_file_name_.c_str(), ex.what());
+    return false;
+  }
+  return true;
+}
+
+}
@@ -107,6 +107,12 @@ bool CovariantTrajectoryWaypointTask::getControlCostWeight(double& control_cost_
     return true;
 }
 
+bool CovariantTrajectoryWaypointTask::clone(boost::shared_ptr<task_manager_interface::Task>& task)
+{
+    task.reset(new CovariantTrajectoryWaypointTask(*this));
+    return true;
+}
+
 void CovariantTrajectoryWaypointTask::readParameters()
 {
     EXPECT_TRUE(readEigenVector(node_handle_, "start", start_));
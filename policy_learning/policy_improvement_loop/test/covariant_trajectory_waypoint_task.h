@@ -85,6 +85,13 @@ public:
      */
     bool getControlCostWeight(double& control_cost_weight);
 
+    /**
+     * The costs only depend on the parameters, clones share the (read only) policy
+     * @param task
+     * @return
+     */
+    bool clone(boost::shared_ptr<task_manager_interface::Task>& task);
+
 private:
     ros::NodeHandle node_handle_;
     int num_time_steps_;
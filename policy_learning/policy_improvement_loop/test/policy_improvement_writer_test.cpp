@@ -0,0 +1,174 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks      Checks that the policy improvement writer keeps the order
+                of the messages, writes all queued messages when it is
+                destroyed and reports failed writes.
+
+  \file         policy_improvement_writer_test.cpp
+
+  \author       Peter Pastor
+  \date         Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <boost/filesystem.hpp>
+
+// local includes
+#include <policy_improvement_loop/policy_improvement_writer.h>
+
+using namespace policy_improvement_loop;
+
+static const int NUM_ITERATIONS = 5;
+static const int NUM_ROLLOUTS = 3;
+static const int NUM_DIMENSIONS = 2;
+static const int NUM_PARAMETERS = 4;
+
+static std::string getBagFileName(const std::string& test_name)
+{
+  boost::filesystem::path directory("/tmp/policy_improvement_writer_test");
+  boost::filesystem::remove_all(directory / test_name);
+  return (directory / test_name / "statistics.bag").string();
+}
+
+/*! Parameter p of dimension d of the given rollout (-1 for the policy) of the given iteration
+ */
+static double getParameter(const int iteration, const int rollout, const int d, const int p)
+{
+  return 100.0 * iteration + 10.0 * (rollout + 1) + d * NUM_PARAMETERS + p;
+}
+
+static std::vector<Eigen::VectorXd> getParameters(const int iteration, const int rollout)
+{
+  std::vector<Eigen::VectorXd> parameters(NUM_DIMENSIONS, Eigen::VectorXd::Zero(NUM_PARAMETERS));
+  for (int d = 0; d < NUM_DIMENSIONS; ++d)
+  {
+    for (int p = 0; p < NUM_PARAMETERS; ++p)
+    {
+      parameters[d](p) = getParameter(iteration, rollout, d, p);
+    }
+  }
+  return parameters;
+}
+
+/*! Adds the rollouts, the updated policy and the statistics of each iteration, in the order of the learning loop
+ */
+static void addIterations(PolicyImprovementWriter& writer)
+{
+  for (int i = 1; i <= NUM_ITERATIONS; ++i)
+  {
+    for (int r = 0; r < NUM_ROLLOUTS; ++r)
+    {
+      ASSERT_TRUE(writer.addParameters(i, r, getParameters(i, r)));
+    }
+    ASSERT_TRUE(writer.addParameters(i, -1, getParameters(i, -1)));
+    PolicyImprovementStatistics statistics;
+    statistics.iteration = i;
+    statistics.noiseless_cost = i;
+    ASSERT_TRUE(writer.addStatistics(statistics));
+  }
+}
+
+/*! Reads the bag and checks that it contains the messages of addIterations in the same order
+ */
+static void checkIterations(const std::string& abs_bag_file_name, const bool parameter_deltas)
+{
+  rosbag::Bag bag;
+  ASSERT_NO_THROW(bag.open(abs_bag_file_name, rosbag::bagmode::Read));
+  rosbag::View view(bag);
+  rosbag::View::iterator it = view.begin();
+  for (int i = 1; i <= NUM_ITERATIONS; ++i)
+  {
+    for (int r = 0; r < NUM_ROLLOUTS + 1; ++r)
+    {
+      int rollout = (r < NUM_ROLLOUTS) ? r : -1;
+      ASSERT_TRUE(it != view.end());
+      PolicyParameters::ConstPtr parameters = it->instantiate<PolicyParameters>();
+      ASSERT_TRUE(parameters);
+      EXPECT_EQ(i, parameters->iteration);
+      EXPECT_EQ(rollout, parameters->rollout);
+      ASSERT_EQ(NUM_DIMENSIONS * NUM_PARAMETERS, (int)parameters->parameters.size());
+      // everything after the first policy is relative to the most recent policy
+      bool delta = parameter_deltas && i > 1;
+      EXPECT_EQ(delta, (bool)parameters->delta);
+      for (int d = 0; d < NUM_DIMENSIONS; ++d)
+      {
+        for (int p = 0; p < NUM_PARAMETERS; ++p)
+        {
+          double expected = getParameter(i, rollout, d, p) - (delta ? getParameter(i - 1, -1, d, p) : 0.0);
+          EXPECT_DOUBLE_EQ(expected, parameters->parameters[d * NUM_PARAMETERS + p]);
+        }
+      }
+      ++it;
+    }
+    ASSERT_TRUE(it != view.end());
+    PolicyImprovementStatistics::ConstPtr statistics = it->instantiate<PolicyImprovementStatistics>();
+    ASSERT_TRUE(statistics);
+    EXPECT_EQ(i, statistics->iteration);
+    ++it;
+  }
+  EXPECT_TRUE(it == view.end());
+  bag.close();
+}
+
+TEST(policy_improvement_writer_test, keepsOrderAndClosesBagAfterEachBatch)
+{
+  std::string abs_bag_file_name = getBagFileName("order");
+  PolicyImprovementWriter writer;
+  // a small queue makes the learning loop block and the writer thread write many batches
+  ASSERT_TRUE(writer.initialize(abs_bag_file_name, 2, false));
+  addIterations(writer);
+  ASSERT_TRUE(writer.waitForWrites());
+  // the bag is readable while the writer is still running
+  checkIterations(abs_bag_file_name, false);
+  writer.shutdown();
+}
+
+TEST(policy_improvement_writer_test, writesQueuedMessagesOnDestruction)
+{
+  std::string abs_bag_file_name = getBagFileName("destruction");
+  {
+    PolicyImprovementWriter writer;
+    ASSERT_TRUE(writer.initialize(abs_bag_file_name, 1000, true));
+    addIterations(writer);
+  }
+  checkIterations(abs_bag_file_name, true);
+}
+
+TEST(policy_improvement_writer_test, reportsWriteErrors)
+{
+  std::string abs_bag_file_name = getBagFileName("error");
+  // the bag cannot be created because its directory is a file
+  boost::filesystem::path directory = boost::filesystem::path(abs_bag_file_name).parent_path();
+  boost::filesystem::create_directories(directory.parent_path());
+  std::ofstream file(directory.string().c_str());
+  file << "not a directory";
+  file.close();
+
+  PolicyImprovementWriter writer;
+  ASSERT_TRUE(writer.initialize(abs_bag_file_name, 10, false));
+  PolicyImprovementStatistics statistics;
+  statistics.iteration = 1;
+  EXPECT_TRUE(writer.addStatistics(statistics));
+  EXPECT_FALSE(writer.waitForWrites());
+  EXPECT_FALSE(writer.addStatistics(statistics));
+  writer.shutdown();
+  boost::filesystem::remove(directory);
+}
+
+int main(int argc, char **argv)
+{
+  ros::Time::init();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -2,7 +2,7 @@ clear all;
 close all;
 
 base_file_name='/tmp/dmp_waypoint_task_noisless_rollout_';
-% base_file_name='/tmp/dmp_waypoint_task_noisy_rollout_';
+% noisy rollouts are written to /tmp/dmp_waypoint_task_noisy_rollout_<iteration>_<rollout>.clmc
 
 figure(1);
 
@@ -54,11 +54,6 @@ bool DMPWaypointTask::initialize(ros::NodeHandle& node_handle)
   // policy_->setFileNameBase("/tmp/ctp_");
   // policy_->setToMinControlCost(start_, goal_);
 
-  trial_counter_ = 0;
-  noiseless_rollout_counter_ = 0;
-  noisy_rollout_counter_ = 0;
-  logging_flag_ = false;
-
   return true;
 }
 
@@ -66,6 +61,32 @@ bool DMPWaypointTask::execute(std::vector<Eigen::VectorXd>& parameters,
                               Eigen::VectorXd& costs,
                               double& terminal_cost,
                               const int iteration_number)
+{
+  return computeCosts(parameters, costs, std::string(""));
+}
+
+bool DMPWaypointTask::execute(std::vector<Eigen::VectorXd>& parameters,
+                              Eigen::VectorXd& costs,
+                              double& terminal_cost,
+                              const int iteration_number,
+                              const int rollout_number)
+{
+  // rollouts are named by iteration and rollout number, since clones execute them concurrently
+  std::stringstream ss;
+  if(rollout_number == NOISELESS_ROLLOUT)
+  {
+    ss << "/tmp/dmp_waypoint_task_noisless_rollout_" << (iteration_number - 1) << ".clmc";
+  }
+  else
+  {
+    ss << "/tmp/dmp_waypoint_task_noisy_rollout_" << iteration_number << "_" << rollout_number << ".clmc";
+  }
+  return computeCosts(parameters, costs, ss.str());
+}
+
+bool DMPWaypointTask::computeCosts(std::vector<Eigen::VectorXd>& parameters,
+                                   Eigen::VectorXd& costs,
+                                   const std::string& abs_file_name)
 {
   int waypoint_time_index = int(double(num_time_steps_) * (waypoint_time_ / movement_time_));
 
@@ -91,32 +112,10 @@ bool DMPWaypointTask::execute(std::vector<Eigen::VectorXd>& parameters,
     return false;
   }
 
-  if(!logging_flag_ && trial_counter_ >= num_rollouts_ && (trial_counter_ % num_reused_rollouts_ == 0))
+  if(!abs_file_name.empty() && !rollout.writeToCLMCFile(abs_file_name))
   {
-    logging_flag_ = true;
-    std::stringstream ss;
-    ss << noiseless_rollout_counter_;
-    std::string fname = "/tmp/dmp_waypoint_task_noisless_rollout_" + ss.str() + ".clmc";
-    if(!rollout.writeToCLMCFile(fname))
-    {
-      ROS_ERROR("Could not write rollout to file >%s<.", fname.c_str());
-      return false;
-    }
-    noiseless_rollout_counter_++;
-  }
-  else
-  {
-    logging_flag_ = false;
-    std::stringstream ss;
-    ss << noisy_rollout_counter_;
-    std::string fname = "/tmp/dmp_waypoint_task_noisy_rollout_" + ss.str() + ".clmc";
-    if(!rollout.writeToCLMCFile(fname))
-    {
-      ROS_ERROR("Could not write rollout to file >%s<.", fname.c_str());
-      return false;
-    }
-    noisy_rollout_counter_++;
-    trial_counter_++;
+    ROS_ERROR("Could not write rollout to file >%s<.", abs_file_name.c_str());
+    return false;
   }
 
   if(num_time_steps_ != rollout.getNumContainedSamples())
@@ -175,6 +174,32 @@ bool DMPWaypointTask::getControlCostWeight(double& control_cost_weight)
   return true;
 }
 
+bool DMPWaypointTask::clone(boost::shared_ptr<task_manager_interface::Task>& task)
+{
+  // the clone gets a copy of the current DMP, since execute() sets its thetas
+  dmp_lib::DMPPtr dmp;
+  ROS_VERIFY(policy_->getDMP(dmp));
+  dmp_lib::ICRA2009DMPPtr icra2009_dmp = boost::dynamic_pointer_cast<dmp_lib::ICRA2009DMP>(dmp);
+  if(!icra2009_dmp)
+  {
+    ROS_ERROR("Only ICRA2009 DMPs can be cloned, the DMP is of type >%s<.", dmp->getVersionString().c_str());
+    return false;
+  }
+  dmp_lib::ICRA2009DMPPtr icra2009_dmp_copy(new dmp_lib::ICRA2009DMP());
+  *icra2009_dmp_copy = *icra2009_dmp;
+
+  boost::shared_ptr<DMPWaypointTask> dmp_waypoint_task(new DMPWaypointTask(*this));
+  dmp_waypoint_task->policy_.reset(new policy_library::DMPPolicy());
+  if(!dmp_waypoint_task->policy_->initialize(icra2009_dmp_copy)
+      || !dmp_waypoint_task->policy_->setNumTimeSteps(num_time_steps_))
+  {
+    ROS_ERROR("Could not initialize the policy of the clone of the DMP waypoint task.");
+    return false;
+  }
+  task = dmp_waypoint_task;
+  return true;
+}
+
 void DMPWaypointTask::readParameters()
 {
   ROS_VERIFY(readEigenVector(node_handle_, "start", start_));
@@ -191,9 +216,6 @@ void DMPWaypointTask::readParameters()
   ROS_VERIFY(usc_utilities::read(node_handle_, "num_dimensions", num_dimensions_));
   ROS_VERIFY(usc_utilities::read(node_handle_, "num_time_steps", num_time_steps_));
   ROS_VERIFY(usc_utilities::read(node_handle_, "write_to_file", write_to_file_));
-
-  ROS_VERIFY(usc_utilities::read(node_handle_, "num_rollouts", num_rollouts_));
-  ROS_VERIFY(usc_utilities::read(node_handle_, "num_reused_rollouts", num_reused_rollouts_));
 }
 
 }
@@ -56,6 +56,21 @@ public:
                double& terminal_cost,
                const int iteration_number = 0);
 
+  /**
+   * Executes the task and writes the rollout to a file named by iteration and rollout number
+   * @param parameters [num_dimensions] num_parameters - policy parameters to execute
+   * @param costs Vector of num_time_steps, state space cost per timestep (do not include control costs)
+   * @param terminal_cost
+   * @param iteration_number
+   * @param rollout_number
+   * @return
+   */
+  bool execute(std::vector<Eigen::VectorXd>& parameters,
+               Eigen::VectorXd& costs,
+               double& terminal_cost,
+               const int iteration_number,
+               const int rollout_number);
+
   /**
    * Get the Policy object of this Task
    * @param policy
@@ -77,6 +92,12 @@ public:
    */
   bool getControlCostWeight(double& control_cost_weight);
 
+  /*! Creates a task with a copy of the current DMP, since execute() sets the thetas of the DMP.
+   * @param task
+   * @return
+   */
+  bool clone(boost::shared_ptr<task_manager_interface::Task>& task);
+
 private:
   ros::NodeHandle node_handle_;
   int num_time_steps_;
@@ -90,20 +111,23 @@ private:
   double waypoint_time_;
   double movement_time_;
 
-  int num_rollouts_;
-  int num_reused_rollouts_;
-  bool logging_flag_;
-
   double waypoint_cost_weight_;
   double control_cost_weight_;
   double acceleration_cost_weight_;
 
   double sampling_frequency_;
-  int trial_counter_;
-  int noiseless_rollout_counter_;
-  int noisy_rollout_counter_;
 
   void readParameters();
+
+  /*! Propagates the DMP with the given parameters and computes the costs
+   * @param parameters
+   * @param costs
+   * @param abs_file_name the rollout is written to this file unless it is empty
+   * @return
+   */
+  bool computeCosts(std::vector<Eigen::VectorXd>& parameters,
+                    Eigen::VectorXd& costs,
+                    const std::string& abs_file_name);
 };
 
 }
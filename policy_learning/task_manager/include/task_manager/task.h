@@ -68,6 +68,28 @@ public:
      */
     virtual bool execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, double& terminal_cost, const int iteration_number) = 0;
 
+    /**
+     * Executes a rollout of the given iteration. Rollouts may be executed concurrently on clones, tasks that need to
+     * know which rollout they execute (e.g. for logging) must use the rollout number instead of counting calls.
+     * The default implementation ignores the rollout number.
+     * @param parameters [num_dimensions] num_parameters - policy parameters to execute
+     * @param costs Vector of num_time_steps, state space cost per timestep (do not include control costs)
+     * @param terminal_cost
+     * @param iteration_number
+     * @param rollout_number index of the noisy rollout within the iteration, or NOISELESS_ROLLOUT
+     * @return
+     */
+    virtual bool execute(std::vector<Eigen::VectorXd>& parameters, Eigen::VectorXd& costs, double& terminal_cost,
+                         const int iteration_number, const int rollout_number)
+    {
+        return execute(parameters, costs, terminal_cost, iteration_number);
+    }
+
+    /**
+     * Rollout number of the noiseless rollout that is executed after each update
+     */
+    static const int NOISELESS_ROLLOUT = -1;
+
     /**
      * Get the Policy object of this Task
      * @param policy
@@ -89,6 +111,19 @@ public:
      */
     virtual bool getControlCostWeight(double& control_cost_weight) = 0;
 
+    /**
+     * Creates an initialized copy of this task for executing rollouts concurrently. execute() of the clone must be
+     * safe to call while execute() of this task or of other clones is running, and return the same costs for the
+     * same parameters. Tasks that cannot guarantee this keep the default implementation, their rollouts are executed
+     * sequentially.
+     * @param task (output) the clone
+     * @return false if the task cannot be cloned
+     */
+    virtual bool clone(boost::shared_ptr<Task>& task)
+    {
+        return false;
+    }
+
 };
 
 }
@@ -0,0 +1,436 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		DMP controller implementation that executes NC2010 DMPs using
+            dmp_lib::FixedDynamicMovementPrimitive, i.e. without any heap
+            allocation or virtual function call inside the real-time loop.
+
+ \file		fixed_dmp_controller_implementation.h
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef FIXED_DMP_CONTROLLER_IMPLEMENTATION_H_
+#define FIXED_DMP_CONTROLLER_IMPLEMENTATION_H_
+
+// system includes
+#include <string>
+#include <vector>
+
+// ros includes
+#include <ros/ros.h>
+#include <rosrt/rosrt.h>
+
+#include <geometry_msgs/PoseStamped.h>
+
+#include <usc_utilities/assert.h>
+#include <usc_utilities/constants.h>
+#include <usc_utilities/param_server.h>
+
+#include <dmp_lib/fixed_dynamic_movement_primitive.h>
+#include <dynamic_movement_primitive/nc2010_dynamic_movement_primitive.h>
+
+// local includes
+#include <pr2_dynamic_movement_primitive_controller/dmp_controller.h>
+#include <pr2_dynamic_movement_primitive_controller/variable_name_map.h>
+
+namespace pr2_dynamic_movement_primitive_controller
+{
+
+/*! Changes the goal of those cartesian variables (x, y, z, qw, qx, qy, qz) of the fixed DMP that are used by the controller
+ * @param goal_pose
+ * @param variable_name_map
+ * @param num_variables_used
+ * @param fixed_dmp
+ * @return True on success, otherwise False
+ * REAL-TIME REQUIREMENTS
+ */
+template<class FixedDMP>
+  bool changeCartesianGoal(const geometry_msgs::Pose& goal_pose,
+                           const VariableNameMap& variable_name_map,
+                           const int num_variables_used,
+                           FixedDMP& fixed_dmp)
+  {
+    for (int i = 0; i < num_variables_used; ++i)
+    {
+      int local_index = 0;
+      if (!variable_name_map.getSupportedVariableIndex(i, local_index))
+      {
+        ROS_ERROR("Could not get variable mapping. This should never happen (real-time violation).");
+        return false;
+      }
+
+      if (local_index == usc_utilities::Constants::X)
+      {
+        ROS_VERIFY(fixed_dmp.changeGoal(goal_pose.position.x, local_index));
+      }
+      else if (local_index == usc_utilities::Constants::Y)
+      {
+        ROS_VERIFY(fixed_dmp.changeGoal(goal_pose.position.y, local_index));
+      }
+      else if (local_index == usc_utilities::Constants::Z)
+      {
+        ROS_VERIFY(fixed_dmp.changeGoal(goal_pose.position.z, local_index));
+      }
+      else if (local_index == usc_utilities::Constants::N_CART + usc_utilities::Constants::QW)
+      {
+        ROS_VERIFY(fixed_dmp.changeGoal(goal_pose.orientation.w, local_index));
+      }
+      else if (local_index == usc_utilities::Constants::N_CART + usc_utilities::Constants::QX)
+      {
+        ROS_VERIFY(fixed_dmp.changeGoal(goal_pose.orientation.x, local_index));
+      }
+      else if (local_index == usc_utilities::Constants::N_CART + usc_utilities::Constants::QY)
+      {
+        ROS_VERIFY(fixed_dmp.changeGoal(goal_pose.orientation.y, local_index));
+      }
+      else if (local_index == usc_utilities::Constants::N_CART + usc_utilities::Constants::QZ)
+      {
+        ROS_VERIFY(fixed_dmp.changeGoal(goal_pose.orientation.z, local_index));
+      }
+    }
+    return true;
+  }
+
+template<int NUM_DIMENSIONS>
+  class FixedDMPControllerImplementation : public DMPController
+  {
+
+  public:
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef dmp_lib::FixedDynamicMovementPrimitive<NUM_DIMENSIONS> FixedDMP;
+    typedef boost::shared_ptr<FixedDMP> FixedDMPPtr;
+
+    /*! Constructor
+     */
+    FixedDMPControllerImplementation() {};
+
+    /*! Destructor
+     */
+    virtual ~FixedDMPControllerImplementation() {};
+
+    /*!
+     * @param controller_name
+     * @param dmp_variable_names
+     * @return True on success, otherwise False
+     */
+    bool initialize(const std::string& controller_name,
+                    const std::vector<std::string>& dmp_variable_names);
+
+    /*!
+     * @param new_start
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool changeDMPStart(const Eigen::VectorXd& new_start);
+
+    /*!
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool newDMPReady();
+
+    /*!
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool isRunning(Eigen::VectorXd& desired_positions,
+                   Eigen::VectorXd& desired_velocities,
+                   Eigen::VectorXd& desired_accelerations);
+
+    /*! Fixed DMPs are not derived from dmp_lib::DynamicMovementPrimitive, therefore this always fails
+     * @param dmp
+     * @return False
+     */
+    bool getDMP(dmp_lib::DMPPtr& dmp);
+
+    /*!
+     * @return
+     * REAL-TIME REQUIREMENTS
+     */
+    bool stop();
+
+  private:
+
+    /*! Callback function to convert incoming messages (not called within the real-time loop)
+     * @param msg
+     * @param fixed_dmp
+     * @return
+     */
+    bool filter(const dmp::NC2010DMP::DMPMsgConstPtr& msg,
+                const FixedDMPPtr fixed_dmp);
+
+    /*!
+     * @param status
+     * @param movement_finished
+     * @param end_time
+     * REAL-TIME REQUIREMENTS
+     */
+    void publishStatus(const int status, const bool movement_finished, const ros::Time& end_time);
+
+    /*!
+     * @param desired_positions
+     * @param desired_velocities
+     * @param desired_accelerations
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool setVariables(Eigen::VectorXd& desired_positions,
+                      Eigen::VectorXd& desired_velocities,
+                      Eigen::VectorXd& desired_accelerations);
+
+    /*!
+     * @param fixed_dmp
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool setDMP(FixedDMPPtr fixed_dmp);
+
+    /*! Applies the most recent goal pose received on the goal topic (if any)
+     * @return True on success, otherwise False
+     * REAL-TIME REQUIREMENTS
+     */
+    bool changeGoal();
+
+    /*!
+     */
+    rosrt::FilteredSubscriber<dmp::NC2010DMP::DMPMsg, FixedDMP> dmp_filtered_subscriber_;
+
+    /*!
+     */
+    FixedDMPPtr dmp_;
+
+    /*!
+     */
+    rosrt::Subscriber<geometry_msgs::PoseStamped> dmp_goal_subscriber_;
+
+    /*! Output of the fixed DMP
+     */
+    typename FixedDMP::Vector desired_positions_;
+    typename FixedDMP::Vector desired_velocities_;
+    typename FixedDMP::Vector desired_accelerations_;
+    typename FixedDMP::Vector new_start_;
+
+  };
+
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::filter(const dmp::NC2010DMP::DMPMsgConstPtr& msg,
+                                                                const FixedDMPPtr fixed_dmp)
+  {
+    dmp::NC2010DMP::DMPPtr dmp;
+    if (!dmp::NC2010DMP::createFromMessage(dmp, *msg))
+    {
+      ROS_ERROR("Could not create NC2010 DMP from message.");
+      return false;
+    }
+    if (!dmp->isSetup())
+    {
+      ROS_ERROR("Received DMP is not setup.");
+      return false;
+    }
+    return fixed_dmp->initialize(*dmp);
+  }
+
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::initialize(const std::string& controller_name,
+                                                                    const std::vector<std::string>& dmp_variable_names)
+  {
+    // error checking
+    if ((int)dmp_variable_names.size() != NUM_DIMENSIONS)
+    {
+      ROS_ERROR("%s: Number of variable names >%i< does not match the number of fixed DMP dimensions >%i<.", controller_name.c_str(),
+                (int)dmp_variable_names.size(), NUM_DIMENSIONS);
+      return false;
+    }
+
+    ros::NodeHandle controller_node_handle(controller_name);
+    std::vector<std::string> controller_variable_names;
+    ROS_VERIFY(usc_utilities::read(controller_node_handle, "trajectory/variable_names", controller_variable_names));
+    ROS_VERIFY(variable_name_map_.initialize(dmp_variable_names, controller_variable_names));
+
+    entire_desired_positions_ = Eigen::VectorXd::Zero(NUM_DIMENSIONS);
+    entire_desired_velocities_ = Eigen::VectorXd::Zero(NUM_DIMENSIONS);
+    entire_desired_accelerations_ = Eigen::VectorXd::Zero(NUM_DIMENSIONS);
+
+    ros::NodeHandle node_handle;
+    ROS_VERIFY(dmp_filtered_subscriber_.initialize(100, node_handle, controller_name + "/command", boost::bind(&FixedDMPControllerImplementation<NUM_DIMENSIONS>::filter, this, _1, _2)));
+    ROS_VERIFY(dmp_goal_subscriber_.initialize(100, node_handle, controller_name + "/goal"));
+
+    ros::Publisher publisher = node_handle.advertise<dynamic_movement_primitive::ControllerStatusMsg>(controller_name + "/status", 10, true);
+    dynamic_movement_primitive::ControllerStatusMsg dmp_status_msg;
+    dmp_status_publisher_.initialize(publisher, 10, dmp_status_msg);
+
+    dmp_is_being_executed_ = false;
+    dmp_is_set_ = false;
+
+    return (initialized_ = true);
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS>
+  void FixedDMPControllerImplementation<NUM_DIMENSIONS>::publishStatus(const int status, const bool movement_finished, const ros::Time& end_time)
+  {
+    boost::shared_ptr<dynamic_movement_primitive::ControllerStatusMsg> status_msg;
+    status_msg = dmp_status_publisher_.allocate();
+    if (status_msg)
+    {
+      status_msg->status = status;
+      status_msg->id = dmp_->getId();
+      status_msg->percent_complete = dmp_->getProgress();
+      status_msg->start_time = start_time_;
+      if(movement_finished)
+      {
+        status_msg->end_time = end_time;
+      }
+      dmp_status_publisher_.publish(status_msg);
+    }
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::setVariables(Eigen::VectorXd& desired_positions,
+                                                                      Eigen::VectorXd& desired_velocities,
+                                                                      Eigen::VectorXd& desired_accelerations)
+  {
+    for (int i = 0; i < num_variables_used_; ++i)
+    {
+      int index = 0;
+      if (!variable_name_map_.getSupportedVariableIndex(i, index))
+      {
+        return false;
+      }
+      desired_positions(index) = entire_desired_positions_(i);
+      desired_velocities(index) = entire_desired_velocities_(i);
+      desired_accelerations(index) = entire_desired_accelerations_(i);
+    }
+    return true;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::getDMP(dmp_lib::DMPPtr& /*dmp*/)
+  {
+    ROS_ERROR("Fixed DMP controller cannot return a dmp_lib::DMPPtr.");
+    return false;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::setDMP(FixedDMPPtr fixed_dmp)
+  {
+    if (!fixed_dmp->isSetup())
+    {
+      ROS_ERROR("DMP is not setup (Real-time violation).");
+      return false;
+    }
+    variable_name_map_.reset();
+    num_variables_used_ = 0;
+    for (int i = 0; i < NUM_DIMENSIONS; ++i)
+    {
+      if (!variable_name_map_.set(fixed_dmp->getName(i), num_variables_used_))
+      {
+        ROS_ERROR("Received DMP variable name >%s< is not handled by this DMP controller (Real-time violation).", fixed_dmp->getName(i).c_str());
+        return false;
+      }
+      num_variables_used_++;
+    }
+    start_time_ = ros::Time::now();
+    dmp_ = fixed_dmp;
+    dmp_is_set_ = true;
+    return (dmp_is_being_executed_ = true);
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::newDMPReady()
+  {
+    if (!dmp_is_being_executed_)
+    {
+      FixedDMPPtr fixed_dmp = dmp_filtered_subscriber_.poll();
+      if (fixed_dmp)
+      {
+        return setDMP(fixed_dmp);
+      }
+    }
+    return false;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::isRunning(Eigen::VectorXd& desired_positions,
+                                                                   Eigen::VectorXd& desired_velocities,
+                                                                   Eigen::VectorXd& desired_accelerations)
+  {
+    if (dmp_is_set_)
+    {
+      ROS_VERIFY(changeGoal());
+      bool movement_finished = false;
+      if (!dmp_->propagateStep(desired_positions_, desired_velocities_, desired_accelerations_, movement_finished))
+      {
+        // something went wrong
+        publishStatus(dynamic_movement_primitive::ControllerStatusMsg::FAILED, false, ros::Time::now());
+        dmp_is_being_executed_ = false;
+      }
+      entire_desired_positions_ = desired_positions_;
+      entire_desired_velocities_ = desired_velocities_;
+      entire_desired_accelerations_ = desired_accelerations_;
+
+      if (!setVariables(desired_positions, desired_velocities, desired_accelerations))
+      {
+        // something went wrong
+        publishStatus(dynamic_movement_primitive::ControllerStatusMsg::FAILED, false, ros::Time::now());
+        dmp_is_being_executed_ = false;
+      }
+
+      // movement has finished
+      if (dmp_is_being_executed_ && movement_finished)
+      {
+        publishStatus(dynamic_movement_primitive::ControllerStatusMsg::FINISHED, movement_finished, ros::Time::now());
+        dmp_is_being_executed_ = false;
+      }
+    }
+    return dmp_is_set_;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::changeGoal()
+  {
+    geometry_msgs::PoseStamped::ConstPtr goal_pose = dmp_goal_subscriber_.poll();
+    if (goal_pose)
+    {
+      return changeCartesianGoal(goal_pose->pose, variable_name_map_, num_variables_used_, *dmp_);
+    }
+    return true;
+  }
+
+// REAL-TIME REQUIREMENTS
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::changeDMPStart(const Eigen::VectorXd& new_start)
+  {
+    if (new_start.size() < NUM_DIMENSIONS)
+    {
+      ROS_ERROR("Start vector has wrong size >%i<, it should be >%i< (Real-time violation).", (int)new_start.size(), NUM_DIMENSIONS);
+      return false;
+    }
+    new_start_ = new_start.head<NUM_DIMENSIONS>();
+    return dmp_->changeStart(new_start_);
+  }
+
+template<int NUM_DIMENSIONS>
+  bool FixedDMPControllerImplementation<NUM_DIMENSIONS>::stop()
+  {
+    dmp_is_being_executed_ = false;
+    dmp_is_set_ = false;
+    return true;
+  }
+
+}
+
+#endif /* FIXED_DMP_CONTROLLER_IMPLEMENTATION_H_ */
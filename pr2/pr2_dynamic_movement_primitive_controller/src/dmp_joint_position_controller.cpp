@@ -26,6 +26,7 @@
 #include <pr2_dynamic_movement_primitive_controller/dmp_joint_position_controller.h>
 #include <pr2_dynamic_movement_primitive_controller/dmp_controller.h>
 #include <pr2_dynamic_movement_primitive_controller/dmp_controller_implementation.h>
+#include <pr2_dynamic_movement_primitive_controller/fixed_dmp_controller_implementation.h>
 
 // import most common Eigen types
 using namespace Eigen;
@@ -65,6 +66,19 @@ bool DMPJointPositionController::init(pr2_mechanism_model::RobotState* robot_sta
   {
     dmp_controller_.reset(new DMPControllerImplementation<dmp::ICRA2009DMP> ());
   }
+  else if (dmp_implementation == "NC2010FixedDMPControllerImplementation")
+  {
+    // the number of dimensions of fixed dmps need to be known at compile time
+    if (controlled_joint_names.size() == 7)
+    {
+      dmp_controller_.reset(new FixedDMPControllerImplementation<7> ());
+    }
+    else
+    {
+      ROS_ERROR("Fixed DMP controller implementation is not available for >%i< joints.", (int)controlled_joint_names.size());
+      return false;
+    }
+  }
   else
   {
     ROS_ERROR("Could not figure out witch DMPController implementation to chose.");
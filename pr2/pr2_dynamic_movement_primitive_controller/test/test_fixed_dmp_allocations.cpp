@@ -0,0 +1,183 @@
+/*********************************************************************
+ Computational Learning and Motor Control Lab
+ University of Southern California
+ Prof. Stefan Schaal
+ *********************************************************************
+ \remarks		Verifies that fixed DMPs do not allocate memory while being
+            propagated and compares their worst case cycle time against
+            the NC2010 DMP they have been created from.
+
+ \file		test_fixed_dmp_allocations.cpp
+
+ \author	Peter Pastor
+ \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <ros/ros.h>
+#include <rosrt/rosrt.h>
+
+#include <dmp_lib/nc2010_dynamic_movement_primitive.h>
+#include <dmp_lib/fixed_dynamic_movement_primitive.h>
+
+#include <pr2_dynamic_movement_primitive_controller/fixed_dmp_controller_implementation.h>
+
+using namespace Eigen;
+
+static const int NUM_JOINTS = 7;
+static const double SAMPLING_FREQUENCY = 1000.0;
+static const double DURATION = 1.0;
+
+static std::vector<std::string> getJointNames()
+{
+  std::vector<std::string> variable_names;
+  for (int i = 0; i < NUM_JOINTS; ++i)
+  {
+    std::stringstream ss;
+    ss << "joint_" << i;
+    variable_names.push_back(ss.str());
+  }
+  return variable_names;
+}
+
+static void createDMP(dmp_lib::NC2010DMP& dmp, VectorXd& start, VectorXd& goal,
+                      const std::vector<std::string>& variable_names = getJointNames())
+{
+  lwr_lib::LWRParamPtr lwr_parameters(new lwr_lib::LWRParameters());
+  ASSERT_TRUE(lwr_parameters->initialize(100, 0.7, true, 0.001));
+  const double k_gain = 250.0;
+  ASSERT_TRUE(dmp.initialize(variable_names, lwr_parameters, k_gain, dmp_lib::NC2010TS::getDGain(k_gain)));
+  start = VectorXd::Zero(NUM_JOINTS);
+  goal = VectorXd::LinSpaced(NUM_JOINTS, 0.1, 1.0);
+  ASSERT_TRUE(dmp.learnFromMinimumJerk(start, goal, SAMPLING_FREQUENCY, DURATION));
+}
+
+TEST(FixedDMP, noAllocationsWhilePropagating)
+{
+  dmp_lib::NC2010DMP dmp;
+  VectorXd start, goal;
+  createDMP(dmp, start, goal);
+  ASSERT_TRUE(dmp.setup(start, goal, DURATION, SAMPLING_FREQUENCY));
+
+  dmp_lib::FixedDynamicMovementPrimitive<NUM_JOINTS> fixed_dmp;
+  ASSERT_TRUE(fixed_dmp.initialize(dmp));
+  dmp_lib::FixedDynamicMovementPrimitive<NUM_JOINTS>::Vector positions, velocities, accelerations, new_start;
+  new_start.setZero();
+
+  rosrt::resetThreadAllocInfo();
+  bool movement_finished = false;
+  ASSERT_TRUE(fixed_dmp.setup());
+  ASSERT_TRUE(fixed_dmp.changeStart(new_start));
+  ASSERT_TRUE(fixed_dmp.changeGoal(0.5, 0));
+  while (!movement_finished)
+  {
+    ASSERT_TRUE(fixed_dmp.propagateStep(positions, velocities, accelerations, movement_finished));
+  }
+  EXPECT_EQ(rosrt::getThreadAllocInfo().total_ops, 0ULL);
+}
+
+TEST(FixedDMP, worstCaseCycleTime)
+{
+  dmp_lib::NC2010DMP dmp;
+  VectorXd start, goal;
+  createDMP(dmp, start, goal);
+  dmp_lib::FixedDynamicMovementPrimitive<NUM_JOINTS> fixed_dmp;
+  ASSERT_TRUE(fixed_dmp.initialize(dmp));
+
+  VectorXd positions = VectorXd::Zero(NUM_JOINTS);
+  VectorXd velocities = VectorXd::Zero(NUM_JOINTS);
+  VectorXd accelerations = VectorXd::Zero(NUM_JOINTS);
+  dmp_lib::FixedDynamicMovementPrimitive<NUM_JOINTS>::Vector fixed_positions, fixed_velocities, fixed_accelerations;
+  double worst_cycle_time = 0, fixed_worst_cycle_time = 0;
+  for (int r = 0; r < 10; ++r)
+  {
+    ASSERT_TRUE(dmp.setup(start, goal, DURATION, SAMPLING_FREQUENCY));
+    ASSERT_TRUE(fixed_dmp.setup());
+    bool movement_finished = false;
+    bool fixed_movement_finished = false;
+    while (!movement_finished)
+    {
+      ros::WallTime start_time = ros::WallTime::now();
+      ASSERT_TRUE(dmp.propagateStep(positions, velocities, accelerations, movement_finished));
+      ros::WallTime end_time = ros::WallTime::now();
+      ASSERT_TRUE(fixed_dmp.propagateStep(fixed_positions, fixed_velocities, fixed_accelerations, fixed_movement_finished));
+      ros::WallTime fixed_end_time = ros::WallTime::now();
+      worst_cycle_time = std::max(worst_cycle_time, (end_time - start_time).toSec());
+      fixed_worst_cycle_time = std::max(fixed_worst_cycle_time, (fixed_end_time - end_time).toSec());
+      ASSERT_EQ(movement_finished, fixed_movement_finished);
+    }
+    EXPECT_LT((positions - fixed_positions).cwiseAbs().maxCoeff(), 1e-6);
+  }
+  ROS_INFO("Worst case propagateStep: NC2010 DMP %.1f us, fixed DMP %.1f us.", worst_cycle_time * 1e6, fixed_worst_cycle_time * 1e6);
+}
+
+TEST(FixedDMP, changeCartesianGoalWhilePropagating)
+{
+  const char* pose_names[] = {"R_HAND_X", "R_HAND_Y", "R_HAND_Z", "R_HAND_QW", "R_HAND_QX", "R_HAND_QY", "R_HAND_QZ"};
+  std::vector<std::string> variable_names(pose_names, pose_names + NUM_JOINTS);
+  dmp_lib::NC2010DMP dmp;
+  VectorXd start, goal;
+  createDMP(dmp, start, goal, variable_names);
+  ASSERT_TRUE(dmp.setup(start, goal, DURATION, SAMPLING_FREQUENCY));
+  dmp_lib::FixedDynamicMovementPrimitive<NUM_JOINTS> fixed_dmp;
+  ASSERT_TRUE(fixed_dmp.initialize(dmp));
+  ASSERT_TRUE(fixed_dmp.setup());
+
+  // same mapping as FixedDMPControllerImplementation::setDMP
+  pr2_dynamic_movement_primitive_controller::VariableNameMap variable_name_map;
+  ASSERT_TRUE(variable_name_map.initialize(variable_names, variable_names));
+  variable_name_map.reset();
+  for (int i = 0; i < NUM_JOINTS; ++i)
+  {
+    ASSERT_TRUE(variable_name_map.set(fixed_dmp.getName(i), i));
+  }
+
+  geometry_msgs::Pose goal_pose;
+  goal_pose.position.x = -0.3;
+  goal_pose.position.y = 0.4;
+  goal_pose.position.z = 0.2;
+  goal_pose.orientation.w = 0.5;
+  goal_pose.orientation.x = -0.5;
+  goal_pose.orientation.y = 0.5;
+  goal_pose.orientation.z = -0.5;
+  VectorXd new_goal(NUM_JOINTS);
+  new_goal << -0.3, 0.4, 0.2, 0.5, -0.5, 0.5, -0.5;
+
+  VectorXd positions = VectorXd::Zero(NUM_JOINTS);
+  VectorXd velocities = VectorXd::Zero(NUM_JOINTS);
+  VectorXd accelerations = VectorXd::Zero(NUM_JOINTS);
+  dmp_lib::FixedDynamicMovementPrimitive<NUM_JOINTS>::Vector fixed_positions, fixed_velocities, fixed_accelerations;
+  bool movement_finished = false;
+  bool fixed_movement_finished = false;
+  int num_steps = 0;
+  while (!movement_finished)
+  {
+    if (num_steps++ == (int)(SAMPLING_FREQUENCY * DURATION / 2.0))
+    {
+      ASSERT_TRUE(dmp.changeGoal(new_goal));
+      rosrt::resetThreadAllocInfo();
+      ASSERT_TRUE(pr2_dynamic_movement_primitive_controller::changeCartesianGoal(goal_pose, variable_name_map, NUM_JOINTS, fixed_dmp));
+      EXPECT_EQ(rosrt::getThreadAllocInfo().total_ops, 0ULL);
+    }
+    ASSERT_TRUE(dmp.propagateStep(positions, velocities, accelerations, movement_finished));
+    ASSERT_TRUE(fixed_dmp.propagateStep(fixed_positions, fixed_velocities, fixed_accelerations, fixed_movement_finished));
+    ASSERT_EQ(movement_finished, fixed_movement_finished);
+    ASSERT_LT((positions - fixed_positions).cwiseAbs().maxCoeff(), 1e-6);
+  }
+  EXPECT_GT((fixed_positions - goal).cwiseAbs().maxCoeff(), 0.1);
+}
+
+int main(int argc, char** argv)
+{
+  ros::Time::init();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -22,6 +22,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include <ros/ros.h>
+#include <ros/atomic.h>
 #include <filters/transfer_function.h>
 
 #include <usc_utilities/param_server.h>
@@ -32,6 +33,7 @@
 // #include <task_recorder2_utilities/accumulator.h>
 #include <task_recorder2_utilities/message_buffer.h>
 #include <task_recorder2_utilities/message_ring_buffer.h>
+#include <task_recorder2_utilities/data_sample_recording.h>
 
 #include <task_recorder2_utilities/data_sample_utilities.h>
 #include <task_recorder2_utilities/task_description_utilities.h>
@@ -50,6 +52,8 @@ namespace task_recorder2
 {
 
 const int MESSAGE_SUBSCRIBER_BUFFER_SIZE = 10000;
+// number of samples memory is reserved for, e.g. 100 seconds at 300Hz; a recording that outgrows it doubles it
+const int DEFAULT_RECORDING_CAPACITY = 30000;
 
 template<class MessageType>
   class TaskRecorder : public TaskRecorderBase
@@ -202,12 +206,16 @@ template<class MessageType>
     ros::Time abs_start_time_;
     boost::mutex mutex_;
     bool logging_;
-    bool streaming_;
+    // read without holding mutex_ such that getSampleData() does not contend with recordMessagesCallback()
+    ros::atomic<bool> streaming_;
 
     /*!
      */
     // task_recorder2_utilities::Accumulator accumulator_;
     boost::shared_ptr<task_recorder2_utilities::MessageRingBuffer> message_buffer_;
+    // samples are recorded in here while logging (protected by mutex_) and cropped and resampled from here when stopping
+    task_recorder2_utilities::DataSampleRecording recording_;
+    std::vector<int> sample_indices_;
     // boost::shared_ptr<task_recorder2_utilities::MessageBuffer> message_buffer_;
     task_recorder2_msgs::DataSample data_sample_;
 
@@ -216,12 +224,15 @@ template<class MessageType>
     int num_signals_;
     bool is_filtered_;
     filters::MultiChannelTransferFunctionFilter<double> filter_;
-    std::vector<double> unfiltered_data_;
     std::vector<double> filtered_data_;
 
     /*!
      */
     SpliningMethod splining_method_;
+    int num_resampling_threads_;
+    // column major buffers that are reused across recordings
+    std::vector<double> variables_;
+    std::vector<double> resampled_variables_;
     /*!
      * @param splining_method
      * @return True on success, otherwise False
@@ -247,7 +258,7 @@ template<class MessageType>
     void recordMessagesCallback(const MessageTypeConstPtr message);
 
     /*!
-     * @param messages
+     * @param sample_indices of the samples in recording_ that are resampled
      * @param start_time
      * @param end_time
      * @param num_samples
@@ -255,13 +266,18 @@ template<class MessageType>
      * @param resampled_messages
      * @return True on success, otherwise False
      */
-    bool resample(std::vector<task_recorder2_msgs::DataSample>& messages,
+    bool resample(const std::vector<int>& sample_indices,
                   const ros::Time& start_time,
                   const ros::Time& end_time,
                   const int num_samples,
                   const std::vector<std::string>& message_names,
                   std::vector<task_recorder2_msgs::DataSample>& resampled_messages);
 
+    /*! Copies the given samples of the recording and queues writing them as raw data
+     * @param sample_indices
+     */
+    void writeRawDataAsync(const std::vector<int>& sample_indices);
+
     /*!
      * @param data_sample
      * @return True on success, otherwise False
@@ -296,7 +312,7 @@ template<class MessageType>
 template<class MessageType>
   TaskRecorder<MessageType>::TaskRecorder(ros::NodeHandle node_handle) :
     initialized_(false), first_time_(true), recorder_io_(node_handle), logging_(false), streaming_(false), /*accumulator_(node_handle),*/
-    num_signals_(0), is_filtered_(false), splining_method_(BSpline)
+    num_signals_(0), is_filtered_(false), splining_method_(BSpline), num_resampling_threads_(1)
   {
   }
 
@@ -326,7 +342,6 @@ template<class MessageType>
       is_filtered_ = true;
       ROS_DEBUG("Filtering >%i< signals for >%s<.", num_signals_, full_topic_name.c_str());
       filtered_data_.resize(num_signals_, 0.0);
-      unfiltered_data_.resize(num_signals_, 0.0);
       std::string parameter_name = recorder_io_.node_handle_.getNamespace() + std::string("/") + full_topic_name + std::string("/Filter");
       ROS_VERIFY(((filters::MultiChannelFilterBase<double>&)filter_).configure(num_signals_, parameter_name, recorder_io_.node_handle_));
     }
@@ -347,6 +362,19 @@ template<class MessageType>
     message_buffer_.reset(new task_recorder2_utilities::MessageRingBuffer(default_data_sample));
     // message_buffer_.reset(new task_recorder2_utilities::MessageBuffer());
 
+    // set the recording capacity to the expected duration of a recording times the message rate
+    int recording_capacity;
+    recorder_io_.node_handle_.param("recording_capacity", recording_capacity, DEFAULT_RECORDING_CAPACITY);
+    recording_.initialize(default_data_sample.names, recording_capacity);
+
+    recorder_io_.node_handle_.param("num_resampling_threads", num_resampling_threads_, 1);
+    if (num_resampling_threads_ < 1)
+    {
+      ROS_ERROR("Number of resampling threads >%i< must be positive. Cannot initialize task recorder with topic >%s<.",
+                num_resampling_threads_, recorder_io_.topic_name_.c_str());
+      return false;
+    }
+
     return (initialized_ = true);
   }
 
@@ -372,12 +400,12 @@ template<class MessageType>
 template<class MessageType>
   void TaskRecorder<MessageType>::recordMessagesCallback(const MessageTypeConstPtr message)
   {
-    MessageType msg = *message;
+    // data_sample_ is preallocated, neither transforming nor recording allocates memory per message
     if(first_time_)
     {
       data_sample_.names = getNames();
     }
-    ROS_VERIFY(transformMsg(msg, data_sample_));
+    ROS_VERIFY(transformMsg(*message, data_sample_));
     first_time_ = false;
     ROS_VERIFY(filter(data_sample_));
     mutex_.lock();
@@ -385,13 +413,18 @@ template<class MessageType>
     {
       // double delay = (ros::Time::now() - data_sample_.header.stamp).toSec();
       // ROS_INFO("Delay = %f", delay);
-      recorder_io_.messages_.push_back(data_sample_);
+      if (recording_.empty())
+      {
+        recording_.setFrameId(data_sample_.header.frame_id);
+      }
+      ROS_VERIFY(recording_.add(data_sample_.header.stamp, data_sample_.data));
     }
-    if (streaming_)
+    mutex_.unlock();
+    // the message buffer supports a single writer and lock-free readers
+    if (streaming_.load(ros::memory_order_acquire))
     {
       ROS_VERIFY(message_buffer_->add(data_sample_));
     }
-    mutex_.unlock();
   }
 
 template<class MessageType>
@@ -403,10 +436,10 @@ template<class MessageType>
     {
       ros::spinOnce();
       mutex_.lock();
-      no_message = recorder_io_.messages_.empty();
+      no_message = recording_.empty();
       if (!no_message)
       {
-        abs_start_time_ = recorder_io_.messages_[0].header.stamp;
+        abs_start_time_ = recording_.getStamp(0);
       }
       mutex_.unlock();
     }
@@ -441,7 +474,7 @@ template<class MessageType>
     mutex_.lock();
     logging_ = true;
     streaming_ = true;
-    recorder_io_.messages_.clear();
+    recording_.clear();
     mutex_.unlock();
     waitForMessages();
   }
@@ -488,6 +521,7 @@ template<class MessageType>
   bool TaskRecorder<MessageType>::stopRecording(task_recorder2::StopRecording::Request& request,
                                                 task_recorder2::StopRecording::Response& response)
   {
+    // the callback does not touch the recording anymore once logging_ is reset
     stopRecording(request.stop_streaming);
 
     if (recorder_io_.write_out_resampled_data_ || recorder_io_.write_out_statistics_)
@@ -503,7 +537,7 @@ template<class MessageType>
 
     if (recorder_io_.write_out_resampled_data_)
     {
-      boost::thread(boost::bind(&TaskRecorderIO<task_recorder2_msgs::DataSample>::writeResampledData, recorder_io_));
+      recorder_io_.writeResampledDataAsync();
     }
 
     // if(recorder_io_.write_out_statistics_)
@@ -549,7 +583,7 @@ template<class MessageType>
                                                 const std::vector<std::string>& message_names,
                                                 std::vector<task_recorder2_msgs::DataSample>& filter_and_cropped_messages)
   {
-    int num_messages = (int)recorder_io_.messages_.size();
+    int num_messages = recording_.size();
     if (num_messages == 0)
     {
       ROS_ERROR("Zero messages have been logged.");
@@ -565,15 +599,20 @@ template<class MessageType>
       filter_and_cropped_messages.push_back(data_sample);
       if(recorder_io_.write_out_raw_data_)
       {
-        boost::thread(boost::bind(&TaskRecorderIO<task_recorder2_msgs::DataSample>::writeRawData, recorder_io_));
+        sample_indices_.resize(num_messages);
+        for (int i = 0; i < num_messages; ++i)
+        {
+          sample_indices_[i] = i;
+        }
+        writeRawDataAsync(sample_indices_);
       }
       recorder_io_.messages_ = filter_and_cropped_messages;
       return true;
     }
 
     // figure out when our data starts and ends
-    ros::Time our_start_time = recorder_io_.messages_[0].header.stamp;
-    ros::Time our_end_time = recorder_io_.messages_[num_messages - 1].header.stamp;
+    ros::Time our_start_time = recording_.getStamp(0);
+    ros::Time our_end_time = recording_.getStamp(num_messages - 1);
 
     int index = 0;
     while (our_end_time.toSec() < 1e-6)
@@ -584,7 +623,7 @@ template<class MessageType>
         ROS_ERROR("Time stamps of recorded messages seem to be invalid.");
         return false;
       }
-      our_end_time = recorder_io_.messages_[num_messages - (1 + index)].header.stamp;
+      our_end_time = recording_.getStamp(num_messages - (1 + index));
     }
 
     if (our_start_time > start_time || our_end_time < end_time)
@@ -595,26 +634,33 @@ template<class MessageType>
       return false;
     }
 
-    // first crop
-    ROS_VERIFY(task_recorder2_utilities::crop<task_recorder2_msgs::DataSample>(recorder_io_.messages_, start_time, end_time));
-    // then remove duplicates
-    ROS_VERIFY(task_recorder2_utilities::removeDuplicates<task_recorder2_msgs::DataSample>(recorder_io_.messages_));
+    // crop and remove duplicates, the samples stay in the recording
+    ROS_VERIFY(recording_.getCroppedIndices(start_time, end_time, sample_indices_));
 
+    // then resample
+    ROS_VERIFY(resample(sample_indices_, start_time, end_time, num_samples, message_names, filter_and_cropped_messages));
+    ROS_ASSERT(static_cast<int>(filter_and_cropped_messages.size()) == num_samples);
+
+    // the raw samples are copied and written on the I/O thread
     if(recorder_io_.write_out_raw_data_)
     {
-      boost::thread(boost::bind(&TaskRecorderIO<task_recorder2_msgs::DataSample>::writeRawData, recorder_io_));
+      writeRawDataAsync(sample_indices_);
     }
 
-    // then resample
-    ROS_VERIFY(resample(recorder_io_.messages_, start_time, end_time, num_samples, message_names, filter_and_cropped_messages));
-    ROS_ASSERT(static_cast<int>(filter_and_cropped_messages.size()) == num_samples);
-
     recorder_io_.messages_ = filter_and_cropped_messages;
     return true;
   }
 
 template<class MessageType>
-  bool TaskRecorder<MessageType>::resample(std::vector<task_recorder2_msgs::DataSample>& messages,
+  void TaskRecorder<MessageType>::writeRawDataAsync(const std::vector<int>& sample_indices)
+  {
+    boost::shared_ptr<task_recorder2_utilities::DataSampleRecording> raw_recording(new task_recorder2_utilities::DataSampleRecording());
+    recording_.getSamples(sample_indices, *raw_recording);
+    recorder_io_.writeRawDataAsync(raw_recording);
+  }
+
+template<class MessageType>
+  bool TaskRecorder<MessageType>::resample(const std::vector<int>& sample_indices,
                                            const ros::Time& start_time,
                                            const ros::Time& end_time,
                                            const int num_samples,
@@ -622,106 +668,72 @@ template<class MessageType>
                                            std::vector<task_recorder2_msgs::DataSample>& resampled_messages)
   {
     // error checking
-    ROS_ASSERT(!messages.empty());
-    for (int i = 0; i < (int)messages.size(); ++i)
-    {
-      ROS_ASSERT(!messages[i].names.empty());
-      ROS_ASSERT(messages[i].names.size() == messages[i].data.size());
-    }
+    ROS_ASSERT(!sample_indices.empty());
+    ROS_ASSERT(recording_.getNumSignals() > 0);
     ROS_ASSERT(num_samples > 1);
 
     // extract indices
+    const std::vector<std::string>& recorded_names = recording_.getNames();
     std::vector<std::string> selected_names = message_names;
     if(selected_names.empty())
     {
-      selected_names = messages[0].names;
+      selected_names = recorded_names;
     }
 
     std::vector<int> indices;
-    ROS_VERIFY(task_recorder2_utilities::getIndices(messages[0].names, selected_names, indices));
-
-    const int num_messages = static_cast<int> (messages.size());
+    ROS_VERIFY(task_recorder2_utilities::getIndices(recorded_names, selected_names, indices));
     const int num_vars = static_cast<int>(indices.size());
 
-    // compute mean dt of the provided time stamps
-    double dts[num_messages - 1];
-    double mean_dt = 0.0;
-
-    std::vector<double> input_vector(num_messages);
-    input_vector[0] = messages[0].header.stamp.toSec();
-    for (int i = 0; i < num_messages - 1; i++)
-    {
-      dts[i] = messages[i + 1].header.stamp.toSec() - messages[i].header.stamp.toSec();
-      mean_dt += dts[i];
-      input_vector[i + 1] = input_vector[i] + dts[i];
-    }
-    mean_dt /= static_cast<double> (num_messages - 1);
+    // one contiguous column per variable, such that all variables can be resampled at once
+    std::vector<double> input_vector;
+    recording_.getColumns(sample_indices, indices, input_vector, variables_);
 
     ros::Duration interval = static_cast<ros::Duration> (end_time - start_time) * (1.0 / double(num_samples - 1));
     double wave_length = interval.toSec() * static_cast<double> (2.0);
 
-    resampled_messages.clear();
     std::vector<double> input_querry(num_samples);
     for (int i = 0; i < num_samples; i++)
     {
-      task_recorder2_msgs::DataSample msg;
-      msg.header.seq = i;
-      msg.header.stamp = static_cast<ros::Time> (start_time.toSec() + i * interval.toSec());
-      msg.header.frame_id = messages[0].header.frame_id;
-      input_querry[i] = msg.header.stamp.toSec();
-      resampled_messages.push_back(msg);
+      input_querry[i] = static_cast<ros::Time> (start_time.toSec() + i * interval.toSec()).toSec();
     }
 
-    std::vector<std::vector<double> > variables;
-    variables.resize(num_vars);
-    for (int j = 0; j < num_messages; ++j)
+    switch(splining_method_)
     {
-      for (int i = 0; i < num_vars; ++i)
+      case BSpline:
       {
-        variables[i].push_back(messages[j].data[indices[i]]);
+        ROS_VERIFY(usc_utilities::resampleColumns(input_vector, variables_, num_vars, wave_length, input_querry,
+                                                  resampled_variables_, false, num_resampling_threads_));
+        break;
       }
-    }
-
-    std::vector<std::vector<double> > variables_resampled;
-    variables_resampled.resize(num_vars);
-    for (int i = 0; i < num_vars; ++i)
-    {
-      switch(splining_method_)
+      case Linear:
       {
-        case BSpline:
-        {
-          ROS_VERIFY(usc_utilities::resample(input_vector, variables[i], wave_length, input_querry, variables_resampled[i], false));
-          // log(i, input_vector, variables[i], input_querry, variables_resampled[i]);
-          break;
-        }
-        case Linear:
-        {
-          ROS_VERIFY(usc_utilities::resampleLinearNoBounds(input_vector, variables[i], input_querry, variables_resampled[i]));
-          // log(i, input_vector, variables[i], input_querry, variables_resampled[i]);
-          break;
-        }
-        default:
-        {
-          ROS_ASSERT_MSG(false, "Unknown sampling method for task recorder with topic >%s<. This should never happen.", recorder_io_.topic_name_.c_str());
-        }
+        ROS_VERIFY(usc_utilities::resampleLinearNoBoundsColumns(input_vector, variables_, num_vars, input_querry, resampled_variables_));
+        break;
+      }
+      default:
+      {
+        ROS_ASSERT_MSG(false, "Unknown sampling method for task recorder with topic >%s<. This should never happen.", recorder_io_.topic_name_.c_str());
       }
     }
 
-    std::vector<std::string> names;
+    std::vector<std::string> names(num_vars);
     for (int i = 0; i < num_vars; ++i)
     {
-      names.push_back(messages[0].names[indices[i]]);
+      names[i] = recorded_names[indices[i]];
     }
+    resampled_messages.resize(num_samples);
     for (int j = 0; j < num_samples; ++j)
     {
-      resampled_messages[j].data.resize(num_vars, 0.0);
+      resampled_messages[j].header.seq = j;
+      resampled_messages[j].header.frame_id = recording_.getFrameId();
+      // make time stamps start from 0.0
+      resampled_messages[j].header.stamp = static_cast<ros::Time> (ros::TIME_MIN + ros::Duration(j * interval.toSec()));
+      resampled_messages[j].names = names;
+      resampled_messages[j].data.resize(num_vars);
       for (int i = 0; i < num_vars; ++i)
       {
-        resampled_messages[j].data[i] = variables_resampled[i][j];
+        resampled_messages[j].data[i] = resampled_variables_[i * num_samples + j];
       }
-      resampled_messages[j].names = names;
-      // make time stamps start from 0.0
-      resampled_messages[j].header.stamp = static_cast<ros::Time> (ros::TIME_MIN + ros::Duration(j * interval.toSec()));
     }
     return true;
   }
@@ -752,9 +764,9 @@ template<class MessageType>
     {
       return true;
     }
-    unfiltered_data_ = data_sample.data;
-    ROS_VERIFY(filter_.update(unfiltered_data_, filtered_data_));
-    data_sample.data = filtered_data_;
+    ROS_VERIFY(filter_.update(data_sample.data, filtered_data_));
+    // both vectors have num_signals_ entries, swapping avoids copying them
+    data_sample.data.swap(filtered_data_);
     return true;
   }
 
@@ -791,11 +803,7 @@ template<class MessageType>
 template<class MessageType>
   bool TaskRecorder<MessageType>::isStreaming()
   {
-    bool is_streaming;
-    mutex_.lock();
-    is_streaming = streaming_;
-    mutex_.unlock();
-    return is_streaming;
+    return streaming_.load(ros::memory_order_acquire);
   }
 
 }
@@ -16,6 +16,7 @@
 #define TASK_RECORDER_IO_H_
 
 // system includes
+#include <deque>
 
 // ros includes
 #include <ros/ros.h>
@@ -23,6 +24,8 @@
 #include <rosbag/bag.h>
 #include <boost/filesystem.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 
 #include <usc_utilities/assert.h>
 #include <usc_utilities/param_server.h>
@@ -35,6 +38,7 @@
 #include <task_recorder2_msgs/AccumulatedTrialStatistics.h>
 #include <task_recorder2_utilities/task_recorder_utilities.h>
 #include <task_recorder2_utilities/task_description_utilities.h>
+#include <task_recorder2_utilities/data_sample_recording.h>
 
 #include <dmp_lib/trajectory.h>
 
@@ -58,7 +62,7 @@ template<class MessageType>
      */
     TaskRecorderIO(ros::NodeHandle node_handle) :
       node_handle_(node_handle), write_out_raw_data_(false), write_out_clmc_data_(false), write_out_resampled_data_(false), write_out_statistics_(false),
-          initialized_(false) {};
+          initialized_(false), writer_(new Writer()) {};
     /*! Destructor
      */
     virtual ~TaskRecorderIO() {};
@@ -105,6 +109,27 @@ template<class MessageType>
     bool writeRawData(const std::string raw_directory_name);
     bool writeRawData();
 
+    /*! Queues writing messages_ on the I/O thread and returns immediately. The messages are moved into the job,
+     * messages_ is empty afterwards. The description and trial at the time of the call are used.
+     * @param directory_name
+     * @param increment_trial_counter
+     * @return True on success, otherwise False
+     */
+    bool writeRecordedDataAsync(const std::string directory_name, bool increment_trial_counter);
+    bool writeResampledDataAsync();
+    bool writeRawDataAsync();
+
+    /*! Queues writing the recording as raw data on the I/O thread, which creates the data samples one at a time
+     * @param recording
+     * @return True on success, otherwise False
+     */
+    bool writeRawDataAsync(boost::shared_ptr<const task_recorder2_utilities::DataSampleRecording> recording);
+
+    /*! Blocks until all queued writes are done
+     * @return True if all writes since the last call succeeded, otherwise False
+     */
+    bool waitForWrites();
+
     /*!
      * @return True on success, otherwise False
      */
@@ -140,6 +165,78 @@ template<class MessageType>
     boost::filesystem::path absolute_data_directory_path_;
     bool create_directories_;
 
+    /*! Everything needed to write a recording, such that the I/O thread does not access the TaskRecorderIO
+     */
+    struct WriteJob
+    {
+      boost::shared_ptr<const std::vector<MessageType> > messages;
+      // written instead of the messages if set
+      boost::shared_ptr<const task_recorder2_utilities::DataSampleRecording> recording;
+      std::string topic_name;
+      bool create_directories;
+      boost::filesystem::path absolute_data_directory_path;
+      std::string directory_name;
+      bool increment_trial_counter;
+      int trial;
+    };
+
+    /*! Long-lived I/O thread that executes the queued jobs in order, shared between copies
+     */
+    struct Writer
+    {
+      Writer() :
+        running(true), num_pending(0), succeeded(true) {};
+      ~Writer()
+      {
+        {
+          boost::mutex::scoped_lock lock(mutex);
+          running = false;
+          job_added.notify_all();
+        }
+        if(thread)
+        {
+          thread->join();
+        }
+      }
+      void run();
+
+      boost::mutex mutex;
+      boost::condition_variable job_added;
+      boost::condition_variable jobs_done;
+      std::deque<WriteJob> jobs;
+      bool running;
+      int num_pending;
+      bool succeeded;
+      boost::scoped_ptr<boost::thread> thread;
+    };
+    boost::shared_ptr<Writer> writer_;
+
+    /*! Runs on the I/O thread, therefore reports errors instead of asserting
+     * @return True on success, otherwise False
+     */
+    static bool writeMessages(const std::vector<MessageType>& messages,
+                              const task_recorder2_utilities::DataSampleRecording* recording,
+                              const std::string& topic_name,
+                              const bool create_directories,
+                              const boost::filesystem::path& absolute_data_directory_path,
+                              const std::string& directory_name,
+                              const bool increment_trial_counter,
+                              int& trial);
+
+    /*!
+     * @return True on success, otherwise False
+     */
+    static bool writeBagFile(const std::vector<MessageType>& messages,
+                             const task_recorder2_utilities::DataSampleRecording* recording,
+                             const std::string& topic_name,
+                             const std::string& file_name);
+
+    /*!
+     * @param job
+     * @return True on success, otherwise False
+     */
+    bool addWriteJob(WriteJob& job);
+
   };
 
 template<class MessageType>
@@ -170,6 +267,8 @@ template<class MessageType>
                                                    const std::string directory_name)
   {
     ROS_ASSERT_MSG(initialized_, "Task recorder IO module is not initialized.");
+    // pending writes may still increment the trial counter (failures have been reported by the I/O thread)
+    waitForWrites();
     description_ = description;
 
     if(create_directories_)
@@ -213,35 +312,209 @@ template<class MessageType>
                                                       bool increment_trial_counter)
   {
     ROS_ASSERT_MSG(initialized_, "Task recorder IO module is not initialized.");
+    return writeMessages(messages_, NULL, topic_name_, create_directories_, absolute_data_directory_path_,
+                         directory_name, increment_trial_counter, trial_);
+  }
 
-    if(create_directories_)
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::writeMessages(const std::vector<MessageType>& messages,
+                                                  const task_recorder2_utilities::DataSampleRecording* recording,
+                                                  const std::string& topic_name,
+                                                  const bool create_directories,
+                                                  const boost::filesystem::path& absolute_data_directory_path,
+                                                  const std::string& directory_name,
+                                                  const bool increment_trial_counter,
+                                                  int& trial)
+  {
+    if(create_directories)
     {
-      std::string file_name = task_recorder2_utilities::getPathNameIncludingTrailingSlash(absolute_data_directory_path_);
-      boost::filesystem::path path = absolute_data_directory_path_;
+      std::string file_name = task_recorder2_utilities::getPathNameIncludingTrailingSlash(absolute_data_directory_path);
+      boost::filesystem::path path = absolute_data_directory_path;
       if (!directory_name.empty())
       {
         file_name.append(directory_name);
-        path = boost::filesystem::path(absolute_data_directory_path_.directory_string() + std::string("/") + directory_name);
-        ROS_VERIFY(task_recorder2_utilities::checkForDirectory(file_name));
+        path = boost::filesystem::path(absolute_data_directory_path.directory_string() + std::string("/") + directory_name);
+        if (!task_recorder2_utilities::checkForDirectory(file_name))
+        {
+          ROS_ERROR("Could not create directory >%s< for topic >%s<.", file_name.c_str(), topic_name.c_str());
+          return false;
+        }
         usc_utilities::appendTrailingSlash(file_name);
       }
-      file_name.append(task_recorder2_utilities::getDataFileName(topic_name_, trial_));
-      ROS_VERIFY(usc_utilities::FileIO<MessageType>::writeToBagFileWithTimeStamps(messages_, topic_name_, file_name, false));
+      file_name.append(task_recorder2_utilities::getDataFileName(topic_name, trial));
+      if (!writeBagFile(messages, recording, topic_name, file_name))
+      {
+        return false;
+      }
       if (increment_trial_counter)
       {
-        ROS_VERIFY(task_recorder2_utilities::incrementTrialCounterFile(path, topic_name_));
-        ROS_VERIFY(task_recorder2_utilities::getTrialId(path, trial_, topic_name_));
-        ROS_VERIFY(task_recorder2_utilities::checkForCompleteness(path, trial_, topic_name_));
+        if (!task_recorder2_utilities::incrementTrialCounterFile(path, topic_name)
+            || !task_recorder2_utilities::getTrialId(path, trial, topic_name)
+            || !task_recorder2_utilities::checkForCompleteness(path, trial, topic_name))
+        {
+          ROS_ERROR("Could not update the trial counter of topic >%s< in >%s<.", topic_name.c_str(), path.file_string().c_str());
+          return false;
+        }
       }
     }
     else
     {
-      std::string file_name = absolute_data_directory_path_.file_string();
-      ROS_VERIFY(usc_utilities::FileIO<MessageType>::writeToBagFileWithTimeStamps(messages_, topic_name_, file_name, false));
+      std::string file_name = absolute_data_directory_path.file_string();
+      if (!writeBagFile(messages, recording, topic_name, file_name))
+      {
+        return false;
+      }
     }
     return true;
   }
 
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::writeBagFile(const std::vector<MessageType>& messages,
+                                                 const task_recorder2_utilities::DataSampleRecording* recording,
+                                                 const std::string& topic_name,
+                                                 const std::string& file_name)
+  {
+    if((recording == NULL && messages.empty()) || (recording != NULL && recording->empty()))
+    {
+      ROS_ERROR("Messages are empty. Cannot write anything to file >%s<.", file_name.c_str());
+      return false;
+    }
+    if(recording == NULL)
+    {
+      return usc_utilities::FileIO<MessageType>::writeToBagFileWithTimeStamps(messages, topic_name, file_name, false);
+    }
+    try
+    {
+      rosbag::Bag bag(file_name, rosbag::bagmode::Write);
+      task_recorder2_msgs::DataSample data_sample;
+      data_sample.header.frame_id = recording->getFrameId();
+      data_sample.names = recording->getNames();
+      for (int i = 0; i < recording->size(); ++i)
+      {
+        data_sample.header.seq = i;
+        data_sample.header.stamp = recording->getStamp(i);
+        data_sample.data.assign(recording->getData(i), recording->getData(i) + recording->getNumSignals());
+        bag.write(topic_name, data_sample.header.stamp, data_sample);
+      }
+      bag.close();
+    }
+    catch (rosbag::BagIOException& ex)
+    {
+      ROS_ERROR("Problem when writing to bag file named >%s< : %s.", file_name.c_str(), ex.what());
+      return false;
+    }
+    return true;
+  }
+
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::writeRecordedDataAsync(const std::string directory_name,
+                                                           bool increment_trial_counter)
+  {
+    ROS_ASSERT_MSG(initialized_, "Task recorder IO module is not initialized.");
+    boost::shared_ptr<std::vector<MessageType> > messages(new std::vector<MessageType>());
+    messages->swap(messages_);
+
+    WriteJob job;
+    job.messages = messages;
+    job.directory_name = directory_name;
+    job.increment_trial_counter = increment_trial_counter;
+    return addWriteJob(job);
+  }
+
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::writeRawDataAsync(boost::shared_ptr<const task_recorder2_utilities::DataSampleRecording> recording)
+  {
+    ROS_ASSERT_MSG(initialized_, "Task recorder IO module is not initialized.");
+    WriteJob job;
+    job.messages.reset(new std::vector<MessageType>());
+    job.recording = recording;
+    job.directory_name = std::string("raw");
+    job.increment_trial_counter = false;
+    return addWriteJob(job);
+  }
+
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::addWriteJob(WriteJob& job)
+  {
+    job.topic_name = topic_name_;
+    job.create_directories = create_directories_;
+    job.absolute_data_directory_path = absolute_data_directory_path_;
+    job.trial = trial_;
+
+    boost::mutex::scoped_lock lock(writer_->mutex);
+    if(!writer_->thread)
+    {
+      writer_->thread.reset(new boost::thread(boost::bind(&Writer::run, writer_.get())));
+    }
+    writer_->jobs.push_back(job);
+    writer_->num_pending++;
+    writer_->job_added.notify_one();
+    return true;
+  }
+
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::writeResampledDataAsync()
+  {
+    return writeRecordedDataAsync(std::string("resampled"), true);
+  }
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::writeRawDataAsync()
+  {
+    return writeRecordedDataAsync(std::string("raw"), false);
+  }
+
+template<class MessageType>
+  bool TaskRecorderIO<MessageType>::waitForWrites()
+  {
+    boost::mutex::scoped_lock lock(writer_->mutex);
+    while(writer_->num_pending > 0)
+    {
+      writer_->jobs_done.wait(lock);
+    }
+    bool succeeded = writer_->succeeded;
+    writer_->succeeded = true;
+    return succeeded;
+  }
+
+template<class MessageType>
+  void TaskRecorderIO<MessageType>::Writer::run()
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    while(true)
+    {
+      while(jobs.empty() && running)
+      {
+        job_added.wait(lock);
+      }
+      if(jobs.empty())
+      {
+        break;
+      }
+      WriteJob job = jobs.front();
+      jobs.pop_front();
+
+      lock.unlock();
+      const int num_messages = job.recording ? job.recording->size() : (int)job.messages->size();
+      bool job_succeeded = writeMessages(*job.messages, job.recording.get(), job.topic_name, job.create_directories,
+                                         job.absolute_data_directory_path, job.directory_name, job.increment_trial_counter, job.trial);
+      if(job_succeeded)
+      {
+        ROS_DEBUG("Wrote >%i< messages of topic >%s<.", num_messages, job.topic_name.c_str());
+      }
+      else
+      {
+        ROS_ERROR("Could not write >%i< messages of topic >%s<.", num_messages, job.topic_name.c_str());
+      }
+      job.messages.reset();
+      job.recording.reset();
+      lock.lock();
+
+      succeeded = succeeded && job_succeeded;
+      num_pending--;
+      jobs_done.notify_all();
+    }
+  }
+
 template<class MessageType>
   bool TaskRecorderIO<MessageType>::writeRecordedDataToCLMCFile(const std::string directory_name)
   {
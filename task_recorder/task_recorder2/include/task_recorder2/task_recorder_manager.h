@@ -134,6 +134,15 @@ private:
   task_recorder2_msgs::DataSample last_combined_data_sample_;
   boost::mutex last_combined_data_sample_mutex_;
 
+  /*! Position of each recorder's data in the combined data sample, computed once per stream
+   */
+  std::vector<int> data_sample_offsets_;
+  bool layout_valid_;
+  /*! If set, the names are only published along with the first sample after the layout changed
+   */
+  bool publish_names_on_layout_change_only_;
+  std::vector<std::string> unpublished_names_;
+
   /*!
    */
   std::vector<task_recorder2::StartStreaming::Request> start_streaming_requests_;
@@ -142,6 +151,9 @@ private:
   std::vector<task_recorder2::StartRecording::Response> start_recording_responses_;
   std::vector<task_recorder2::StopRecording::Request> stop_recording_requests_;
   std::vector<task_recorder2::StopRecording::Response> stop_recording_responses_;
+  std::vector<int> stop_recording_succeeded_;
+  // recorders are stopped on at most this many threads, each recorder resamples on num_resampling_threads
+  int num_stop_recording_threads_;
   std::vector<task_recorder2::InterruptRecording::Request> interrupt_recording_requests_;
   std::vector<task_recorder2::InterruptRecording::Response> interrupt_recording_responses_;
 
@@ -158,6 +170,12 @@ private:
    */
   ros::Publisher stop_recording_publisher_;
 
+  /*! Stops the recorders worker, worker + num_workers, ...
+   * @param worker
+   * @param num_workers
+   */
+  void stopRecordingWorker(const int worker, const int num_workers);
+
   /*!
    * @param timer_event
    */
@@ -169,6 +187,11 @@ private:
    */
   bool setLastDataSample(const ros::Time& time_stamp);
 
+  /*! Computes names and offsets of the combined data sample if necessary
+   * @return True if the layout changed, otherwise False
+   */
+  bool updateLayout();
+
 };
 
 }
@@ -13,7 +13,9 @@
  *********************************************************************/
 
 // system includes
-// #include <boost/thread.hpp>
+#include <algorithm>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <usc_utilities/assert.h>
 #include <usc_utilities/param_server.h>
 
@@ -28,7 +30,8 @@ namespace task_recorder2
 {
 
 TaskRecorderManager::TaskRecorderManager(ros::NodeHandle node_handle) :
-    initialized_(false), recorder_io_(node_handle), counter_(-1)
+    initialized_(false), recorder_io_(node_handle), counter_(-1), layout_valid_(false), publish_names_on_layout_change_only_(false),
+    num_stop_recording_threads_(1)
 {
   ROS_DEBUG("Creating task recorder manager in namespace >%s<.", node_handle.getNamespace().c_str());
   ROS_VERIFY(recorder_io_.initialize(recorder_io_.node_handle_.getNamespace() + std::string("/data_samples")));
@@ -46,6 +49,10 @@ bool TaskRecorderManager::initialize()
   start_recording_responses_.resize(task_recorders_.size());
   stop_recording_requests_.resize(task_recorders_.size());
   stop_recording_responses_.resize(task_recorders_.size());
+  stop_recording_succeeded_.resize(task_recorders_.size(), 0);
+  recorder_io_.node_handle_.param("num_stop_recording_threads", num_stop_recording_threads_,
+                                  std::max(1, (int)boost::thread::hardware_concurrency()));
+  ROS_ASSERT_MSG(num_stop_recording_threads_ > 0, "Number of stop recording threads >%i< must be positive.", num_stop_recording_threads_);
   interrupt_recording_requests_.resize(task_recorders_.size());
   interrupt_recording_responses_.resize(task_recorders_.size());
 
@@ -53,6 +60,7 @@ bool TaskRecorderManager::initialize()
   ROS_VERIFY(usc_utilities::read(recorder_io_.node_handle_, "sampling_rate", sampling_rate));
   ROS_ASSERT(sampling_rate > 0);
   update_timer_period_ = static_cast<double>(1.0) / sampling_rate;
+  recorder_io_.node_handle_.param("publish_names_on_layout_change_only", publish_names_on_layout_change_only_, false);
   timer_ = recorder_io_.node_handle_.createTimer(ros::Duration(update_timer_period_), &TaskRecorderManager::timerCB, this);
 
   const int PUBLISHER_BUFFER_SIZE = 1000;
@@ -72,6 +80,9 @@ bool TaskRecorderManager::startStreaming(task_recorder2::StartStreaming::Request
                                          task_recorder2::StartStreaming::Response& response)
 {
   ROS_ASSERT(initialized_);
+  last_combined_data_sample_mutex_.lock();
+  layout_valid_ = false;
+  last_combined_data_sample_mutex_.unlock();
   for (int i = 0; i < (int)task_recorders_.size(); ++i)
   {
     start_streaming_requests_[i] = request;
@@ -105,54 +116,73 @@ bool TaskRecorderManager::startRecording(task_recorder2::StartRecording::Request
   return true;
 }
 
+void TaskRecorderManager::stopRecordingWorker(const int worker, const int num_workers)
+{
+  for (int i = worker; i < (int)task_recorders_.size(); i += num_workers)
+  {
+    stop_recording_succeeded_[i] = (task_recorders_[i]->stopRecording(stop_recording_requests_[i], stop_recording_responses_[i])
+        && stop_recording_responses_[i].return_code == task_recorder2::StopRecording::Response::SERVICE_CALL_SUCCESSFUL);
+  }
+}
+
 bool TaskRecorderManager::stopRecording(task_recorder2::StopRecording::Request& request,
                                         task_recorder2::StopRecording::Response& response)
 {
   ROS_ASSERT(initialized_);
-  for (int i = 0; i < (int)task_recorders_.size(); ++i)
+  const int num_recorders = (int)task_recorders_.size();
+  for (int i = 0; i < num_recorders; ++i)
   {
     stop_recording_requests_[i] = request;
     stop_recording_requests_[i].message_names.clear();
     stop_recording_responses_[i] = response;
-    ROS_VERIFY(task_recorders_[i]->stopRecording(stop_recording_requests_[i], stop_recording_responses_[i]));
+  }
+
+  // the recorders filter, crop and resample independently, the calling thread acts as worker 0
+  const int num_workers = std::min(num_recorders, num_stop_recording_threads_);
+  boost::thread_group workers;
+  for (int i = 1; i < num_workers; ++i)
+  {
+    workers.create_thread(boost::bind(&TaskRecorderManager::stopRecordingWorker, this, i, num_workers));
+  }
+  stopRecordingWorker(0, num_workers);
+  workers.join_all();
 
-    ROS_ASSERT(stop_recording_responses_[i].return_code == task_recorder2::StopRecording::Response::SERVICE_CALL_SUCCESSFUL);
+  for (int i = 0; i < num_recorders; ++i)
+  {
+    ROS_VERIFY(stop_recording_succeeded_[i]);
     response.info.append(stop_recording_responses_[i].info);
     ROS_DEBUG("Got >%i< messages.", (int)stop_recording_responses_[i].filtered_and_cropped_messages.size());
   }
 
-  int num_messages = 0;
+  // error checking
+  ROS_ASSERT(!stop_recording_responses_[0].filtered_and_cropped_messages.empty());
+  const int num_messages = (int)stop_recording_responses_[0].filtered_and_cropped_messages.size();
+  std::vector<int> variable_offsets(num_recorders + 1, 0);
   std::vector<std::string> all_variable_names;
-  for (int i = 0; i < (int)task_recorders_.size(); ++i)
+  for (int i = 0; i < num_recorders; ++i)
   {
-    // error checking
-    ROS_ASSERT(!stop_recording_responses_[i].filtered_and_cropped_messages.empty());
-    num_messages = (int)stop_recording_responses_[i].filtered_and_cropped_messages.size();
-    if (i < static_cast<int> (task_recorders_.size() - 1))
-    {
-      ROS_ASSERT(num_messages == (int)stop_recording_responses_[i].filtered_and_cropped_messages.size());
-    }
-    all_variable_names.insert(all_variable_names.end(),
-                              stop_recording_responses_[i].filtered_and_cropped_messages[0].names.begin(),
-                              stop_recording_responses_[i].filtered_and_cropped_messages[0].names.end());
+    ROS_ASSERT(num_messages == (int)stop_recording_responses_[i].filtered_and_cropped_messages.size());
+    const std::vector<std::string>& names = stop_recording_responses_[i].filtered_and_cropped_messages[0].names;
+    all_variable_names.insert(all_variable_names.end(), names.begin(), names.end());
+    variable_offsets[i + 1] = variable_offsets[i] + (int)names.size();
   }
+  const int num_variables = variable_offsets[num_recorders];
 
-  // accumulate all data samples
-  recorder_io_.messages_.clear();
-
+  // accumulate all data samples, the messages of the previous recording are reused
+  recorder_io_.messages_.resize(num_messages);
   for (int j = 0; j < num_messages; ++j)
   {
-    task_recorder2_msgs::DataSample data_sample;
+    task_recorder2_msgs::DataSample& data_sample = recorder_io_.messages_[j];
     data_sample.header.seq = j;
     data_sample.header.stamp = stop_recording_responses_[0].filtered_and_cropped_messages[j].header.stamp;
     data_sample.names = all_variable_names;
-    for (int i = 0; i < (int)task_recorders_.size(); ++i)
+    data_sample.data.resize(num_variables);
+    for (int i = 0; i < num_recorders; ++i)
     {
-      data_sample.data.insert(data_sample.data.end(),
-                              stop_recording_responses_[i].filtered_and_cropped_messages[j].data.begin(),
-                              stop_recording_responses_[i].filtered_and_cropped_messages[j].data.end());
+      const std::vector<double>& data = stop_recording_responses_[i].filtered_and_cropped_messages[j].data;
+      ROS_ASSERT((int)data.size() == variable_offsets[i + 1] - variable_offsets[i]);
+      std::copy(data.begin(), data.end(), data_sample.data.begin() + variable_offsets[i]);
     }
-    recorder_io_.messages_.push_back(data_sample);
   }
 
   // if requested names is empty... return all...
@@ -253,20 +283,59 @@ bool TaskRecorderManager::setLastDataSample(const ros::Time& time_stamp)
   }
   counter_++;
 
-  // TODO: think about how to avoid memory re-allocation
-  last_combined_data_sample_.names.clear();
-  last_combined_data_sample_.data.clear();
+  const bool layout_changed = updateLayout();
   last_combined_data_sample_.header.seq = counter_;
   last_combined_data_sample_.header.stamp = time_stamp;
   for (int i = 0; i < (int)task_recorders_.size(); ++i)
   {
-    last_combined_data_sample_.names.insert(last_combined_data_sample_.names.end(), data_samples_[i].names.begin(), data_samples_[i].names.end());
-    last_combined_data_sample_.data.insert(last_combined_data_sample_.data.end(), data_samples_[i].data.begin(), data_samples_[i].data.end());
+    std::copy(data_samples_[i].data.begin(), data_samples_[i].data.end(),
+              last_combined_data_sample_.data.begin() + data_sample_offsets_[i]);
+  }
+
+  if (publish_names_on_layout_change_only_ && !layout_changed)
+  {
+    // subscribers keep the names of the last sample that contained them
+    last_combined_data_sample_.names.swap(unpublished_names_);
+    data_sample_publisher_.publish(last_combined_data_sample_);
+    last_combined_data_sample_.names.swap(unpublished_names_);
+  }
+  else
+  {
+    data_sample_publisher_.publish(last_combined_data_sample_);
   }
-  data_sample_publisher_.publish(last_combined_data_sample_);
   return true;
 }
 
+bool TaskRecorderManager::updateLayout()
+{
+  const int num_recorders = (int)task_recorders_.size();
+  if (layout_valid_)
+  {
+    bool layout_changed = false;
+    for (int i = 0; i < num_recorders && !layout_changed; ++i)
+    {
+      layout_changed = ((int)data_samples_[i].data.size() != data_sample_offsets_[i + 1] - data_sample_offsets_[i]);
+    }
+    if (!layout_changed)
+    {
+      return false;
+    }
+  }
+
+  data_sample_offsets_.resize(num_recorders + 1);
+  data_sample_offsets_[0] = 0;
+  last_combined_data_sample_.names.clear();
+  for (int i = 0; i < num_recorders; ++i)
+  {
+    ROS_ASSERT(data_samples_[i].names.size() == data_samples_[i].data.size());
+    last_combined_data_sample_.names.insert(last_combined_data_sample_.names.end(), data_samples_[i].names.begin(), data_samples_[i].names.end());
+    data_sample_offsets_[i + 1] = data_sample_offsets_[i] + (int)data_samples_[i].data.size();
+  }
+  last_combined_data_sample_.data.resize(data_sample_offsets_[num_recorders]);
+  ROS_DEBUG("Combined data samples contain >%i< signals.", data_sample_offsets_[num_recorders]);
+  return (layout_valid_ = true);
+}
+
 void TaskRecorderManager::timerCB(const ros::TimerEvent& timer_event)
 {
   last_combined_data_sample_mutex_.lock();
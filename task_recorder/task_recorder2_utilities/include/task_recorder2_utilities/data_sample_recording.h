@@ -0,0 +1,154 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		Columnar storage of recorded data samples: the names
+            are stored once, the data of all samples in one array.
+
+  \file		data_sample_recording.h
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+#ifndef DATA_SAMPLE_RECORDING_H_
+#define DATA_SAMPLE_RECORDING_H_
+
+// system includes
+#include <vector>
+#include <string>
+#include <ros/ros.h>
+
+#include <task_recorder2_msgs/DataSample.h>
+
+// local includes
+
+namespace task_recorder2_utilities
+{
+
+/*! Stores the stamps and data of recorded samples without allocating memory per sample, as long as the number of
+ *  samples does not exceed the reserved capacity. The data of sample i is stored at getData(i), its signals are
+ *  contiguous.
+ */
+class DataSampleRecording
+{
+
+public:
+
+  /*! Constructor
+   */
+  DataSampleRecording() :
+    num_signals_(0), num_samples_(0) {};
+  /*! Destructor
+   */
+  virtual ~DataSampleRecording() {};
+
+  /*!
+   * @param names of the signals
+   * @param capacity Number of samples memory is reserved for
+   */
+  void initialize(const std::vector<std::string>& names,
+                  const int capacity);
+
+  /*! Removes all samples, the capacity is kept
+   */
+  void clear()
+  {
+    num_samples_ = 0;
+  }
+
+  /*! The frame id is the same for all samples of a recording
+   * @param frame_id
+   */
+  void setFrameId(const std::string& frame_id)
+  {
+    frame_id_ = frame_id;
+  }
+
+  /*!
+   * @param stamp
+   * @param data
+   * @return True on success, otherwise False
+   */
+  bool add(const ros::Time& stamp,
+           const std::vector<double>& data);
+
+  /*!
+   * @return Number of recorded samples
+   */
+  int size() const
+  {
+    return num_samples_;
+  }
+  bool empty() const
+  {
+    return (num_samples_ == 0);
+  }
+  int getNumSignals() const
+  {
+    return num_signals_;
+  }
+  const std::vector<std::string>& getNames() const
+  {
+    return names_;
+  }
+  const ros::Time& getStamp(const int index) const
+  {
+    return stamps_[index];
+  }
+  const double* getData(const int index) const
+  {
+    return &data_[index * num_signals_];
+  }
+
+  const std::string& getFrameId() const
+  {
+    return frame_id_;
+  }
+
+  /*! Selects the samples that task_recorder2_utilities::crop() followed by removeDuplicates() would keep, i.e. the
+   *  last sample before start_time up to the last sample before or at end_time, without samples that are invalid
+   *  or less than 1e-6 seconds after their predecessor.
+   * @param start_time
+   * @param end_time
+   * @param sample_indices (output) indices of the selected samples
+   * @return True on success, False if the times are not contained in the recording
+   */
+  bool getCroppedIndices(const ros::Time& start_time,
+                         const ros::Time& end_time,
+                         std::vector<int>& sample_indices) const;
+
+  /*! Copies the given signals of the given samples into one contiguous column per signal
+   * @param sample_indices
+   * @param signal_indices
+   * @param times (output) stamps of the samples in seconds
+   * @param columns (output) signal i of sample j is stored at i * sample_indices.size() + j
+   */
+  void getColumns(const std::vector<int>& sample_indices,
+                  const std::vector<int>& signal_indices,
+                  std::vector<double>& times,
+                  std::vector<double>& columns) const;
+
+  /*! Copies the given samples (stamps and data) into a recording that only has the memory for them
+   * @param sample_indices
+   * @param recording (output)
+   */
+  void getSamples(const std::vector<int>& sample_indices,
+                  DataSampleRecording& recording) const;
+
+private:
+
+  int num_signals_;
+  int num_samples_;
+  std::vector<std::string> names_;
+  std::string frame_id_;
+  std::vector<ros::Time> stamps_;
+  std::vector<double> data_;
+
+};
+
+}
+
+#endif /* DATA_SAMPLE_RECORDING_H_ */
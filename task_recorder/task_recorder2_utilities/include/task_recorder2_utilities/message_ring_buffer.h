@@ -1,10 +1,11 @@
 /*********************************************************************
   Computational Learning and Motor Control Lab
   University of Southern California
-  Prof. Stefan Schaal 
+  Prof. Stefan Schaal
  *********************************************************************
-  \remarks		...
- 
+  \remarks		Ring buffer of data samples with a single writer and any
+            number of lock-free readers.
+
   \file		message_ring_buffer.h
 
   \author	Peter Pastor
@@ -17,25 +18,36 @@
 
 // system includes
 #include <vector>
+#include <string>
+#include <stdint.h>
 #include <ros/ros.h>
+#include <ros/atomic.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_array.hpp>
 
 #include <task_recorder2_msgs/DataSample.h>
 
 // local includes
-#include <task_recorder2_utilities/circular_message_buffer.h>
 
 namespace task_recorder2_utilities
 {
 
+/*! Stores the most recent data samples in a fixed number of preallocated slots. Samples must be added in
+ *  order of their time stamps by a single thread, which allows get() to binary search the stamps. Each slot
+ *  is protected by a sequence counter (seqlock): readers never block the writer, instead they retry if the
+ *  slot they have been reading got overwritten in the meantime.
+ */
 class MessageRingBuffer
 {
 
   static const int DEFAULT_RING_BUFFER_SIZE = 200;
+  static const int MAX_NUM_READ_ATTEMPTS = 10;
 
 public:
 
   /*! Constructor
+   * @param default_data_sample Provides the names (and therefore number) of the signals
+   * @param ring_buffer_size
    */
   MessageRingBuffer(const task_recorder2_msgs::DataSample& default_data_sample,
                     const int ring_buffer_size = DEFAULT_RING_BUFFER_SIZE);
@@ -43,18 +55,20 @@ public:
    */
   virtual ~MessageRingBuffer() {};
 
-  /*!
+  /*! Must only be called from a single thread. Samples that are older than the most recent one are dropped.
    * @param data_sample
    * @return True on success, otherwise False
    */
   bool add(const task_recorder2_msgs::DataSample& data_sample);
 
-  /*!
+  /*! Can be called from any number of threads concurrently to add()
    * @param time
-   * @param data_sample
-   * @return True on success, otherwise False
+   * @param data_sample Most recent sample that is not newer than time. If interpolate is set and time lies between
+   * two samples, the data is linearly interpolated and the stamp is set to time.
+   * @param interpolate
+   * @return True on success, False if time is older than the oldest sample in the buffer
    */
-  bool get(const ros::Time& time, task_recorder2_msgs::DataSample& data_sample);
+  bool get(const ros::Time& time, task_recorder2_msgs::DataSample& data_sample, const bool interpolate = false);
 
 private:
 
@@ -64,7 +78,42 @@ private:
 
   /*!
    */
-  boost::shared_ptr<CircularMessageBuffer<task_recorder2_msgs::DataSample> > circular_buffer_;
+  struct Slot
+  {
+    ros::atomic<uint32_t> sequence; //<! odd while the slot is being written
+    uint64_t index; //<! number of samples added before this one
+    ros::Time stamp;
+    std::vector<double> data;
+  };
+
+  /*! Reads the stamp of the sample with the given index
+   * @return False if the slot has been (or is being) overwritten
+   */
+  bool readStamp(const uint64_t index, ros::Time& stamp) const;
+
+  /*! Reads the stamp and data of the sample with the given index
+   * @return False if the slot has been (or is being) overwritten
+   */
+  bool readData(const uint64_t index, ros::Time& stamp, std::vector<double>& data) const;
+
+  /*! Finds the newest sample that is not newer than time
+   * @return 1 if found, 0 if time is older than all samples, -1 if the buffer changed while searching
+   */
+  int find(const ros::Time& time, uint64_t& index, uint64_t& num_added) const;
+
+  /*!
+   */
+  int capacity_;
+  boost::scoped_array<Slot> slots_;
+  ros::atomic<uint64_t> num_added_;
+
+  /*! Only accessed by the writer
+   */
+  ros::Time last_stamp_;
+
+  /*!
+   */
+  std::vector<std::string> names_;
 
 };
 
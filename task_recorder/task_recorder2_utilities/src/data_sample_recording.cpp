@@ -0,0 +1,127 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		...
+
+  \file		data_sample_recording.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <algorithm>
+
+// local includes
+#include <task_recorder2_utilities/data_sample_recording.h>
+
+namespace task_recorder2_utilities
+{
+
+void DataSampleRecording::initialize(const std::vector<std::string>& names,
+                                     const int capacity)
+{
+  names_ = names;
+  num_signals_ = (int)names_.size();
+  num_samples_ = 0;
+  stamps_.resize(std::max(capacity, 1));
+  data_.resize(stamps_.size() * num_signals_);
+}
+
+bool DataSampleRecording::add(const ros::Time& stamp,
+                              const std::vector<double>& data)
+{
+  // error checking
+  if((int)data.size() != num_signals_)
+  {
+    ROS_ERROR("Size of data vector >%i< needs to be >%i<.", (int)data.size(), num_signals_);
+    return false;
+  }
+
+  if(num_samples_ == (int)stamps_.size())
+  {
+    ROS_WARN("Recorded >%i< samples, reserving memory for more. Consider increasing the capacity.", num_samples_);
+    stamps_.resize(2 * stamps_.size());
+    data_.resize(stamps_.size() * num_signals_);
+  }
+  stamps_[num_samples_] = stamp;
+  std::copy(data.begin(), data.end(), data_.begin() + num_samples_ * num_signals_);
+  num_samples_++;
+  return true;
+}
+
+bool DataSampleRecording::getCroppedIndices(const ros::Time& start_time,
+                                            const ros::Time& end_time,
+                                            std::vector<int>& sample_indices) const
+{
+  sample_indices.clear();
+  int first = 0;
+  while (first + 1 < num_samples_ && stamps_[first + 1] < start_time)
+  {
+    first++;
+  }
+  int last = num_samples_ - 1;
+  while (last >= 0 && stamps_[last] > end_time)
+  {
+    last--;
+  }
+  if (num_samples_ == 0 || stamps_[num_samples_ - 1] < start_time || last < first)
+  {
+    ROS_ERROR("Looks like the start and end time are not contained in the recorded samples. Check the requested times.");
+    return false;
+  }
+
+  if (stamps_[first] >= ros::TIME_MIN)
+  {
+    sample_indices.push_back(first);
+  }
+  else
+  {
+    ROS_WARN("Found sample (%i) with invalid stamp.", first);
+  }
+  for (int i = first + 1; i <= last; ++i)
+  {
+    if (stamps_[i].toSec() - stamps_[i - 1].toSec() >= 1e-6 && stamps_[i] >= ros::TIME_MIN)
+    {
+      sample_indices.push_back(i);
+    }
+  }
+  return true;
+}
+
+void DataSampleRecording::getColumns(const std::vector<int>& sample_indices,
+                                     const std::vector<int>& signal_indices,
+                                     std::vector<double>& times,
+                                     std::vector<double>& columns) const
+{
+  const int num_selected_samples = (int)sample_indices.size();
+  times.resize(num_selected_samples);
+  columns.resize(num_selected_samples * signal_indices.size());
+  for (int j = 0; j < num_selected_samples; ++j)
+  {
+    times[j] = stamps_[sample_indices[j]].toSec();
+    const double* data = getData(sample_indices[j]);
+    for (int i = 0; i < (int)signal_indices.size(); ++i)
+    {
+      columns[i * num_selected_samples + j] = data[signal_indices[i]];
+    }
+  }
+}
+
+void DataSampleRecording::getSamples(const std::vector<int>& sample_indices,
+                                     DataSampleRecording& recording) const
+{
+  recording.initialize(names_, (int)sample_indices.size());
+  recording.frame_id_ = frame_id_;
+  for (int j = 0; j < (int)sample_indices.size(); ++j)
+  {
+    recording.stamps_[j] = stamps_[sample_indices[j]];
+    std::copy(getData(sample_indices[j]), getData(sample_indices[j]) + num_signals_, recording.data_.begin() + j * num_signals_);
+  }
+  recording.num_samples_ = (int)sample_indices.size();
+}
+
+}
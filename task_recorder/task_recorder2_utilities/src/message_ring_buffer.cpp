@@ -1,10 +1,10 @@
 /*********************************************************************
   Computational Learning and Motor Control Lab
   University of Southern California
-  Prof. Stefan Schaal 
+  Prof. Stefan Schaal
  *********************************************************************
   \remarks		...
- 
+
   \file		message_ring_buffer.cpp
 
   \author	Peter Pastor
@@ -13,59 +13,176 @@
  *********************************************************************/
 
 // system includes
+#include <algorithm>
 
 // local includes
 #include <task_recorder2_utilities/message_ring_buffer.h>
-#include <boost/circular_buffer.hpp>
 
 namespace task_recorder2_utilities
 {
 
 MessageRingBuffer::MessageRingBuffer(const task_recorder2_msgs::DataSample& default_data_sample,
-                                     const int ring_buffer_size)
+                                     const int ring_buffer_size) :
+  capacity_(std::max(ring_buffer_size, 2)), slots_(new Slot[std::max(ring_buffer_size, 2)]), num_added_(0),
+  last_stamp_(ros::TIME_MIN), names_(default_data_sample.names)
 {
-  circular_buffer_.reset(new CircularMessageBuffer<task_recorder2_msgs::DataSample>(ring_buffer_size, default_data_sample));
+  for (int i = 0; i < capacity_; ++i)
+  {
+    slots_[i].sequence.store(0, ros::memory_order_relaxed);
+    slots_[i].index = 0;
+    slots_[i].data.resize(default_data_sample.data.size(), 0.0);
+  }
 }
 
 bool MessageRingBuffer::add(const task_recorder2_msgs::DataSample& data_sample)
 {
   // error checking
-  if(!circular_buffer_->empty())
+  if(slots_[0].data.size() != data_sample.data.size())
   {
-    if(circular_buffer_->front().data.size() != data_sample.data.size())
-    {
-      ROS_ERROR("Size of data vector >%i< needs to be >%i<.",
-                (int)circular_buffer_->front().data.size(), (int)data_sample.data.size());
-      return false;
-    }
+    ROS_ERROR("Size of data vector >%i< needs to be >%i<.",
+              (int)data_sample.data.size(), (int)slots_[0].data.size());
+    return false;
   }
 
-  // fill the buffer if it has been empty
-  if(circular_buffer_->size() == 0)
+  uint64_t num_added = num_added_.load(ros::memory_order_relaxed);
+  if(num_added > 0 && data_sample.header.stamp < last_stamp_)
   {
-    for (unsigned int i = 0; i < circular_buffer_->capacity(); ++i)
-    {
-      circular_buffer_->push_back(data_sample);
-    }
+    ROS_WARN("Data sample with stamp >%f< is older than the most recent sample >%f<. Dropping it.",
+             data_sample.header.stamp.toSec(), last_stamp_.toSec());
+    return true;
   }
+  last_stamp_ = data_sample.header.stamp;
+
+  // the slot contains garbage while the sequence number is odd
+  Slot& slot = slots_[num_added % capacity_];
+  uint32_t sequence = slot.sequence.load(ros::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, ros::memory_order_relaxed);
+  ros::atomic_thread_fence(ros::memory_order_release);
+
+  slot.index = num_added;
+  slot.stamp = data_sample.header.stamp;
+  std::copy(data_sample.data.begin(), data_sample.data.end(), slot.data.begin());
 
-  circular_buffer_->push_back(data_sample);
+  slot.sequence.store(sequence + 2, ros::memory_order_release);
+  num_added_.store(num_added + 1, ros::memory_order_release);
   return true;
 }
 
-bool MessageRingBuffer::get(const ros::Time& time, task_recorder2_msgs::DataSample& data_sample)
+bool MessageRingBuffer::readStamp(const uint64_t index, ros::Time& stamp) const
 {
-  bool found = false;
-  boost::circular_buffer<task_recorder2_msgs::DataSample>::const_reverse_iterator rci;
-  for(rci = circular_buffer_->cb_.rbegin(); rci!= circular_buffer_->cb_.rend() && !found; ++rci)
+  const Slot& slot = slots_[index % capacity_];
+  uint32_t sequence = slot.sequence.load(ros::memory_order_acquire);
+  if((sequence & 1) != 0)
+  {
+    return false;
+  }
+  uint64_t slot_index = slot.index;
+  stamp = slot.stamp;
+  ros::atomic_thread_fence(ros::memory_order_acquire);
+  return (slot_index == index && slot.sequence.load(ros::memory_order_relaxed) == sequence);
+}
+
+bool MessageRingBuffer::readData(const uint64_t index, ros::Time& stamp, std::vector<double>& data) const
+{
+  const Slot& slot = slots_[index % capacity_];
+  uint32_t sequence = slot.sequence.load(ros::memory_order_acquire);
+  if((sequence & 1) != 0)
+  {
+    return false;
+  }
+  uint64_t slot_index = slot.index;
+  stamp = slot.stamp;
+  data.resize(slot.data.size());
+  std::copy(slot.data.begin(), slot.data.end(), data.begin());
+  ros::atomic_thread_fence(ros::memory_order_acquire);
+  return (slot_index == index && slot.sequence.load(ros::memory_order_relaxed) == sequence);
+}
+
+int MessageRingBuffer::find(const ros::Time& time, uint64_t& index, uint64_t& num_added) const
+{
+  num_added = num_added_.load(ros::memory_order_acquire);
+  if(num_added == 0)
+  {
+    return 0;
+  }
+  // the oldest slot is the next one to be overwritten, therefore it is left out
+  uint64_t first = (num_added > (uint64_t)capacity_) ? num_added - capacity_ + 1 : 0;
+  uint64_t last = num_added - 1;
+
+  ros::Time stamp;
+  if(!readStamp(first, stamp))
+  {
+    return -1;
+  }
+  if(time < stamp)
   {
-    if (rci->header.stamp <= time)
+    return 0;
+  }
+
+  // invariant: stamp of first <= time, find the last sample for which this holds
+  while(first < last)
+  {
+    uint64_t middle = first + (last - first + 1) / 2;
+    if(!readStamp(middle, stamp))
+    {
+      return -1;
+    }
+    if(stamp <= time)
+    {
+      first = middle;
+    }
+    else
+    {
+      last = middle - 1;
+    }
+  }
+  index = first;
+  return 1;
+}
+
+bool MessageRingBuffer::get(const ros::Time& time, task_recorder2_msgs::DataSample& data_sample, const bool interpolate)
+{
+  for (int attempt = 0; attempt < MAX_NUM_READ_ATTEMPTS; ++attempt)
+  {
+    uint64_t index, num_added;
+    int found = find(time, index, num_added);
+    if(found == 0)
+    {
+      return false;
+    }
+    if(found < 0)
+    {
+      continue;
+    }
+
+    ros::Time stamp;
+    if(!readData(index, stamp, data_sample.data))
+    {
+      continue;
+    }
+    data_sample.header.stamp = stamp;
+
+    if(interpolate && stamp < time && index + 1 < num_added)
     {
-      data_sample = *rci;
-      found = true;
+      ros::Time next_stamp;
+      std::vector<double> next_data;
+      if(!readData(index + 1, next_stamp, next_data))
+      {
+        continue;
+      }
+      double alpha = (time - stamp).toSec() / (next_stamp - stamp).toSec();
+      for (int i = 0; i < (int)data_sample.data.size(); ++i)
+      {
+        data_sample.data[i] += alpha * (next_data[i] - data_sample.data[i]);
+      }
+      data_sample.header.stamp = time;
     }
+
+    data_sample.names = names_;
+    return true;
   }
-  return found;
+  ROS_WARN("Could not read from the message ring buffer after >%i< attempts, the writer is too fast.", (int)MAX_NUM_READ_ATTEMPTS);
+  return false;
 }
 
 }
@@ -0,0 +1,129 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		Checks that cropping a data sample recording selects the
+            same samples as crop() followed by removeDuplicates().
+
+  \file		data_sample_recording_test.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <gtest/gtest.h>
+
+// local includes
+#include <task_recorder2_utilities/data_sample_recording.h>
+#include <task_recorder2_utilities/task_recorder_utilities.h>
+
+using namespace task_recorder2_utilities;
+
+static const int NUM_RECORDINGS = 1000;
+
+/*! Milliseconds after one second
+ */
+static ros::Time getStamp(const int milliseconds)
+{
+  ros::Time stamp;
+  stamp.fromNSec(1000000000ull + static_cast<uint64_t> (milliseconds) * 1000000ull);
+  return stamp;
+}
+
+/*! Records samples with random gaps, some of them duplicates of their predecessor and the first one sometimes without
+ *  a valid stamp. The first signal of sample i is i.
+ */
+static void record(DataSampleRecording& recording,
+                   std::vector<task_recorder2_msgs::DataSample>& messages)
+{
+  std::vector<std::string> names;
+  names.push_back("index");
+  names.push_back("value");
+  // a small capacity makes the recording grow
+  recording.initialize(names, 3);
+  messages.clear();
+
+  const int num_samples = 2 + rand() % 40;
+  int milliseconds = 0;
+  for (int i = 0; i < num_samples; ++i)
+  {
+    if (rand() % 5 != 0)
+    {
+      milliseconds += 1 + rand() % 5;
+    }
+    task_recorder2_msgs::DataSample message;
+    message.header.stamp = getStamp(milliseconds);
+    if (i == 0 && rand() % 5 == 0)
+    {
+      message.header.stamp = ros::Time();
+    }
+    message.names = names;
+    message.data.push_back(i);
+    message.data.push_back(0.5 * i);
+    ASSERT_TRUE(recording.add(message.header.stamp, message.data));
+    messages.push_back(message);
+  }
+}
+
+TEST(data_sample_recording_test, croppedIndicesMatchCropAndRemoveDuplicates)
+{
+  srand(1);
+  int num_compared = 0;
+  for (int n = 0; n < NUM_RECORDINGS; ++n)
+  {
+    DataSampleRecording recording;
+    std::vector<task_recorder2_msgs::DataSample> messages;
+    record(recording, messages);
+    ASSERT_EQ((int)messages.size(), recording.size());
+
+    const int duration = static_cast<int> ((messages.back().header.stamp - getStamp(0)).toSec() * 1000.0 + 0.5);
+    const int start = rand() % (duration + 1);
+    ros::Time start_time = getStamp(start);
+    ros::Time end_time = getStamp(start + rand() % (duration - start + 1));
+    // crop() requires the times to be contained in the messages
+    if (messages.front().header.stamp > start_time || messages.back().header.stamp < end_time)
+    {
+      continue;
+    }
+
+    std::vector<task_recorder2_msgs::DataSample> expected_messages = messages;
+    ASSERT_TRUE(crop(expected_messages, start_time, end_time));
+    ASSERT_TRUE(removeDuplicates(expected_messages));
+
+    std::vector<int> sample_indices;
+    ASSERT_TRUE(recording.getCroppedIndices(start_time, end_time, sample_indices));
+    ASSERT_EQ(expected_messages.size(), sample_indices.size());
+    for (int j = 0; j < (int)sample_indices.size(); ++j)
+    {
+      EXPECT_EQ(expected_messages[j].data[0], recording.getData(sample_indices[j])[0]);
+      EXPECT_TRUE(expected_messages[j].header.stamp == recording.getStamp(sample_indices[j]));
+    }
+    num_compared++;
+  }
+  // the random times are before the first stamp only for some recordings
+  EXPECT_GT(num_compared, NUM_RECORDINGS / 2);
+}
+
+TEST(data_sample_recording_test, rejectsTimesAfterRecording)
+{
+  srand(2);
+  DataSampleRecording recording;
+  std::vector<task_recorder2_msgs::DataSample> messages;
+  record(recording, messages);
+  ros::Time after_recording = messages.back().header.stamp + ros::Duration(1.0);
+  std::vector<int> sample_indices;
+  EXPECT_FALSE(recording.getCroppedIndices(after_recording, after_recording + ros::Duration(1.0), sample_indices));
+  EXPECT_TRUE(sample_indices.empty());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
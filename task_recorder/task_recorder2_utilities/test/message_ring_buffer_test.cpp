@@ -0,0 +1,195 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		Checks wraparound, overflow and concurrent reads of the
+            message ring buffer.
+
+  \file		message_ring_buffer_test.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <cmath>
+#include <sstream>
+#include <gtest/gtest.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <ros/atomic.h>
+
+// local includes
+#include <task_recorder2_utilities/message_ring_buffer.h>
+
+using namespace task_recorder2_utilities;
+
+static const int NUM_SIGNALS = 50;
+
+/*! Sample k is stamped k milliseconds after one second and all its signals are set to k
+ */
+static ros::Time getStamp(const int k)
+{
+  ros::Time stamp;
+  stamp.fromNSec(1000000000ull + static_cast<uint64_t> (k) * 1000000ull);
+  return stamp;
+}
+
+static task_recorder2_msgs::DataSample getDefaultDataSample()
+{
+  task_recorder2_msgs::DataSample data_sample;
+  for (int i = 0; i < NUM_SIGNALS; ++i)
+  {
+    std::stringstream ss;
+    ss << "signal_" << i;
+    data_sample.names.push_back(ss.str());
+  }
+  data_sample.data.resize(NUM_SIGNALS, 0.0);
+  return data_sample;
+}
+
+static task_recorder2_msgs::DataSample getDataSample(const int k)
+{
+  task_recorder2_msgs::DataSample data_sample;
+  data_sample.header.stamp = getStamp(k);
+  data_sample.data.resize(NUM_SIGNALS, static_cast<double> (k));
+  return data_sample;
+}
+
+TEST(MessageRingBuffer, wraparound)
+{
+  const int RING_BUFFER_SIZE = 5;
+  const int NUM_SAMPLES = 12;
+  MessageRingBuffer ring_buffer(getDefaultDataSample(), RING_BUFFER_SIZE);
+  for (int k = 0; k < NUM_SAMPLES; ++k)
+  {
+    EXPECT_TRUE(ring_buffer.add(getDataSample(k)));
+  }
+
+  // the slot that is overwritten next (sample 7) is not searched anymore, samples 8 to 11 are
+  task_recorder2_msgs::DataSample data_sample;
+  for (int k = NUM_SAMPLES - RING_BUFFER_SIZE + 1; k < NUM_SAMPLES; ++k)
+  {
+    ASSERT_TRUE(ring_buffer.get(getStamp(k), data_sample));
+    EXPECT_EQ(getStamp(k), data_sample.header.stamp);
+    EXPECT_EQ(NUM_SIGNALS, (int)data_sample.data.size());
+    EXPECT_EQ(NUM_SIGNALS, (int)data_sample.names.size());
+    EXPECT_DOUBLE_EQ(static_cast<double> (k), data_sample.data[NUM_SIGNALS - 1]);
+  }
+  EXPECT_FALSE(ring_buffer.get(getStamp(NUM_SAMPLES - RING_BUFFER_SIZE), data_sample));
+  EXPECT_FALSE(ring_buffer.get(getStamp(0), data_sample));
+
+  // in between two samples across the wraparound (slot 4 and slot 0)
+  ros::Time time = getStamp(9) + ros::Duration(0.0005);
+  ASSERT_TRUE(ring_buffer.get(time, data_sample));
+  EXPECT_EQ(getStamp(9), data_sample.header.stamp);
+  EXPECT_DOUBLE_EQ(9.0, data_sample.data[0]);
+  ASSERT_TRUE(ring_buffer.get(time, data_sample, true));
+  EXPECT_EQ(time, data_sample.header.stamp);
+  EXPECT_NEAR(9.5, data_sample.data[0], 1e-6);
+
+  // newer than all samples returns the most recent one
+  ASSERT_TRUE(ring_buffer.get(getStamp(NUM_SAMPLES + 10), data_sample, true));
+  EXPECT_EQ(getStamp(NUM_SAMPLES - 1), data_sample.header.stamp);
+}
+
+TEST(MessageRingBuffer, overflow)
+{
+  const int RING_BUFFER_SIZE = 3;
+  const int NUM_SAMPLES = 1000;
+  MessageRingBuffer ring_buffer(getDefaultDataSample(), RING_BUFFER_SIZE);
+  task_recorder2_msgs::DataSample data_sample;
+  EXPECT_FALSE(ring_buffer.get(getStamp(0), data_sample));
+
+  for (int k = 0; k < NUM_SAMPLES; ++k)
+  {
+    ASSERT_TRUE(ring_buffer.add(getDataSample(k)));
+    // samples that are (about to be) overwritten must never be returned
+    if (k >= RING_BUFFER_SIZE)
+    {
+      EXPECT_FALSE(ring_buffer.get(getStamp(k - RING_BUFFER_SIZE + 1), data_sample));
+    }
+    ASSERT_TRUE(ring_buffer.get(getStamp(k), data_sample));
+    EXPECT_DOUBLE_EQ(static_cast<double> (k), data_sample.data[0]);
+  }
+
+  // out of order samples are dropped, samples of the wrong size are rejected
+  EXPECT_TRUE(ring_buffer.add(getDataSample(NUM_SAMPLES - 2)));
+  ASSERT_TRUE(ring_buffer.get(getStamp(NUM_SAMPLES + 1), data_sample));
+  EXPECT_EQ(getStamp(NUM_SAMPLES - 1), data_sample.header.stamp);
+  task_recorder2_msgs::DataSample wrong_size = getDataSample(NUM_SAMPLES);
+  wrong_size.data.push_back(0.0);
+  EXPECT_FALSE(ring_buffer.add(wrong_size));
+}
+
+static void readRingBuffer(MessageRingBuffer& ring_buffer, const int num_samples, ros::atomic<bool>& done,
+                           ros::atomic<int>& num_reads, ros::atomic<bool>& failed)
+{
+  task_recorder2_msgs::DataSample data_sample;
+  int k = 0;
+  int num_successful_reads = 0;
+  // keep reading until the writer is done, but read at least once in case the writer finished first
+  while (!failed.load() && (!done.load() || num_successful_reads == 0))
+  {
+    k = done.load() ? num_samples - 1 : (k + 7919) % num_samples;
+    const bool interpolate = (k % 2 == 0);
+    ros::Time time = getStamp(k) + ros::Duration(0.0005);
+    if (!ring_buffer.get(time, data_sample, interpolate))
+    {
+      continue;
+    }
+    num_successful_reads++;
+    num_reads.fetch_add(1);
+
+    // a torn read would mix signals of different samples or the stamp of one with the data of another
+    double expected = (data_sample.header.stamp - getStamp(0)).toSec() * 1000.0;
+    if (data_sample.header.stamp > time || fabs(data_sample.data[0] - expected) > 1e-6)
+    {
+      failed.store(true);
+    }
+    for (int i = 1; i < (int)data_sample.data.size(); ++i)
+    {
+      if (data_sample.data[i] != data_sample.data[0])
+      {
+        failed.store(true);
+      }
+    }
+  }
+}
+
+TEST(MessageRingBuffer, concurrentReads)
+{
+  const int RING_BUFFER_SIZE = 4;
+  const int NUM_SAMPLES = 1000000;
+  const int NUM_READERS = 4;
+  MessageRingBuffer ring_buffer(getDefaultDataSample(), RING_BUFFER_SIZE);
+  ros::atomic<bool> done(false);
+  ros::atomic<bool> failed(false);
+  ros::atomic<int> num_reads(0);
+
+  boost::thread_group readers;
+  for (int i = 0; i < NUM_READERS; ++i)
+  {
+    readers.create_thread(boost::bind(readRingBuffer, boost::ref(ring_buffer), NUM_SAMPLES, boost::ref(done),
+                                      boost::ref(num_reads), boost::ref(failed)));
+  }
+  bool added = true;
+  for (int k = 0; k < NUM_SAMPLES && added && !failed.load(); ++k)
+  {
+    added = ring_buffer.add(getDataSample(k));
+  }
+  done.store(true);
+  readers.join_all();
+
+  EXPECT_TRUE(added);
+  EXPECT_FALSE(failed.load());
+  EXPECT_GT(num_reads.load(), 0);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -18,6 +18,7 @@
 // system includes
 #include <vector>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <Eigen/Eigen>
 
@@ -70,11 +71,19 @@ public:
   bool initialize(const std::string& start_link,
                   const std::string& end_link);
 
-  /*!
+  /*! Initializes the solvers for the given chain, e.g. one that is not described by robot_info
+   * @param chain
+   * @return True on success, otherwise False
+   */
+  bool initialize(const KDL::Chain& chain);
+
+  /*! Computes the joint angles for the pose trajectory as fast as possible, nothing is published.
+   * Use visualize() to look at the result.
    * @param poses
    * @param rest_postures
    * @param joint_angle_seed
-   * @param joint_angles
+   * @param joint_angles contains one entry per pose, the first one being the seed. Poses with the same time stamp as
+   * the previous one get the joint angles of the previous one.
    * @return True on success, otherwise False
    */
   bool ik(const std::vector<geometry_msgs::PoseStamped>& poses,
@@ -82,6 +91,32 @@ public:
           const Eigen::VectorXd& joint_angle_seed,
           std::vector<Eigen::VectorXd>& joint_angles);
 
+  /*! Computes the joint angles for several pose trajectories, each thread uses its own KDL solvers.
+   * @param poses
+   * @param rest_postures
+   * @param joint_angle_seeds
+   * @param joint_angles
+   * @param num_threads if not positive, one thread per hardware thread is used
+   * @return True on success, otherwise False
+   */
+  bool ik(const std::vector<std::vector<geometry_msgs::PoseStamped> >& poses,
+          const std::vector<std::vector<Eigen::VectorXd> >& rest_postures,
+          const std::vector<Eigen::VectorXd>& joint_angle_seeds,
+          std::vector<std::vector<Eigen::VectorXd> >& joint_angles,
+          const int num_threads = 0);
+
+  /*! Publishes the target poses and the robot for every decimation-th solution computed by ik()
+   * @param poses
+   * @param joint_angles
+   * @param decimation
+   * @param real_time if set, the poses are published with the timing of their time stamps
+   * @return True on success, otherwise False
+   */
+  bool visualize(const std::vector<geometry_msgs::PoseStamped>& poses,
+                 const std::vector<Eigen::VectorXd>& joint_angles,
+                 const int decimation = 1,
+                 const bool real_time = false);
+
   /*!
    * @return
    */
@@ -119,42 +154,71 @@ private:
   visualization_utilities::RobotPoseVisualizer robot_visualizer_;
   ros::Publisher target_pose_visualizer_;
 
-  // used in computeIkWithNullspaceOptimization
-  boost::scoped_ptr<KDL::ChainFkSolverVel> jnt_to_twist_solver_;
-  boost::scoped_ptr<KDL::ChainFkSolverPos> jnt_to_pose_solver_;
-  boost::scoped_ptr<KDL::ChainJntToJacSolver> jnt_to_jac_solver_;
+  /*! KDL solvers and buffers used in computeIk, these are not shared among threads
+   */
+  struct Solver
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
-  KDL::JntArray kdl_current_joint_positions_;
-  KDL::JntArray kdl_previous_joint_positions_;
+    Solver(const KDL::Chain& chain);
 
-  KDL::Jacobian kdl_chain_jacobian_;
+    boost::scoped_ptr<KDL::ChainFkSolverPos> jnt_to_pose_solver_;
+    boost::scoped_ptr<KDL::ChainJntToJacSolver> jnt_to_jac_solver_;
 
-  KDL::Frame kdl_desired_pose_;
-  KDL::Frame kdl_previous_pose_;
+    KDL::JntArray kdl_current_joint_positions_;
+    KDL::Jacobian kdl_chain_jacobian_;
 
-  KDL::Twist kdl_twist_error_;
-  KDL::Twist kdl_twist_desired_;
+    KDL::Frame kdl_desired_pose_;
+    KDL::Frame kdl_current_pose_;
+    KDL::Twist kdl_twist_desired_;
 
-  Eigen::VectorXd eigen_nullspace_error_;
-  Eigen::VectorXd eigen_nullspace_term_;
-  Eigen::MatrixXd eigen_nullspace_projector_;
+    Eigen::VectorXd eigen_nullspace_error_;
+    Eigen::VectorXd eigen_nullspace_term_;
+    Eigen::MatrixXd eigen_nullspace_projector_;
 
-  Eigen::MatrixXd eigen_chain_jacobian_;
-  Eigen::MatrixXd eigen_jac_times_jac_transpose_;
-  Eigen::MatrixXd eigen_jjt_inverse_;
-  Eigen::MatrixXd eigen_jac_pseudo_inverse_;
-  Eigen::MatrixXd eigen_identity_;
+    Eigen::MatrixXd eigen_chain_jacobian_;
+    Eigen::MatrixXd eigen_jac_times_jac_transpose_;
+    Eigen::MatrixXd eigen_jjt_inverse_;
+    Eigen::MatrixXd eigen_jac_pseudo_inverse_;
+    Eigen::MatrixXd eigen_identity_;
+    Eigen::MatrixXd eigen_damping_;
 
-  Eigen::VectorXd eigen_desired_cartesian_velocities_;
-  Eigen::VectorXd eigen_desired_joint_positions_;
-  Eigen::VectorXd eigen_desired_joint_velocities_;
+    Eigen::VectorXd eigen_desired_cartesian_velocities_;
+    Eigen::VectorXd eigen_desired_joint_velocities_;
+  };
+  std::vector<boost::shared_ptr<Solver> > solvers_;
+
+  /*!
+   * @param poses
+   * @param rest_postures
+   * @param joint_angle_seed
+   * @return True if inputs are valid, otherwise False
+   */
+  bool checkInputs(const std::vector<geometry_msgs::PoseStamped>& poses,
+                   const std::vector<Eigen::VectorXd>& rest_postures,
+                   const Eigen::VectorXd& joint_angle_seed) const;
 
-  // debugging...
-  boost::scoped_ptr<KDL::ChainIkSolverPos_NR_JL> ik_pos_solver_;
-  boost::scoped_ptr<KDL::ChainFkSolverPos> fk_pos_solver_;
-  boost::scoped_ptr<KDL::ChainIkSolverVel> ik_vel_solver_;
-  KDL::JntArray seed_;
-  KDL::JntArray solution_;
+  /*! Integrates the nullspace optimized joint velocities along the pose trajectory (inputs need to be checked)
+   * @param solver
+   * @param poses
+   * @param rest_postures
+   * @param joint_angle_seed
+   * @param joint_angles
+   */
+  void computeIk(Solver& solver,
+                 const std::vector<geometry_msgs::PoseStamped>& poses,
+                 const std::vector<Eigen::VectorXd>& rest_postures,
+                 const Eigen::VectorXd& joint_angle_seed,
+                 std::vector<Eigen::VectorXd>& joint_angles) const;
+
+  /*! Worker for the batch ik, processes every num_workers-th trajectory starting at worker
+   */
+  void ikWorker(const int worker,
+                const int num_workers,
+                const std::vector<std::vector<geometry_msgs::PoseStamped> >* poses,
+                const std::vector<std::vector<Eigen::VectorXd> >* rest_postures,
+                const std::vector<Eigen::VectorXd>* joint_angle_seeds,
+                std::vector<std::vector<Eigen::VectorXd> >* joint_angles);
 
 };
 
@@ -13,6 +13,9 @@
  *********************************************************************/
 
 // system includes
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 #include <geometry_msgs/Pose.h>
 #include <tf_conversions/tf_kdl.h>
 
@@ -59,9 +62,8 @@ bool InverseKinematicsWithNullspaceOptimization::initialize(const std::string& s
   //  }
   //  num_joints_ = joint_infos.size();
 
-  RobotInfo::getKDLChain(start_link, end_link, chain_);
-
-  num_joints_ = chain_.getNrOfJoints();
+  KDL::Chain chain;
+  RobotInfo::getKDLChain(start_link, end_link, chain);
 
   start_link_name_.assign(start_link);
   usc_utilities::appendLeadingSlash(start_link_name_);
@@ -69,45 +71,51 @@ bool InverseKinematicsWithNullspaceOptimization::initialize(const std::string& s
   usc_utilities::appendLeadingSlash(end_link_name_);
   usc_utilities::appendLeadingSlash(base_link_name_);
 
+  return initialize(chain);
+}
+
+bool InverseKinematicsWithNullspaceOptimization::initialize(const KDL::Chain& chain)
+{
+  chain_ = chain;
+  num_joints_ = chain_.getNrOfJoints();
+
   target_pose_visualizer_ = node_handle_.advertise<geometry_msgs::PoseStamped>("/inverse_kinematics/ik_null_debug_target", 100, true);
 
-  eigen_desired_cartesian_velocities_ = VectorXd::Zero(6, 1);
-  eigen_desired_joint_positions_ = VectorXd::Zero(num_joints_, 1);
-  eigen_desired_joint_velocities_ = VectorXd::Zero(num_joints_, 1);
+  solvers_.assign(1, boost::shared_ptr<Solver>(new Solver(chain_)));
 
-  eigen_jac_times_jac_transpose_ = MatrixXd::Zero(6, 6);
-  eigen_jjt_inverse_ = MatrixXd::Zero(6, 6);
-  eigen_jac_pseudo_inverse_ = MatrixXd::Zero(6, num_joints_);
-  eigen_identity_ = MatrixXd::Zero(num_joints_, num_joints_);
-  eigen_identity_.setIdentity(num_joints_, num_joints_);
+  return (initialized_ = true);
+}
 
-  eigen_nullspace_error_ = VectorXd::Zero(num_joints_, 1);
-  eigen_nullspace_term_ = VectorXd::Zero(num_joints_, 1);
-  eigen_nullspace_projector_ = MatrixXd::Zero(num_joints_, num_joints_);
+InverseKinematicsWithNullspaceOptimization::Solver::Solver(const KDL::Chain& chain)
+{
+  const int num_joints = chain.getNrOfJoints();
 
-  jnt_to_twist_solver_.reset(new KDL::ChainFkSolverVel_recursive(chain_));
+  jnt_to_pose_solver_.reset(new KDL::ChainFkSolverPos_recursive(chain));
+  jnt_to_jac_solver_.reset(new KDL::ChainJntToJacSolver(chain));
 
-  jnt_to_jac_solver_.reset(new KDL::ChainJntToJacSolver(chain_));
-  kdl_chain_jacobian_.resize(num_joints_);
+  kdl_current_joint_positions_.resize(num_joints);
+  kdl_chain_jacobian_.resize(num_joints);
 
-  jnt_to_pose_solver_.reset(new KDL::ChainFkSolverPos_recursive(chain_));
+  eigen_nullspace_error_ = VectorXd::Zero(num_joints, 1);
+  eigen_nullspace_term_ = VectorXd::Zero(num_joints, 1);
+  eigen_nullspace_projector_ = MatrixXd::Zero(num_joints, num_joints);
 
-  kdl_current_joint_positions_.resize(num_joints_);
-  kdl_previous_joint_positions_.resize(num_joints_);
+  eigen_chain_jacobian_ = MatrixXd::Zero(6, num_joints);
+  eigen_jac_times_jac_transpose_ = MatrixXd::Zero(6, 6);
+  eigen_jjt_inverse_ = MatrixXd::Zero(6, 6);
+  eigen_jac_pseudo_inverse_ = MatrixXd::Zero(num_joints, 6);
+  eigen_identity_ = MatrixXd::Identity(num_joints, num_joints);
+  const double damping = 1.0;
+  eigen_damping_ = MatrixXd::Identity(6, 6) * damping;
 
-  return (initialized_ = true);
+  eigen_desired_cartesian_velocities_ = VectorXd::Zero(6, 1);
+  eigen_desired_joint_velocities_ = VectorXd::Zero(num_joints, 1);
 }
 
-bool InverseKinematicsWithNullspaceOptimization::ik(const std::vector<geometry_msgs::PoseStamped>& poses,
-                                                    const std::vector<VectorXd>& rest_postures,
-                                                    const VectorXd& joint_angle_seed,
-                                                    std::vector<VectorXd>& joint_angles)
+bool InverseKinematicsWithNullspaceOptimization::checkInputs(const std::vector<geometry_msgs::PoseStamped>& poses,
+                                                             const std::vector<VectorXd>& rest_postures,
+                                                             const VectorXd& joint_angle_seed) const
 {
-  ROS_ASSERT(initialized_);
-  joint_angles.clear();
-
-  // const double delta_t = (double) 1.0 / pr2_controller_utilities::PR2RobotInfo::PR2_DEFAULT_SAMPLING_FREQUENCY;
-
   if(poses.empty())
   {
     ROS_ERROR("There are no poses, cannot compute inverse kinematics.");
@@ -126,94 +134,211 @@ bool InverseKinematicsWithNullspaceOptimization::ik(const std::vector<geometry_m
       return false;
     }
   }
-
+  for(int i=1; i<(int)poses.size(); ++i)
+  {
+    if(poses[i].header.stamp < poses[i-1].header.stamp)
+    {
+      ROS_ERROR("Time stamp of pose >%i< is >%f< and therefore before the previous one >%f<.",
+                i, poses[i].header.stamp.toSec(), poses[i-1].header.stamp.toSec());
+      return false;
+    }
+  }
   if(joint_angle_seed.size() != num_joints_)
   {
     ROS_ERROR("Joint angle seed contains >%i< values and therefore is invalid.", (int)joint_angle_seed.size());
     return false;
   }
-  kdl_previous_joint_positions_.data = joint_angle_seed;
-  ros::Time previous_time_stamp = poses[0].header.stamp;
-  ros::Time start_time_stamp = ros::Time::now();
+  return true;
+}
+
+void InverseKinematicsWithNullspaceOptimization::computeIk(Solver& solver,
+                                                           const std::vector<geometry_msgs::PoseStamped>& poses,
+                                                           const std::vector<VectorXd>& rest_postures,
+                                                           const VectorXd& joint_angle_seed,
+                                                           std::vector<VectorXd>& joint_angles) const
+{
+  joint_angles.resize(poses.size());
+  solver.kdl_current_joint_positions_.data = joint_angle_seed;
+  joint_angles[0] = joint_angle_seed;
 
-  timer_.startTimer();
   for (int i = 1; i < (int)poses.size(); ++i)
-  // for (int i = 1; i < 2; ++i)
   {
-    ros::Time current_time_stamp = poses[i].header.stamp;
-    double delta_t = ros::Duration(current_time_stamp - previous_time_stamp).toSec();
-    previous_time_stamp = current_time_stamp;
-
-    ROS_DEBUG("Setting delta_t to >%f<.", delta_t);
-
-    tf::PoseMsgToKDL(poses[i].pose, kdl_desired_pose_);
-
-    geometry_msgs::PoseStamped pose_stamped;
-    pose_stamped.pose = poses[i].pose;
-    // pose_stamped.header.frame_id = poses[i].header.frame_id;
-    pose_stamped.header.frame_id = start_link_name_;
-    pose_stamped.header.stamp = start_time_stamp;
-    target_pose_visualizer_.publish(pose_stamped);
+    double delta_t = ros::Duration(poses[i].header.stamp - poses[i-1].header.stamp).toSec();
+    if (delta_t <= 0.0)
+    {
+      // nothing to integrate over, keep the previous joint angles
+      joint_angles[i] = solver.kdl_current_joint_positions_.data;
+      continue;
+    }
+    tf::PoseMsgToKDL(poses[i].pose, solver.kdl_desired_pose_);
 
     // get the chain jacobian
-    jnt_to_jac_solver_->JntToJac(kdl_previous_joint_positions_, kdl_chain_jacobian_);
-
-		// ROS_INFO_STREAM(kdl_chain_jacobian_.data);
+    solver.jnt_to_jac_solver_->JntToJac(solver.kdl_current_joint_positions_, solver.kdl_chain_jacobian_);
 
     // convert to (plain) eigen for easier math
-    eigen_chain_jacobian_ = kdl_chain_jacobian_.data;
+    solver.eigen_chain_jacobian_ = solver.kdl_chain_jacobian_.data;
 
     // compute the pseudo inverse
-    double damping = 1.0;
-    eigen_jac_times_jac_transpose_ = eigen_chain_jacobian_ * eigen_chain_jacobian_.transpose() + MatrixXd::Identity(6, 6) * damping;
-    eigen_jac_times_jac_transpose_.computeInverse(&eigen_jjt_inverse_);
+    solver.eigen_jac_times_jac_transpose_ = solver.eigen_chain_jacobian_ * solver.eigen_chain_jacobian_.transpose() + solver.eigen_damping_;
+    solver.eigen_jac_times_jac_transpose_.computeInverse(&solver.eigen_jjt_inverse_);
 
-    eigen_jac_pseudo_inverse_ = eigen_chain_jacobian_.transpose() * eigen_jjt_inverse_;
+    solver.eigen_jac_pseudo_inverse_ = solver.eigen_chain_jacobian_.transpose() * solver.eigen_jjt_inverse_;
 
     // compute the nullspace projector
-    eigen_identity_.setIdentity();
-    eigen_nullspace_projector_ = eigen_identity_ - (eigen_jac_pseudo_inverse_ * eigen_chain_jacobian_);
+    solver.eigen_nullspace_projector_ = solver.eigen_identity_ - (solver.eigen_jac_pseudo_inverse_ * solver.eigen_chain_jacobian_);
 
     // get cartesian pose
-    jnt_to_pose_solver_->JntToCart(kdl_previous_joint_positions_, kdl_previous_pose_);
+    solver.jnt_to_pose_solver_->JntToCart(solver.kdl_current_joint_positions_, solver.kdl_current_pose_);
 
     // compute twist
-    kdl_twist_desired_ = -diff(kdl_desired_pose_, kdl_previous_pose_, delta_t).RefPoint(kdl_previous_pose_.p - kdl_desired_pose_.p);
+    solver.kdl_twist_desired_ = -diff(solver.kdl_desired_pose_, solver.kdl_current_pose_, delta_t).RefPoint(solver.kdl_current_pose_.p - solver.kdl_desired_pose_.p);
 
     // compute desired cartesian velocities
     for (int j = 0; j < 6; j++)
     {
-      eigen_desired_cartesian_velocities_(j) = kdl_twist_desired_(j);
+      solver.eigen_desired_cartesian_velocities_(j) = solver.kdl_twist_desired_(j);
     }
 
     // compute desired joint velocities
-    eigen_desired_joint_velocities_ = eigen_jac_pseudo_inverse_ * eigen_desired_cartesian_velocities_;
+    solver.eigen_desired_joint_velocities_ = solver.eigen_jac_pseudo_inverse_ * solver.eigen_desired_cartesian_velocities_;
 
     double gain = 5.0;
     for (int j = 0; j < num_joints_; j++)
     {
-      eigen_nullspace_error_(j) = (rest_postures[i](j) - kdl_current_joint_positions_(j)) * gain;
+      solver.eigen_nullspace_error_(j) = (rest_postures[i](j) - solver.kdl_current_joint_positions_(j)) * gain;
     }
-    eigen_nullspace_term_ = eigen_nullspace_projector_ * eigen_nullspace_error_;
-    eigen_desired_joint_velocities_ += eigen_nullspace_term_;
+    solver.eigen_nullspace_term_ = solver.eigen_nullspace_projector_ * solver.eigen_nullspace_error_;
+    solver.eigen_desired_joint_velocities_ += solver.eigen_nullspace_term_;
 
     // integrate desired joint velocities to get desired joint positions
-    eigen_desired_joint_positions_ = eigen_desired_joint_positions_ + eigen_desired_joint_velocities_ * delta_t;
+    solver.kdl_current_joint_positions_.data += solver.eigen_desired_joint_velocities_ * delta_t;
+    joint_angles[i] = solver.kdl_current_joint_positions_.data;
+  }
+}
+
+bool InverseKinematicsWithNullspaceOptimization::ik(const std::vector<geometry_msgs::PoseStamped>& poses,
+                                                    const std::vector<VectorXd>& rest_postures,
+                                                    const VectorXd& joint_angle_seed,
+                                                    std::vector<VectorXd>& joint_angles)
+{
+  ROS_ASSERT(initialized_);
+  joint_angles.clear();
+  if(!checkInputs(poses, rest_postures, joint_angle_seed))
+  {
+    return false;
+  }
+
+  timer_.startTimer();
+  computeIk(*solvers_[0], poses, rest_postures, joint_angle_seed, joint_angles);
+  ROS_DEBUG("IK solution for >%i< poses took %f ms.", (int)poses.size(), timer_.getElapsedTimeMilliSeconds());
+  return true;
+}
 
-    // set current joint positions to desired
-    kdl_current_joint_positions_.data = eigen_desired_joint_positions_;
+void InverseKinematicsWithNullspaceOptimization::ikWorker(const int worker,
+                                                          const int num_workers,
+                                                          const std::vector<std::vector<geometry_msgs::PoseStamped> >* poses,
+                                                          const std::vector<std::vector<VectorXd> >* rest_postures,
+                                                          const std::vector<VectorXd>* joint_angle_seeds,
+                                                          std::vector<std::vector<VectorXd> >* joint_angles)
+{
+  for (int i = worker; i < (int)poses->size(); i += num_workers)
+  {
+    computeIk(*solvers_[worker], (*poses)[i], (*rest_postures)[i], (*joint_angle_seeds)[i], (*joint_angles)[i]);
+  }
+}
 
-    // update the previous state for next iteration
-    kdl_previous_joint_positions_ = kdl_current_joint_positions_;
+bool InverseKinematicsWithNullspaceOptimization::ik(const std::vector<std::vector<geometry_msgs::PoseStamped> >& poses,
+                                                    const std::vector<std::vector<VectorXd> >& rest_postures,
+                                                    const std::vector<VectorXd>& joint_angle_seeds,
+                                                    std::vector<std::vector<VectorXd> >& joint_angles,
+                                                    const int num_threads)
+{
+  ROS_ASSERT(initialized_);
+  joint_angles.clear();
+  if(poses.size() != rest_postures.size() || poses.size() != joint_angle_seeds.size())
+  {
+    ROS_ERROR("Number of pose trajectories >%i<, rest posture trajectories >%i<, and joint angle seeds >%i< must be equal.",
+              (int)poses.size(), (int)rest_postures.size(), (int)joint_angle_seeds.size());
+    return false;
+  }
+  for (int i = 0; i < (int)poses.size(); ++i)
+  {
+    if(!checkInputs(poses[i], rest_postures[i], joint_angle_seeds[i]))
+    {
+      ROS_ERROR("Pose trajectory >%i< is invalid, cannot compute inverse kinematics.", i);
+      return false;
+    }
+  }
+  joint_angles.resize(poses.size());
 
-    // robot_visualizer_.publishPose(robot_part_name_, base_link_name_, kdl_current_joint_positions_);
-    robot_visualizer_.publishPose(robot_part_name_, first_link_name_, kdl_current_joint_positions_);
-    ros::Duration(delta_t).sleep();
+  int num_workers = num_threads;
+  if(num_workers <= 0)
+  {
+    num_workers = std::max((int)boost::thread::hardware_concurrency(), 1);
+  }
+  num_workers = std::max(std::min(num_workers, (int)poses.size()), 1);
+  while((int)solvers_.size() < num_workers)
+  {
+    solvers_.push_back(boost::shared_ptr<Solver>(new Solver(chain_)));
   }
-  ROS_INFO("IK solution took %f ms.", timer_.getElapsedTimeMilliSeconds());
 
+  timer_.startTimer();
+  boost::thread_group workers;
+  for (int i = 1; i < num_workers; ++i)
+  {
+    workers.create_thread(boost::bind(&InverseKinematicsWithNullspaceOptimization::ikWorker, this, i, num_workers,
+                                      &poses, &rest_postures, &joint_angle_seeds, &joint_angles));
+  }
+  ikWorker(0, num_workers, &poses, &rest_postures, &joint_angle_seeds, &joint_angles);
+  workers.join_all();
+  ROS_DEBUG("IK solution for >%i< pose trajectories on >%i< threads took %f ms.",
+            (int)poses.size(), num_workers, timer_.getElapsedTimeMilliSeconds());
   return true;
 }
 
+bool InverseKinematicsWithNullspaceOptimization::visualize(const std::vector<geometry_msgs::PoseStamped>& poses,
+                                                           const std::vector<VectorXd>& joint_angles,
+                                                           const int decimation,
+                                                           const bool real_time)
+{
+  ROS_ASSERT(initialized_);
+  if(poses.size() != joint_angles.size())
+  {
+    ROS_ERROR("Number of poses >%i< must equal number of joint angles >%i<.", (int)poses.size(), (int)joint_angles.size());
+    return false;
+  }
+  if(decimation < 1)
+  {
+    ROS_ERROR("Decimation >%i< is invalid, it needs to be at least 1.", decimation);
+    return false;
+  }
+
+  KDL::JntArray kdl_joint_positions(num_joints_);
+  ros::Time start_time_stamp = ros::Time::now();
+  for (int i = 0; i < (int)poses.size(); i += decimation)
+  {
+    // always show the final pose
+    if(i + decimation >= (int)poses.size())
+    {
+      i = (int)poses.size() - 1;
+    }
+
+    geometry_msgs::PoseStamped pose_stamped;
+    pose_stamped.pose = poses[i].pose;
+    pose_stamped.header.frame_id = start_link_name_;
+    pose_stamped.header.stamp = start_time_stamp;
+    target_pose_visualizer_.publish(pose_stamped);
+
+    kdl_joint_positions.data = joint_angles[i];
+    robot_visualizer_.publishPose(robot_part_name_, first_link_name_, kdl_joint_positions);
+
+    if(real_time && i + 1 < (int)poses.size())
+    {
+      int next = std::min(i + decimation, (int)poses.size() - 1);
+      ros::Duration(poses[next].header.stamp - poses[i].header.stamp).sleep();
+    }
+  }
+  return true;
 }
 
+}
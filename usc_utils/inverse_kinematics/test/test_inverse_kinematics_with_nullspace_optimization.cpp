@@ -0,0 +1,152 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		Checks that the batch ik matches the serial one on a
+            small KDL chain.
+
+  \file		test_inverse_kinematics_with_nullspace_optimization.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <cmath>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <kdl/chain.hpp>
+#include <kdl/chainfksolverpos_recursive.hpp>
+#include <tf_conversions/tf_kdl.h>
+
+// local includes
+#include <inverse_kinematics/inverse_kinematics_with_nullspace_optimization.h>
+
+using namespace inverse_kinematics;
+
+static const int NUM_JOINTS = 6;
+static const int NUM_POSES = 100;
+static const double DELTA_T = 0.01;
+
+static KDL::Chain getChain()
+{
+  KDL::Chain chain;
+  chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame(KDL::Vector(0.0, 0.0, 0.3))));
+  chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotY), KDL::Frame(KDL::Vector(0.0, 0.0, 0.4))));
+  chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotY), KDL::Frame(KDL::Vector(0.0, 0.0, 0.3))));
+  chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotX), KDL::Frame(KDL::Vector(0.1, 0.0, 0.0))));
+  chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotY), KDL::Frame(KDL::Vector(0.1, 0.0, 0.0))));
+  chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame(KDL::Vector(0.0, 0.0, 0.1))));
+  return chain;
+}
+
+/*! The poses of the end effector along a smooth joint trajectory, trajectory k starts at its own posture
+ */
+static void getPoses(const KDL::Chain& chain, const int k, std::vector<geometry_msgs::PoseStamped>& poses,
+                     std::vector<Eigen::VectorXd>& rest_postures, Eigen::VectorXd& joint_angle_seed)
+{
+  KDL::ChainFkSolverPos_recursive fk_solver(chain);
+  KDL::JntArray joint_positions(NUM_JOINTS);
+  KDL::Frame frame;
+  poses.resize(NUM_POSES);
+  rest_postures.assign(NUM_POSES, Eigen::VectorXd::Zero(NUM_JOINTS));
+  for (int i = 0; i < NUM_POSES; ++i)
+  {
+    for (int j = 0; j < NUM_JOINTS; ++j)
+    {
+      joint_positions(j) = 0.2 * k + 0.1 * j + 0.5 * sin(0.02 * (j + 1) * i);
+    }
+    if (i == 0)
+    {
+      joint_angle_seed = joint_positions.data;
+    }
+    fk_solver.JntToCart(joint_positions, frame);
+    tf::PoseKDLToMsg(frame, poses[i].pose);
+    poses[i].header.stamp = ros::Time(1.0 + i * DELTA_T);
+  }
+}
+
+TEST(InverseKinematicsWithNullspaceOptimization, batchMatchesSerial)
+{
+  const int NUM_TRAJECTORIES = 5;
+  const KDL::Chain chain = getChain();
+  InverseKinematicsWithNullspaceOptimization ik_solver("test_chain");
+  ASSERT_TRUE(ik_solver.initialize(chain));
+
+  std::vector<std::vector<geometry_msgs::PoseStamped> > poses(NUM_TRAJECTORIES);
+  std::vector<std::vector<Eigen::VectorXd> > rest_postures(NUM_TRAJECTORIES);
+  std::vector<Eigen::VectorXd> joint_angle_seeds(NUM_TRAJECTORIES);
+  for (int k = 0; k < NUM_TRAJECTORIES; ++k)
+  {
+    getPoses(chain, k, poses[k], rest_postures[k], joint_angle_seeds[k]);
+  }
+
+  std::vector<std::vector<Eigen::VectorXd> > serial_joint_angles(NUM_TRAJECTORIES);
+  for (int k = 0; k < NUM_TRAJECTORIES; ++k)
+  {
+    ASSERT_TRUE(ik_solver.ik(poses[k], rest_postures[k], joint_angle_seeds[k], serial_joint_angles[k]));
+    ASSERT_EQ(NUM_POSES, (int)serial_joint_angles[k].size());
+    EXPECT_TRUE(serial_joint_angles[k][0] == joint_angle_seeds[k]);
+  }
+
+  // more threads than trajectories are capped, each thread uses its own solvers
+  const int NUM_THREADS[] = {1, 3, 8};
+  for (int n = 0; n < (int)(sizeof(NUM_THREADS) / sizeof(int)); ++n)
+  {
+    std::vector<std::vector<Eigen::VectorXd> > joint_angles;
+    ASSERT_TRUE(ik_solver.ik(poses, rest_postures, joint_angle_seeds, joint_angles, NUM_THREADS[n]));
+    ASSERT_EQ(NUM_TRAJECTORIES, (int)joint_angles.size());
+    for (int k = 0; k < NUM_TRAJECTORIES; ++k)
+    {
+      ASSERT_EQ(NUM_POSES, (int)joint_angles[k].size());
+      EXPECT_TRUE(joint_angles[k][0] == joint_angle_seeds[k]);
+      for (int i = 0; i < NUM_POSES; ++i)
+      {
+        EXPECT_TRUE(joint_angles[k][i] == serial_joint_angles[k][i]) << "trajectory " << k << ", pose " << i
+            << ", threads " << NUM_THREADS[n];
+      }
+    }
+  }
+}
+
+TEST(InverseKinematicsWithNullspaceOptimization, timeStamps)
+{
+  const KDL::Chain chain = getChain();
+  InverseKinematicsWithNullspaceOptimization ik_solver("test_chain");
+  ASSERT_TRUE(ik_solver.initialize(chain));
+
+  std::vector<geometry_msgs::PoseStamped> poses;
+  std::vector<Eigen::VectorXd> rest_postures;
+  Eigen::VectorXd joint_angle_seed;
+  getPoses(chain, 0, poses, rest_postures, joint_angle_seed);
+
+  // a pose with the same time stamp as the previous one keeps its joint angles
+  const int DUPLICATE = NUM_POSES / 2;
+  poses[DUPLICATE].header.stamp = poses[DUPLICATE - 1].header.stamp;
+  std::vector<Eigen::VectorXd> joint_angles;
+  ASSERT_TRUE(ik_solver.ik(poses, rest_postures, joint_angle_seed, joint_angles));
+  ASSERT_EQ(NUM_POSES, (int)joint_angles.size());
+  EXPECT_TRUE(joint_angles[0] == joint_angle_seed);
+  EXPECT_TRUE(joint_angles[DUPLICATE] == joint_angles[DUPLICATE - 1]);
+  for (int i = 0; i < NUM_POSES; ++i)
+  {
+    for (int j = 0; j < NUM_JOINTS; ++j)
+    {
+      EXPECT_FALSE(std::isnan(joint_angles[i](j)));
+    }
+  }
+
+  // time stamps that go backwards are rejected
+  poses[DUPLICATE].header.stamp = poses[DUPLICATE - 1].header.stamp - ros::Duration(DELTA_T);
+  EXPECT_FALSE(ik_solver.ik(poses, rest_postures, joint_angle_seed, joint_angles));
+  EXPECT_TRUE(joint_angles.empty());
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "test_inverse_kinematics_with_nullspace_optimization");
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
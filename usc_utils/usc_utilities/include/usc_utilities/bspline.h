@@ -38,9 +38,12 @@
 
 // system includes
 #include <vector>
+#include <algorithm>
 
 // ros includes
 #include <bspline/BSpline.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 #include <sensor_msgs/JointState.h>
 
@@ -79,6 +82,28 @@ bool resample(const std::vector<double>& input_vector,
               bool compute_slope,
               bool verbose = false);
 
+/*! Resamples several variables that share the same input vector. The spline domain (nodes, basis and the
+ * factorization of the banded system) is set up once, afterwards each variable only requires a right-hand side
+ * and a back substitution. The variables are distributed over num_threads threads.
+ * @param input_vector (num_inputs)
+ * @param target_matrix Column major (num_inputs x num_variables), i.e. one contiguous column per variable
+ * @param num_variables
+ * @param cutoff_wave_length
+ * @param input_querry (num_outputs)
+ * @param output_matrix Column major (num_outputs x num_variables), will be resized
+ * @param compute_slope
+ * @param num_threads
+ * @return True on success, otherwise False
+ */
+bool resampleColumns(const std::vector<double>& input_vector,
+                     const std::vector<double>& target_matrix,
+                     const int num_variables,
+                     const double cutoff_wave_length,
+                     const std::vector<double>& input_querry,
+                     std::vector<double>& output_matrix,
+                     bool compute_slope,
+                     const int num_threads = 1);
+
 /**
  * Given input samples of input_y = f(input_x), calculates output_y = f(output_x) using linear interpolation
  * Assumes that input_x and output_x are sorted!
@@ -88,6 +113,16 @@ bool resampleLinearNoBounds(const std::vector<double>& input_x,
                             const std::vector<double>& output_x,
                             std::vector<double>& output_y);
 
+/**
+ * Same as resampleLinearNoBounds for several variables stored column major in input_y and output_y.
+ * The interpolation indices and weights are computed once for all variables.
+ */
+bool resampleLinearNoBoundsColumns(const std::vector<double>& input_x,
+                                   const std::vector<double>& input_y,
+                                   const int num_variables,
+                                   const std::vector<double>& output_x,
+                                   std::vector<double>& output_y);
+
 /**
  * Given input samples of input_y = f(input_x), calculates output_y = f(output_x) using linear interpolation
  * Assumes that input_x and output_x are sorted!
@@ -268,6 +303,143 @@ inline bool resample(const std::vector<double>& input_vector,
   return true;
 }
 
+/*! Shared state of the resampleColumns() workers
+ */
+struct ResampleColumnsJob
+{
+  BSplineBase<double>* b_spline_base;
+  const std::vector<int>* valid_rows;
+  const std::vector<double>* target_matrix;
+  int num_inputs;
+  int num_variables;
+  const std::vector<double>* input_querry;
+  std::vector<double>* output_matrix;
+  bool compute_slope;
+  int num_threads;
+  std::vector<int> worker_succeeded;
+};
+
+inline void resampleColumnsWorker(ResampleColumnsJob* job, const int worker)
+{
+  const int num_valid_rows = static_cast<int> (job->valid_rows->size());
+  const int num_outputs = static_cast<int> (job->input_querry->size());
+  std::vector<double> column_buffer;
+  if (num_valid_rows < job->num_inputs)
+  {
+    column_buffer.resize(num_valid_rows);
+  }
+
+  for (int v = worker; v < job->num_variables; v += job->num_threads)
+  {
+    const double* column = &((*job->target_matrix)[v * job->num_inputs]);
+    if (!column_buffer.empty())
+    {
+      for (int i = 0; i < num_valid_rows; ++i)
+      {
+        column_buffer[i] = column[(*job->valid_rows)[i]];
+      }
+      column = &(column_buffer[0]);
+    }
+
+    BSpline<double> b_spline(*job->b_spline_base, column);
+    if (!b_spline.ok())
+    {
+      ROS_ERROR("Could not create b-spline for variable >%i<.", v);
+      job->worker_succeeded[worker] = 0;
+      continue;
+    }
+
+    double* output = &((*job->output_matrix)[v * num_outputs]);
+    for (int s = 0; s < num_outputs; ++s)
+    {
+      if (job->compute_slope)
+      {
+        output[s] = b_spline.slope((*job->input_querry)[s]);
+      }
+      else
+      {
+        output[s] = b_spline.evaluate((*job->input_querry)[s]);
+      }
+    }
+  }
+}
+
+inline bool resampleColumns(const std::vector<double>& input_vector,
+                            const std::vector<double>& target_matrix,
+                            const int num_variables,
+                            const double cutoff_wave_length,
+                            const std::vector<double>& input_querry,
+                            std::vector<double>& output_matrix,
+                            bool compute_slope,
+                            const int num_threads)
+{
+  ROS_ASSERT_MSG(!input_vector.empty(), "Input vector is empty. Cannot resample trajecoty using a bspline.");
+  ROS_ASSERT_MSG(!input_querry.empty(), "Input querry is empty. Cannot resample trajecoty using a bspline.");
+  ROS_VERIFY(num_variables > 0);
+  ROS_VERIFY(target_matrix.size() == input_vector.size() * num_variables);
+
+  const int num_inputs = static_cast<int> (input_vector.size());
+
+  // invalid data points are removed from all variables
+  std::vector<int> valid_rows;
+  valid_rows.reserve(num_inputs);
+  std::vector<double> valid_input_vector;
+  valid_input_vector.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; ++i)
+  {
+    if (input_vector[i] >= 1e-6)
+    {
+      valid_rows.push_back(i);
+      valid_input_vector.push_back(input_vector[i]);
+    }
+  }
+  const int invalid_data_counter = num_inputs - static_cast<int> (valid_rows.size());
+  if(invalid_data_counter > (int)valid_rows.size())
+  {
+    ROS_WARN("Found >%i< invalid data points when resampling the trajectory.", invalid_data_counter);
+  }
+  if (valid_input_vector.empty())
+  {
+    ROS_ERROR("All >%i< data points are invalid. Cannot resample trajectory using a bspline.", num_inputs);
+    return false;
+  }
+
+  output_matrix.resize(input_querry.size() * num_variables);
+
+  BSpline<double>::Debug(0);
+  BSplineBase<double> b_spline_base(&(valid_input_vector[0]), static_cast<int> (valid_input_vector.size()), cutoff_wave_length);
+  if (!b_spline_base.ok())
+  {
+    ROS_ERROR("Could not create b-spline.");
+    ROS_ERROR("Number of input values is >%i<.", (int)valid_input_vector.size());
+    ROS_ERROR("Cuttoff is >%f<.", cutoff_wave_length);
+    return false;
+  }
+
+  ResampleColumnsJob job;
+  job.b_spline_base = &b_spline_base;
+  job.valid_rows = &valid_rows;
+  job.target_matrix = &target_matrix;
+  job.num_inputs = num_inputs;
+  job.num_variables = num_variables;
+  job.input_querry = &input_querry;
+  job.output_matrix = &output_matrix;
+  job.compute_slope = compute_slope;
+  job.num_threads = std::max(1, std::min(num_threads, num_variables));
+  job.worker_succeeded.resize(job.num_threads, 1);
+
+  // the calling thread acts as worker 0
+  boost::thread_group workers;
+  for (int i = 1; i < job.num_threads; ++i)
+  {
+    workers.create_thread(boost::bind(&resampleColumnsWorker, &job, i));
+  }
+  resampleColumnsWorker(&job, 0);
+  workers.join_all();
+
+  return (std::count(job.worker_succeeded.begin(), job.worker_succeeded.end(), 0) == 0);
+}
+
 //inline bool resample(const std::vector<ros::Time>& time_stamps,
 //                     const std::vector<std::vector<double> >& values,
 //                     const int num_samples,
@@ -314,7 +486,68 @@ inline bool resampleLinearNoBounds(const std::vector<double>& input_x,
       double delta_before = (output_x[i] - input_x[input_index]) / delta;
       double delta_after = (input_x[input_index + 1] - output_x[i]) / delta;
 
-      output_y[i] = delta_before * input_y[input_index] + delta_after * input_y[input_index + 1];
+      // the closer sample gets the larger weight
+      output_y[i] = delta_after * input_y[input_index] + delta_before * input_y[input_index + 1];
+    }
+  }
+  return true;
+}
+
+inline bool resampleLinearNoBoundsColumns(const std::vector<double>& input_x,
+                                          const std::vector<double>& input_y,
+                                          const int num_variables,
+                                          const std::vector<double>& output_x,
+                                          std::vector<double>& output_y)
+{
+  ROS_ASSERT(input_x.size() * num_variables == input_y.size());
+  ROS_ASSERT(input_x.size() > 1);
+
+  const int num_outputs = output_x.size();
+  const int num_inputs = input_x.size();
+  output_y.resize(num_outputs * num_variables);
+
+  // output_y[i] = weights_before[i] * input_y[indices[i]] + weights_after[i] * input_y[indices[i] + 1]
+  std::vector<int> indices(num_outputs);
+  std::vector<double> weights_before(num_outputs);
+  std::vector<double> weights_after(num_outputs);
+  unsigned int input_index = 0;
+  for (int i = 0; i < num_outputs; ++i)
+  {
+    if(output_x[i] < input_x[0])
+    {
+      indices[i] = 0;
+      weights_before[i] = 1.0;
+      weights_after[i] = 0.0;
+    }
+    else if (output_x[i] > input_x[num_inputs-1])
+    {
+      indices[i] = num_inputs - 2;
+      weights_before[i] = 0.0;
+      weights_after[i] = 1.0;
+    }
+    else
+    {
+      while (input_x[input_index + 1] < output_x[i] && input_index < input_x.size() - 1)
+      {
+        input_index++;
+      }
+
+      ROS_ASSERT(input_index < input_x.size()-1);
+      double delta = input_x[input_index + 1] - input_x[input_index];
+      indices[i] = input_index;
+      // the closer sample gets the larger weight
+      weights_before[i] = (input_x[input_index + 1] - output_x[i]) / delta;
+      weights_after[i] = (output_x[i] - input_x[input_index]) / delta;
+    }
+  }
+
+  for (int v = 0; v < num_variables; ++v)
+  {
+    const double* input = &(input_y[v * num_inputs]);
+    double* output = &(output_y[v * num_outputs]);
+    for (int i = 0; i < num_outputs; ++i)
+    {
+      output[i] = weights_before[i] * input[indices[i]] + weights_after[i] * input[indices[i] + 1];
     }
   }
   return true;
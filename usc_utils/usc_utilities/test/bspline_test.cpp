@@ -0,0 +1,134 @@
+/*********************************************************************
+  Computational Learning and Motor Control Lab
+  University of Southern California
+  Prof. Stefan Schaal
+ *********************************************************************
+  \remarks		Checks that resampling all variables at once yields the
+            same result as resampling them one by one, and that linear
+            resampling reproduces a line.
+
+  \file		bspline_test.cpp
+
+  \author	Peter Pastor
+  \date		Oct 16, 2026
+
+ *********************************************************************/
+
+// system includes
+#include <cmath>
+
+// local includes
+#include <gtest/gtest.h>
+#include <usc_utilities/bspline.h>
+
+using namespace usc_utilities;
+
+static void createData(const int num_inputs, const int num_variables, const int num_outputs,
+                       std::vector<double>& input_vector, std::vector<double>& target_matrix, std::vector<double>& input_querry)
+{
+  input_vector.resize(num_inputs);
+  for (int i = 0; i < num_inputs; ++i)
+  {
+    // non uniform time stamps
+    input_vector[i] = 100.0 + 0.002 * i + 0.0005 * sin(0.7 * i);
+  }
+  target_matrix.resize(num_inputs * num_variables);
+  for (int v = 0; v < num_variables; ++v)
+  {
+    for (int i = 0; i < num_inputs; ++i)
+    {
+      target_matrix[v * num_inputs + i] = sin(0.3 * v + (1 + v % 5) * input_vector[i]) + 0.01 * cos(13.0 * i);
+    }
+  }
+  input_querry.resize(num_outputs);
+  for (int s = 0; s < num_outputs; ++s)
+  {
+    input_querry[s] = input_vector[5] + s * (input_vector[num_inputs - 2] - input_vector[5]) / (num_outputs - 1);
+  }
+}
+
+TEST(UscUtilitiesBSpline, resampleColumns)
+{
+  const int NUM_INPUTS = 2000;
+  const int NUM_VARIABLES = 17;
+  const int NUM_OUTPUTS = 300;
+  std::vector<double> input_vector, target_matrix, input_querry;
+  createData(NUM_INPUTS, NUM_VARIABLES, NUM_OUTPUTS, input_vector, target_matrix, input_querry);
+  double wave_length = 2.0 * (input_querry[1] - input_querry[0]);
+
+  for (int num_threads = 1; num_threads <= 4; num_threads *= 2)
+  {
+    std::vector<double> output_matrix;
+    EXPECT_TRUE(resampleColumns(input_vector, target_matrix, NUM_VARIABLES, wave_length, input_querry, output_matrix, false, num_threads));
+    ASSERT_EQ(static_cast<int>(output_matrix.size()), NUM_VARIABLES * NUM_OUTPUTS);
+    for (int v = 0; v < NUM_VARIABLES; ++v)
+    {
+      std::vector<double> target_vector(target_matrix.begin() + v * NUM_INPUTS, target_matrix.begin() + (v + 1) * NUM_INPUTS);
+      std::vector<double> output_vector;
+      EXPECT_TRUE(resample(input_vector, target_vector, wave_length, input_querry, output_vector, false));
+      for (int s = 0; s < NUM_OUTPUTS; ++s)
+      {
+        EXPECT_DOUBLE_EQ(output_vector[s], output_matrix[v * NUM_OUTPUTS + s]);
+      }
+    }
+  }
+}
+
+TEST(UscUtilitiesBSpline, resampleLinearNoBoundsColumns)
+{
+  const int NUM_INPUTS = 200;
+  const int NUM_VARIABLES = 5;
+  const int NUM_OUTPUTS = 50;
+  std::vector<double> input_vector, target_matrix, input_querry;
+  createData(NUM_INPUTS, NUM_VARIABLES, NUM_OUTPUTS, input_vector, target_matrix, input_querry);
+  // also query outside of the input range
+  input_querry.front() = input_vector.front() - 1.0;
+  input_querry.back() = input_vector.back() + 1.0;
+
+  std::vector<double> output_matrix;
+  EXPECT_TRUE(resampleLinearNoBoundsColumns(input_vector, target_matrix, NUM_VARIABLES, input_querry, output_matrix));
+  for (int v = 0; v < NUM_VARIABLES; ++v)
+  {
+    std::vector<double> target_vector(target_matrix.begin() + v * NUM_INPUTS, target_matrix.begin() + (v + 1) * NUM_INPUTS);
+    std::vector<double> output_vector;
+    EXPECT_TRUE(resampleLinearNoBounds(input_vector, target_vector, input_querry, output_vector));
+    for (int s = 0; s < NUM_OUTPUTS; ++s)
+    {
+      EXPECT_DOUBLE_EQ(output_vector[s], output_matrix[v * NUM_OUTPUTS + s]);
+    }
+  }
+}
+
+TEST(UscUtilitiesBSpline, resampleLinearNoBoundsLine)
+{
+  const int NUM_INPUTS = 20;
+  const int NUM_VARIABLES = 3;
+  const int NUM_OUTPUTS = 57;
+  std::vector<double> input_vector, target_matrix, input_querry;
+  createData(NUM_INPUTS, NUM_VARIABLES, NUM_OUTPUTS, input_vector, target_matrix, input_querry);
+  // variable v is the line (v + 1) * x - v, the queries include the input samples themselves
+  for (int v = 0; v < NUM_VARIABLES; ++v)
+  {
+    for (int i = 0; i < NUM_INPUTS; ++i)
+    {
+      target_matrix[v * NUM_INPUTS + i] = (v + 1) * input_vector[i] - v;
+    }
+  }
+  input_querry[0] = input_vector[3];
+  input_querry[NUM_OUTPUTS - 1] = input_vector[NUM_INPUTS - 1];
+
+  std::vector<double> output_matrix;
+  EXPECT_TRUE(resampleLinearNoBoundsColumns(input_vector, target_matrix, NUM_VARIABLES, input_querry, output_matrix));
+  for (int v = 0; v < NUM_VARIABLES; ++v)
+  {
+    std::vector<double> target_vector(target_matrix.begin() + v * NUM_INPUTS, target_matrix.begin() + (v + 1) * NUM_INPUTS);
+    std::vector<double> output_vector;
+    EXPECT_TRUE(resampleLinearNoBounds(input_vector, target_vector, input_querry, output_vector));
+    for (int s = 0; s < NUM_OUTPUTS; ++s)
+    {
+      double expected = (v + 1) * input_querry[s] - v;
+      EXPECT_NEAR(expected, output_matrix[v * NUM_OUTPUTS + s], 1e-9);
+      EXPECT_NEAR(expected, output_vector[s], 1e-9);
+    }
+  }
+}